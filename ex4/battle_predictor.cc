@@ -0,0 +1,60 @@
+#include "battle_predictor.h"
+
+#include <functional>
+
+using namespace mtm::pokemongo;
+
+const size_t BattlePredictor::DEFAULT_CAPACITY;
+
+BattlePredictor::BattlePredictor(size_t capacity)
+	: capacity(capacity), hits(0), misses(0), predictions() {}
+
+BattlePrediction BattlePredictor::Predict(const Trainer & trainer_1,
+										  const Trainer & trainer_2) {
+	Key key = {trainer_1.Id(), trainer_1.Version(),
+			   trainer_2.Id(), trainer_2.Version()};
+	std::unordered_map<Key, BattlePrediction, KeyHash>::const_iterator
+		found = predictions.find(key);
+	if (found != predictions.end()) {
+		hits++;
+		return found->second;
+	}
+	misses++;
+	BattlePrediction prediction = PredictBattle(trainer_1, trainer_2);
+	if (predictions.size() >= capacity) predictions.clear();
+	predictions.emplace(key, prediction);
+	return prediction;
+}
+
+size_t BattlePredictor::Hits() const {
+	return hits;
+}
+
+size_t BattlePredictor::Misses() const {
+	return misses;
+}
+
+size_t BattlePredictor::Size() const {
+	return predictions.size();
+}
+
+void BattlePredictor::Clear() {
+	predictions.clear();
+}
+
+bool BattlePredictor::Key::operator==(const Key & rhs) const {
+	return id_1 == rhs.id_1 && version_1 == rhs.version_1 &&
+		id_2 == rhs.id_2 && version_2 == rhs.version_2;
+}
+
+size_t BattlePredictor::KeyHash::operator()(const Key & key) const {
+	std::hash<unsigned long long> hash;
+	size_t result = hash(key.id_1);
+	const unsigned long long rest[] = {key.version_1, key.id_2,
+									   key.version_2};
+	for (unsigned long long value : rest) {
+		// Combines the hashes as boost::hash_combine does
+		result ^= hash(value) + 0x9e3779b9 + (result << 6) + (result >> 2);
+	}
+	return result;
+}
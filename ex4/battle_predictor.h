@@ -0,0 +1,77 @@
+#ifndef BATTLE_PREDICTOR_H
+#define BATTLE_PREDICTOR_H
+
+#include <cstddef>
+#include <unordered_map>
+
+#include "trainer.h"
+
+namespace mtm {
+namespace pokemongo {
+
+// Predicts battles between trainers, remembering the predictions. A
+// prediction is keyed on the id and version of both trainers, so any change
+// to a trainer's battle state makes its old predictions unreachable, and
+// they're never returned again.
+//
+// Not thread safe. Each thread evaluating pairings should use its own
+// predictor.
+class BattlePredictor {
+public:
+	// Default number of predictions kept before the cache is emptied
+	static const size_t DEFAULT_CAPACITY = 1 << 16;
+
+	// Constructs a predictor with an empty cache.
+	//
+	// @param capacity number of predictions to keep. When the cache is full
+	//		  it's emptied, which drops stale predictions as well.
+	explicit BattlePredictor(size_t capacity = DEFAULT_CAPACITY);
+
+	// Predicts a battle, as PredictBattle does, using the cached prediction
+	// when the trainers haven't changed since it was made.
+	//
+	// @param trainer_1 first trainer in battle
+	// @param trainer_2 second trainer in battle
+	// @return the outcome TrainersBattle(trainer_1, trainer_2) would have.
+	// @throw TrainerInvalidArgsException if the battle would be decided by
+	//		  team and both trainers are in the same team.
+	BattlePrediction Predict(const Trainer& trainer_1,
+							 const Trainer& trainer_2);
+
+	// Returns the number of predictions taken from the cache.
+	size_t Hits() const;
+
+	// Returns the number of predictions which had to be computed.
+	size_t Misses() const;
+
+	// Returns the number of predictions in the cache.
+	size_t Size() const;
+
+	// Empties the cache.
+	void Clear();
+
+private:
+	// The battle state of both trainers
+	struct Key {
+		unsigned long long id_1;
+		unsigned long long version_1;
+		unsigned long long id_2;
+		unsigned long long version_2;
+
+		bool operator==(const Key& rhs) const;
+	};
+
+	struct KeyHash {
+		size_t operator()(const Key& key) const;
+	};
+
+	size_t capacity;
+	size_t hits;
+	size_t misses;
+	std::unordered_map<Key, BattlePrediction, KeyHash> predictions;
+};
+
+}  // namespace pokemongo
+}  // namespace mtm
+
+#endif  // BATTLE_PREDICTOR_H
@@ -0,0 +1,113 @@
+#ifndef BINARY_IO_H
+#define BINARY_IO_H
+
+#include <cstddef>
+#include <cstring>
+#include <string>
+
+namespace mtm {
+namespace pokemongo {
+
+// Compact binary encoding helpers shared by the journal and checkpoint
+// formats. Integers are written as little endian base 128 varints (7 bits
+// per byte, high bit set on all but the last byte), signed integers are
+// zigzag encoded first so small negative values stay short, doubles are
+// written as their 8 bytes, so they are restored exactly, and strings are
+// written as a varint length followed by their bytes.
+
+inline void PutVarint(std::string& output, unsigned long long value) {
+	while (value >= 0x80) {
+		output.push_back((char)((value & 0x7f) | 0x80));
+		value >>= 7;
+	}
+	output.push_back((char)value);
+}
+
+inline void PutSignedVarint(std::string& output, long long value) {
+	PutVarint(output, ((unsigned long long)value << 1) ^
+					  (unsigned long long)(value >> 63));
+}
+
+inline void PutDouble(std::string& output, double value) {
+	char bytes[sizeof(double)];
+	std::memcpy(bytes, &value, sizeof(double));
+	output.append(bytes, sizeof(double));
+}
+
+inline void PutString(std::string& output, const std::string& value) {
+	PutVarint(output, value.size());
+	output.append(value);
+}
+
+// Reads encoded values from a memory buffer. Every Get function returns
+// false, without moving, if the buffer ends in the middle of the value.
+class BinaryReader {
+public:
+	BinaryReader(const char* begin, const char* end)
+		: position(begin), end(end) {}
+
+	bool GetVarint(unsigned long long* value) {
+		unsigned long long result = 0;
+		const char* current = position;
+		for (int shift = 0; shift < 64 && current < end; shift += 7) {
+			unsigned char byte = (unsigned char)*current++;
+			result |= (unsigned long long)(byte & 0x7f) << shift;
+			if (!(byte & 0x80)) {
+				*value = result;
+				position = current;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	bool GetSignedVarint(long long* value) {
+		unsigned long long encoded = 0;
+		if (!GetVarint(&encoded)) return false;
+		*value = (long long)(encoded >> 1) ^ -(long long)(encoded & 1);
+		return true;
+	}
+
+	bool GetDouble(double* value) {
+		if ((size_t)(end - position) < sizeof(double)) return false;
+		std::memcpy(value, position, sizeof(double));
+		position += sizeof(double);
+		return true;
+	}
+
+	bool GetString(std::string* value) {
+		const char* start = position;
+		unsigned long long size = 0;
+		if (!GetVarint(&size)) return false;
+		if (size > (unsigned long long)(end - position)) {
+			position = start;
+			return false;
+		}
+		value->assign(position, (size_t)size);
+		position += size;
+		return true;
+	}
+
+	// Returns the position of the next unread byte.
+	const char* Position() const {
+		return position;
+	}
+
+	// Moves back to a position returned by Position.
+	void Seek(const char* new_position) {
+		position = new_position;
+	}
+
+	bool AtEnd() const {
+		return position >= end;
+	}
+
+private:
+	const char* position;
+	const char* end;
+};
+
+}  // namespace pokemongo
+}  // namespace mtm
+
+#endif  // BINARY_IO_H
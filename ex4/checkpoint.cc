@@ -0,0 +1,407 @@
+#include "checkpoint.h"
+
+#include <climits>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "exceptions.h"
+#include "gym.h"
+#include "pokestop.h"
+#include "starbucks.h"
+
+using namespace mtm::pokemongo;
+
+// Written at the start of every checkpoint file
+#define CHECKPOINT_MAGIC		"PGC1"
+#define CHECKPOINT_MAGIC_SIZE	4
+// Suffix of the file a checkpoint is written to before it's complete
+#define TEMPORARY_SUFFIX		".tmp"
+// Number of edges a location has
+#define DIRECTIONS_NUM			4
+// Marks a gym with no leader
+#define NO_LEADER				-1
+
+// Location and item kinds as stored in the file
+#define LOCATION_KIND_GYM		0
+#define LOCATION_KIND_POKESTOP	1
+#define LOCATION_KIND_STARBUCKS	2
+#define ITEM_KIND_CANDY			0
+#define ITEM_KIND_POTION		1
+
+Checkpoint::Checkpoint() : failed(false) {}
+
+Checkpoint::~Checkpoint() {
+	if (writer.joinable()) writer.join();
+}
+
+void Checkpoint::Wait() {
+	if (writer.joinable()) writer.join();
+	if (failed) {
+		failed = false;
+		throw CheckpointWriteFailedException();
+	}
+}
+
+void Checkpoint::Save(const PokemonGo & game, const std::string & path) {
+	Wait();
+	data.clear();
+	Capture(game, data);
+	writer = std::thread(&Checkpoint::Write, this, path);
+}
+
+void Checkpoint::Write(const std::string & path) {
+	std::string temporary_path = path + TEMPORARY_SUFFIX;
+	std::FILE* file = std::fopen(temporary_path.c_str(), "wb");
+	if (file == NULL) {
+		failed = true;
+		return;
+	}
+	bool written = std::fwrite(data.data(), 1, data.size(), file) ==
+		data.size();
+	written = std::fclose(file) == 0 && written;
+	if (!written || std::rename(temporary_path.c_str(), path.c_str()) != 0) {
+		std::remove(temporary_path.c_str());
+		failed = true;
+	}
+}
+
+void Checkpoint::CapturePokemon(const Pokemon & pokemon,
+								std::string & output) {
+	PutString(output, SpeciesRegistry::Name(pokemon.species));
+	PutVarint(output, pokemon.types);
+	PutDouble(output, pokemon.cp);
+	PutVarint(output, pokemon.level);
+	PutDouble(output, pokemon.hp);
+}
+
+static void CaptureItem(const ItemValue& item, std::string& output) {
+	PutVarint(output, item.Kind() == ITEM_CANDY ?
+						  ITEM_KIND_CANDY : ITEM_KIND_POTION);
+	PutVarint(output, item.Level());
+}
+
+void Checkpoint::CaptureLocation(const Location & location,
+								 std::string & output) {
+	if (location.Type() == LOCATION_POKESTOP) {
+		const Pokestop& pokestop = static_cast<const Pokestop&>(location);
+		PutVarint(output, LOCATION_KIND_POKESTOP);
+		std::vector<ItemValue> items = pokestop.ItemsLeft();
+		PutVarint(output, items.size());
+		for (const ItemValue& item : items) {
+			CaptureItem(item, output);
+		}
+	} else if (location.Type() == LOCATION_STARBUCKS) {
+		const Starbucks& starbucks = static_cast<const Starbucks&>(location);
+		PutVarint(output, LOCATION_KIND_STARBUCKS);
+		PutVarint(output, starbucks.pokemons.size());
+		for (const Pokemon& pokemon : starbucks.pokemons) {
+			CapturePokemon(pokemon, output);
+		}
+	} else {
+		PutVarint(output, LOCATION_KIND_GYM);
+	}
+}
+
+void Checkpoint::CaptureTrainer(const Trainer & trainer,
+								std::string & output) {
+	PutString(output, trainer.name);
+	PutVarint(output, trainer.team);
+	PutVarint(output, trainer.level);
+	PutSignedVarint(output, trainer.battle_score_history);
+	PutVarint(output, trainer.pokemons_by_strength.size());
+	for (size_t i = 0; i < trainer.pokemons.size(); i++) {
+		if (!trainer.killed[i]) CapturePokemon(trainer.pokemons[i], output);
+	}
+	PutVarint(output, trainer.items.Size());
+	for (size_t i = 0; i < trainer.items.Size(); i++) {
+		CaptureItem(trainer.items[i], output);
+	}
+}
+
+void Checkpoint::Capture(const PokemonGo & game, std::string & output) {
+	const World& world = *game.world;
+	output.append(CHECKPOINT_MAGIC, CHECKPOINT_MAGIC_SIZE);
+
+	std::vector<std::string> names = world.LocationNames();
+	std::vector<Location*> locations;
+	std::unordered_map<std::string, size_t> location_indices;
+	PutVarint(output, names.size());
+	for (const std::string& name : names) {
+		location_indices[name] = locations.size();
+		locations.push_back(world[name]);
+		PutString(output, name);
+		CaptureLocation(*locations.back(), output);
+	}
+
+	// Every edge once: self loops from their location, other edges from the
+	// location whose name comes first
+	std::string edges;
+	unsigned long long edges_num = 0;
+	for (size_t i = 0; i < names.size(); i++) {
+		for (Direction dir = 0; dir < DIRECTIONS_NUM; dir++) {
+			std::string neighbor;
+			if (world.TryNeighbor(names[i], dir, &neighbor) != WORLD_SUCCESS ||
+				neighbor < names[i]) {
+				continue;
+			}
+			// The edge's direction at the other end
+			Direction back = 0;
+			std::string back_neighbor;
+			while (neighbor != names[i] && back < DIRECTIONS_NUM &&
+				   (world.TryNeighbor(neighbor, back, &back_neighbor) !=
+					WORLD_SUCCESS || back_neighbor != names[i])) {
+				back++;
+			}
+			if (back == DIRECTIONS_NUM) continue;
+			PutVarint(edges, i);
+			PutVarint(edges, location_indices[neighbor]);
+			PutVarint(edges, dir);
+			PutVarint(edges, back);
+			edges_num++;
+		}
+	}
+	PutVarint(output, edges_num);
+	output.append(edges);
+
+	std::unordered_map<const Trainer*, size_t> trainer_indices;
+	PutVarint(output, game.trainers.size());
+	for (const std::pair<const std::string, Trainer>& entry : game.trainers) {
+		const Trainer& trainer = entry.second;
+		size_t index = trainer_indices.size();
+		trainer_indices[&trainer] = index;
+		CaptureTrainer(trainer, output);
+		PutVarint(output, location_indices[trainer.current_location_name]);
+	}
+
+	for (const Location* location : locations) {
+		PutVarint(output, location->trainers_.size());
+		for (const Trainer* trainer : location->trainers_) {
+			PutVarint(output, trainer_indices[trainer]);
+		}
+		if (location->Type() == LOCATION_GYM) {
+			const Gym* gym = static_cast<const Gym*>(location);
+			PutSignedVarint(output, gym->leader == NULL ? NO_LEADER :
+							(long long)trainer_indices[gym->leader]);
+		}
+	}
+}
+
+// Reads a value or fails the restore
+static unsigned long long ReadVarint(BinaryReader& reader) {
+	unsigned long long value = 0;
+	if (!reader.GetVarint(&value)) throw CheckpointCorruptedException();
+	return value;
+}
+
+static long long ReadSignedVarint(BinaryReader& reader) {
+	long long value = 0;
+	if (!reader.GetSignedVarint(&value)) throw CheckpointCorruptedException();
+	return value;
+}
+
+static double ReadDouble(BinaryReader& reader) {
+	double value = 0;
+	if (!reader.GetDouble(&value)) throw CheckpointCorruptedException();
+	return value;
+}
+
+static std::string ReadString(BinaryReader& reader) {
+	std::string value;
+	if (!reader.GetString(&value)) throw CheckpointCorruptedException();
+	return value;
+}
+
+// Reads an index into a table of the given size
+static size_t ReadIndex(BinaryReader& reader, size_t size) {
+	unsigned long long index = ReadVarint(reader);
+	if (index >= size) throw CheckpointCorruptedException();
+	return (size_t)index;
+}
+
+static ItemValue DecodeItem(BinaryReader& reader) {
+	unsigned long long kind = ReadVarint(reader);
+	unsigned long long level = ReadVarint(reader);
+	if (level > (unsigned long long)INT_MAX) {
+		throw CheckpointCorruptedException();
+	}
+	if (kind == ITEM_KIND_CANDY) return ItemValue(ITEM_CANDY, (int)level);
+	if (kind == ITEM_KIND_POTION) return ItemValue(ITEM_POTION, (int)level);
+	throw CheckpointCorruptedException();
+}
+
+Pokemon Checkpoint::DecodePokemon(BinaryReader & reader) {
+	std::string species = ReadString(reader);
+	unsigned long long types_mask = ReadVarint(reader);
+	std::set<PokemonType> types;
+	for (int type = NORMAL; type <= PSYCHIC; type++) {
+		if (types_mask & (1ULL << type)) types.insert((PokemonType)type);
+	}
+	double cp = ReadDouble(reader);
+	unsigned long long level = ReadVarint(reader);
+	double hp = ReadDouble(reader);
+	if (level > (unsigned long long)INT_MAX) {
+		throw CheckpointCorruptedException();
+	}
+	try {
+		Pokemon pokemon(species, types, cp, (int)level);
+		pokemon.hp = hp;
+		return pokemon;
+	}
+	catch (PokemonInvalidArgsException&) {
+		throw CheckpointCorruptedException();
+	}
+}
+
+Location* Checkpoint::DecodeLocation(BinaryReader & reader) {
+	unsigned long long kind = ReadVarint(reader);
+	if (kind == LOCATION_KIND_GYM) return new Gym();
+	if (kind == LOCATION_KIND_POKESTOP) {
+		Pokestop* pokestop = new Pokestop();
+		try {
+			for (unsigned long long i = ReadVarint(reader); i > 0; i--) {
+				pokestop->AddItem(DecodeItem(reader));
+			}
+		}
+		catch (...) {
+			delete pokestop;
+			throw;
+		}
+		return pokestop;
+	}
+	if (kind == LOCATION_KIND_STARBUCKS) {
+		std::vector<Pokemon> pokemons;
+		for (unsigned long long i = ReadVarint(reader); i > 0; i--) {
+			pokemons.push_back(DecodePokemon(reader));
+		}
+		return new Starbucks(std::move(pokemons));
+	}
+	throw CheckpointCorruptedException();
+}
+
+void Checkpoint::DecodeTrainer(BinaryReader & reader, Trainer & trainer) {
+	unsigned long long level = ReadVarint(reader);
+	if (level > (unsigned long long)INT_MAX) {
+		throw CheckpointCorruptedException();
+	}
+	trainer.level = (int)level;
+	trainer.battle_score_history = (int)ReadSignedVarint(reader);
+	for (unsigned long long i = ReadVarint(reader); i > 0; i--) {
+		trainer.AddPokemon(DecodePokemon(reader));
+	}
+	for (unsigned long long i = ReadVarint(reader); i > 0; i--) {
+		trainer.items.PushBack(DecodeItem(reader));
+	}
+	trainer.Changed();
+}
+
+PokemonGo* Checkpoint::Decode(const std::string & data) {
+	if (data.compare(0, CHECKPOINT_MAGIC_SIZE, CHECKPOINT_MAGIC) != 0) {
+		throw CheckpointCorruptedException();
+	}
+	BinaryReader reader(data.data() + CHECKPOINT_MAGIC_SIZE,
+						data.data() + data.size());
+	World* world = new World();
+	PokemonGo* game = NULL;
+	try {
+		std::vector<std::string> names;
+		std::vector<Location*> locations;
+		for (unsigned long long i = ReadVarint(reader); i > 0; i--) {
+			names.push_back(ReadString(reader));
+			Location* location = DecodeLocation(reader);
+			try {
+				world->Insert(names.back(), location);
+			}
+			catch (KGraphKeyAlreadyExistsExpection&) {
+				delete location;
+				throw CheckpointCorruptedException();
+			}
+			locations.push_back(location);
+		}
+
+		for (unsigned long long i = ReadVarint(reader); i > 0; i--) {
+			size_t from = ReadIndex(reader, names.size());
+			size_t to = ReadIndex(reader, names.size());
+			Direction from_direction = (Direction)ReadIndex(reader,
+															DIRECTIONS_NUM);
+			Direction to_direction = (Direction)ReadIndex(reader,
+														  DIRECTIONS_NUM);
+			try {
+				if (from == to) {
+					world->Connect(names[from], from_direction);
+				} else {
+					world->Connect(names[from], names[to], from_direction,
+								   to_direction);
+				}
+			}
+			catch (mtm::KGraphExcpetion&) {
+				throw CheckpointCorruptedException();
+			}
+		}
+
+		game = new PokemonGo(world);
+		std::vector<Trainer*> trainers;
+		unsigned long long trainers_num = ReadVarint(reader);
+		game->trainers.reserve(trainers_num);
+		for (unsigned long long i = trainers_num; i > 0; i--) {
+			std::string name = ReadString(reader);
+			unsigned long long team = ReadVarint(reader);
+			if (name.empty() || team > RED) {
+				throw CheckpointCorruptedException();
+			}
+			std::pair<std::unordered_map<std::string, Trainer>::iterator,
+					  bool> inserted = game->trainers.emplace(
+						  std::piecewise_construct, std::forward_as_tuple(name),
+						  std::forward_as_tuple(name, (Team)team));
+			if (!inserted.second) throw CheckpointCorruptedException();
+			Trainer& trainer = inserted.first->second;
+			DecodeTrainer(reader, trainer);
+			game->leaderboard.Add(name, trainer);
+			trainer.current_location_name =
+				names[ReadIndex(reader, names.size())];
+			trainers.push_back(&trainer);
+		}
+
+		for (Location* location : locations) {
+			for (unsigned long long i = ReadVarint(reader); i > 0; i--) {
+				Trainer* trainer = trainers[ReadIndex(reader, trainers.size())];
+				location->trainers_.push_back(trainer);
+				location->team_trainers_[trainer->GetTeam()].push_back(trainer);
+			}
+			if (location->Type() == LOCATION_GYM) {
+				Gym* gym = static_cast<Gym*>(location);
+				gym->IndexTrainers();
+				long long leader = ReadSignedVarint(reader);
+				if (leader != NO_LEADER) {
+					if (leader < 0 || (size_t)leader >= trainers.size()) {
+						throw CheckpointCorruptedException();
+					}
+					gym->leader = trainers[(size_t)leader];
+					gym->leader->SetLeader(true);
+				}
+			}
+		}
+		if (!reader.AtEnd()) throw CheckpointCorruptedException();
+	}
+	catch (...) {
+		if (game != NULL) {
+			delete game;
+		} else {
+			delete world;
+		}
+		throw;
+	}
+	return game;
+}
+
+PokemonGo* Checkpoint::Restore(const std::string & path) {
+	std::ifstream input(path.c_str(), std::ios::binary);
+	if (!input) throw CheckpointOpenFailedException();
+	std::string data((std::istreambuf_iterator<char>(input)),
+					 std::istreambuf_iterator<char>());
+	return Decode(data);
+}
@@ -0,0 +1,98 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <string>
+#include <thread>
+
+#include "binary_io.h"
+#include "pokemon_go.h"
+
+namespace mtm {
+namespace pokemongo {
+
+// Saves the complete state of a game to a single binary file, and restores
+// a game from it: the world's locations and edges, the items left in every
+// Pokestop and the Pokemons left in every Starbucks, the trainers with their
+// Pokemons, items, level and score, the order in which trainers arrived at
+// every location and the leader of every gym.
+//
+// Saving happens in two steps. The game's state is first encoded to memory,
+// on the calling thread, which gives a consistent snapshot and only takes as
+// long as copying the state. The encoded state is then written to the file
+// on a background thread, while the game goes on. The file is written under
+// a temporary name and renamed when complete, so a crash in the middle of a
+// write leaves the previous checkpoint intact.
+class Checkpoint {
+public:
+	// Constructs a checkpoint writer with no write in progress.
+	Checkpoint();
+
+	// Waits for a write in progress to finish.
+	~Checkpoint();
+
+	// Disable copy and assignment.
+	Checkpoint(const Checkpoint&) = delete;
+	Checkpoint& operator=(const Checkpoint&) = delete;
+
+	// Takes a snapshot of the game and starts writing it to a file in the
+	// background. Waits first for the previous write, if any, to finish.
+	//
+	// @param game the game to save.
+	// @param path path of the checkpoint file. Replaced when the write
+	//		  completes.
+	// @throw CheckpointWriteFailedException if the previous write failed.
+	void Save(const PokemonGo& game, const std::string& path);
+
+	// Waits for the write started by the last Save to finish.
+	//
+	// @throw CheckpointWriteFailedException if the write failed.
+	void Wait();
+
+	// Restores a game from a checkpoint file. Runs in time linear in the
+	// size of the game, apart from the world's own lookups.
+	//
+	// @param path path of the checkpoint file.
+	// @return the restored game. The caller is responsible for deleting it.
+	// @throw CheckpointOpenFailedException if the file can't be read.
+	// @throw CheckpointCorruptedException if the file is not a valid
+	//		  checkpoint.
+	static PokemonGo* Restore(const std::string& path);
+
+	// Encodes the state of a game, as written to a checkpoint file.
+	//
+	// @param game the game to encode.
+	// @param output the encoded state is appended to it.
+	static void Capture(const PokemonGo& game, std::string& output);
+
+	// Decodes a game from a state encoded by Capture.
+	//
+	// @param data the encoded state.
+	// @return the decoded game. The caller is responsible for deleting it.
+	// @throw CheckpointCorruptedException if data is not a valid state.
+	static PokemonGo* Decode(const std::string& data);
+
+private:
+	static void CaptureLocation(const Location& location,
+								std::string& output);
+	static void CapturePokemon(const Pokemon& pokemon, std::string& output);
+	static void CaptureTrainer(const Trainer& trainer, std::string& output);
+
+	static Location* DecodeLocation(BinaryReader& reader);
+	static Pokemon DecodePokemon(BinaryReader& reader);
+	static void DecodeTrainer(BinaryReader& reader, Trainer& trainer);
+
+	// Writes data to path, through a temporary file. Runs on the writer
+	// thread.
+	void Write(const std::string& path);
+
+	std::thread writer;
+	// The snapshot being written. Owned by the writer thread while it runs.
+	std::string data;
+	// Set by the writer thread, read after joining it
+	bool failed;
+};
+
+}  // namespace pokemongo
+}  // namespace mtm
+
+#endif  // CHECKPOINT_H
@@ -0,0 +1,48 @@
+#ifndef COMMAND_H
+#define COMMAND_H
+
+#include <string>
+
+#include "trainer.h"
+#include "world.h"
+
+namespace mtm {
+namespace pokemongo {
+
+// Game commands which change the state of a game.
+typedef enum {
+	ADD_TRAINER,
+	MOVE_TRAINER,
+} CommandType;
+
+// A single call of PokemonGo::AddTrainer or PokemonGo::MoveTrainer, kept
+// as data so it can be queued and applied later. The result of applying a
+// command is the PokemonGoStatus of the matching Try function.
+struct GameCommand {
+	CommandType type;
+	std::string trainer_name;
+	// Used by ADD_TRAINER only
+	Team team;
+	std::string location;
+	// Used by MOVE_TRAINER only
+	Direction direction;
+
+	// Creates a command adding a new trainer to the game.
+	static GameCommand AddTrainer(const std::string& name, const Team& team,
+								  const std::string& location) {
+		GameCommand command = { ADD_TRAINER, name, team, location, NORTH };
+		return command;
+	}
+
+	// Creates a command moving a trainer in the given direction.
+	static GameCommand MoveTrainer(const std::string& name,
+								   const Direction& direction) {
+		GameCommand command = { MOVE_TRAINER, name, BLUE, "", direction };
+		return command;
+	}
+};
+
+}  // namespace pokemongo
+}  // namespace mtm
+
+#endif  // COMMAND_H
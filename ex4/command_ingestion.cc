@@ -0,0 +1,76 @@
+#include "command_ingestion.h"
+
+#include <utility>
+
+using namespace mtm::pokemongo;
+
+CommandProducer::CommandProducer(CommandIngestion & ingestion,
+								 size_t capacity)
+	: ingestion(ingestion), completions(capacity), in_flight(0) {}
+
+bool CommandProducer::TrySubmit(const GameCommand & command,
+								unsigned long long * sequence_number) {
+	// Keeps room for every completion, so the engine never finds the ring
+	// full
+	if (in_flight == completions.Capacity()) return false;
+	CommandIngestion::QueuedCommand queued = { command, this };
+	size_t position = 0;
+	if (!ingestion.queue.TryPush(std::move(queued), &position)) return false;
+	in_flight++;
+	if (sequence_number != NULL) *sequence_number = position;
+	return true;
+}
+
+bool CommandProducer::TryPollCompletion(CommandCompletion * completion) {
+	if (!completions.TryPop(completion)) return false;
+	in_flight--;
+	return true;
+}
+
+size_t CommandProducer::InFlight() const {
+	return in_flight;
+}
+
+CommandIngestion::CommandIngestion(TickExecutor & executor, size_t capacity,
+								   size_t batch_size)
+	: executor(executor), queue(capacity), batch_size(batch_size), batch(),
+	  applied(0) {
+	batch.reserve(batch_size);
+}
+
+size_t CommandIngestion::Drain() {
+	batch.clear();
+	// Commands the engine submitted itself come first in the tick's results
+	size_t first = executor.Queued();
+	QueuedCommand queued;
+	while (batch.size() < batch_size && queue.TryPop(&queued)) {
+		executor.Submit(queued.command);
+		batch.push_back(std::move(queued));
+	}
+	if (batch.empty()) return 0;
+	const std::vector<PokemonGoStatus>* results = NULL;
+	try {
+		results = &executor.RunTick();
+	}
+	catch (...) {
+		Complete(NULL, 0);
+		throw;
+	}
+	Complete(results, first);
+	return batch.size();
+}
+
+void CommandIngestion::Complete(const std::vector<PokemonGoStatus>* results,
+								size_t first) {
+	for (size_t i = 0; i < batch.size(); i++) {
+		// Commands are popped by the order their positions were taken
+		CommandCompletion completion = { applied + i, POKEMONGO_TICK_FAILED };
+		if (results != NULL) completion.status = (*results)[first + i];
+		batch[i].producer->completions.TryPush(std::move(completion));
+	}
+	applied += batch.size();
+}
+
+unsigned long long CommandIngestion::Applied() const {
+	return applied;
+}
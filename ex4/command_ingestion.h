@@ -0,0 +1,153 @@
+#ifndef COMMAND_INGESTION_H
+#define COMMAND_INGESTION_H
+
+#include <cstddef>
+#include <vector>
+
+#include "command.h"
+#include "mpsc_ring.h"
+#include "spsc_ring.h"
+#include "status.h"
+#include "tick_executor.h"
+
+namespace mtm {
+namespace pokemongo {
+
+class CommandIngestion;
+
+// The result of a command submitted through a CommandProducer.
+struct CommandCompletion {
+	// The position of the command in the order commands were applied, as
+	// returned by CommandProducer::TrySubmit
+	unsigned long long sequence_number;
+	PokemonGoStatus status;
+};
+
+// Submits game commands to a CommandIngestion from a single thread, and
+// receives their results. Any number of producers, each on its own thread,
+// can submit to the same ingestion.
+//
+// Submitting never waits for the engine: it fails instead if the ingestion
+// queue is full, or if the producer already has as many commands in flight
+// (submitted, with their completion not polled yet) as its capacity. The
+// capacity bounds the completions waiting for the producer, so the engine
+// never waits for the producer either. Completions arrive in the order the
+// producer submitted the commands, and a producer must not be destroyed
+// while it has commands in flight.
+class CommandProducer {
+public:
+	// Constructs a new producer.
+	//
+	// @param ingestion the ingestion to submit to. Must outlive the producer.
+	// @param capacity the number of commands which can be in flight, rounded
+	//		  up to a power of two.
+	CommandProducer(CommandIngestion& ingestion, size_t capacity);
+
+	// Disable copy and assignment.
+	CommandProducer(const CommandProducer&) = delete;
+	CommandProducer& operator=(const CommandProducer&) = delete;
+
+	// Queues a command to be applied by the engine. Called by the
+	// producer's thread only.
+	//
+	// @param command the command to apply.
+	// @param sequence_number if not NULL, set to the position of the command
+	//		  in the order all commands of the ingestion are applied, on
+	//		  success.
+	// @return false if the ingestion queue is full or the producer has
+	//		   too many commands in flight.
+	bool TrySubmit(const GameCommand& command,
+				   unsigned long long* sequence_number);
+
+	// Takes the result of the oldest command whose completion wasn't
+	// polled yet. Called by the producer's thread only.
+	//
+	// @param completion set to the result, if there is one.
+	// @return false if no command completed since the last poll.
+	bool TryPollCompletion(CommandCompletion* completion);
+
+	// Returns the number of commands in flight. Called by the producer's
+	// thread only.
+	size_t InFlight() const;
+
+private:
+	CommandIngestion& ingestion;
+	// Written by the engine, read by the producer
+	SpscRing<CommandCompletion> completions;
+	// Commands submitted and not polled, known to the producer only
+	size_t in_flight;
+
+	// Delivers the completions
+	friend class CommandIngestion;
+};
+
+// Takes game commands from many producer threads and applies them on a
+// single engine thread, through a TickExecutor.
+//
+// Producers push commands to a bounded multi-producer single-consumer ring
+// with no locks (see MpscRing). The engine thread drains it in batches, and
+// applies every batch as one tick of the executor, in the order the commands
+// were pushed. That order is total: it's the sequence number every command
+// gets on submission, and the executor records the commands in the game's
+// journal, if it has one, in the same order. Replaying the journal gives the
+// same results, no matter how the producers' threads were scheduled.
+class CommandIngestion {
+public:
+	// Constructs an empty ingestion.
+	//
+	// @param executor the executor applying the commands. Must outlive the
+	//		  ingestion, and must be used by the engine thread only. Commands
+	//		  the engine submits to it directly run in the next drained tick,
+	//		  before the ingested ones.
+	// @param capacity the number of commands which can be queued, rounded up
+	//		  to a power of two.
+	// @param batch_size the most commands applied in a single tick.
+	CommandIngestion(TickExecutor& executor, size_t capacity,
+					 size_t batch_size);
+
+	// Disable copy and assignment.
+	CommandIngestion(const CommandIngestion&) = delete;
+	CommandIngestion& operator=(const CommandIngestion&) = delete;
+
+	// Applies the queued commands, up to batch_size of them, as one tick of
+	// the executor, and sends every producer the results of its commands.
+	// Does nothing if no commands are queued. Called by the engine thread
+	// only.
+	//
+	// If the tick throws, every command of the batch completes with
+	// POKEMONGO_TICK_FAILED before the exception is passed on, so the
+	// producers never wait for them.
+	//
+	// @return the number of commands applied.
+	size_t Drain();
+
+	// Returns the number of commands applied so far, including those of
+	// failed ticks. Called by the engine thread only.
+	unsigned long long Applied() const;
+
+private:
+	// A submitted command, and the producer to send its result to
+	struct QueuedCommand {
+		GameCommand command;
+		CommandProducer* producer;
+	};
+
+	// Sends every command of the batch its result, taken from the tick's
+	// results starting at first, or POKEMONGO_TICK_FAILED if results is NULL
+	void Complete(const std::vector<PokemonGoStatus>* results, size_t first);
+
+	TickExecutor& executor;
+	MpscRing<QueuedCommand> queue;
+	const size_t batch_size;
+	// The commands of the tick being applied
+	std::vector<QueuedCommand> batch;
+	unsigned long long applied;
+
+	// Pushes commands to the queue
+	friend class CommandProducer;
+};
+
+}  // namespace pokemongo
+}  // namespace mtm
+
+#endif  // COMMAND_INGESTION_H
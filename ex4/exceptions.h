@@ -45,6 +45,19 @@ namespace pokemongo {
 
 	class ItemException : public MtmException {};
 	class ItemInvalidArgException : public ItemException {};
+
+	class JournalException : public MtmException {};
+	class JournalOpenFailedException : public JournalException {};
+	class JournalWriteFailedException : public JournalException {};
+	class JournalCorruptedException : public JournalException {};
+
+	class CheckpointException : public MtmException {};
+	class CheckpointOpenFailedException : public CheckpointException {};
+	class CheckpointWriteFailedException : public CheckpointException {};
+	class CheckpointCorruptedException : public CheckpointException {};
+
+	class ReportException : public MtmException {};
+	class ReportWriteFailedException : public ReportException {};
 }  //  namespace pokemongo
 }  //  namespace mtm
 
@@ -0,0 +1,75 @@
+#include "first_fit_index.h"
+
+#include <climits>
+
+#define INITIAL_CAPACITY	8
+// Marks removed values and unused leaves
+#define EMPTY				LLONG_MAX
+
+using namespace mtm::pokemongo;
+
+const long FirstFitIndex::NOT_FOUND;
+
+FirstFitIndex::FirstFitIndex()
+	: capacity(0), added(0), left(0), minimums() {}
+
+size_t FirstFitIndex::Add(int value) {
+	if (added == capacity) {
+		// Double the leaves and rebuild the tree above them
+		size_t grown_capacity = capacity == 0 ? INITIAL_CAPACITY :
+			capacity * 2;
+		std::vector<long long> grown(2 * grown_capacity, EMPTY);
+		for (size_t i = 0; i < added; i++) {
+			grown[grown_capacity + i] = minimums[capacity + i];
+		}
+		for (size_t node = grown_capacity - 1; node > 0; node--) {
+			grown[node] = grown[2 * node] < grown[2 * node + 1] ?
+				grown[2 * node] : grown[2 * node + 1];
+		}
+		minimums.swap(grown);
+		capacity = grown_capacity;
+	}
+	size_t position = added++;
+	left++;
+	Set(position, value);
+	return position;
+}
+
+long FirstFitIndex::FindFirst(int limit) const {
+	if (left == 0 || minimums[1] > limit) return NOT_FOUND;
+	// Go down to the leftmost child holding a small enough value
+	size_t node = 1;
+	while (node < capacity) {
+		node = minimums[2 * node] <= limit ? 2 * node : 2 * node + 1;
+	}
+	return (long)(node - capacity);
+}
+
+void FirstFitIndex::Remove(size_t position) {
+	Set(position, EMPTY);
+	left--;
+}
+
+bool FirstFitIndex::Contains(size_t position) const {
+	return position < added && minimums[capacity + position] != EMPTY;
+}
+
+size_t FirstFitIndex::Size() const {
+	return left;
+}
+
+void FirstFitIndex::Clear() {
+	capacity = 0;
+	added = 0;
+	left = 0;
+	minimums.clear();
+}
+
+void FirstFitIndex::Set(size_t position, long long value) {
+	size_t node = capacity + position;
+	minimums[node] = value;
+	for (node /= 2; node > 0; node /= 2) {
+		minimums[node] = minimums[2 * node] < minimums[2 * node + 1] ?
+			minimums[2 * node] : minimums[2 * node + 1];
+	}
+}
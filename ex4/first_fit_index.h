@@ -0,0 +1,73 @@
+#ifndef FIRST_FIT_INDEX_H
+#define FIRST_FIT_INDEX_H
+
+#include <cstddef>
+#include <vector>
+
+namespace mtm {
+namespace pokemongo {
+
+// An ordered list of integer values, which finds the first value not above
+// a given limit. Values are added at the end and removed from any position,
+// and positions are kept stable.
+//
+// Implemented as a segment tree holding the minimum value of every range of
+// positions. Adding is amortized O(1) and finding and removing are
+// O(log n), where n is the number of values ever added.
+class FirstFitIndex {
+public:
+	// Returned by FindFirst when no value is small enough
+	static const long NOT_FOUND = -1;
+
+	// Constructs an empty index.
+	FirstFitIndex();
+
+	// Adds a value after all values added so far.
+	//
+	// @param value the value to add.
+	// @return the position of the value, which is the number of values
+	//		   added before it.
+	size_t Add(int value);
+
+	// Finds the first value which is not above a limit.
+	//
+	// @param limit the largest value to find.
+	// @return the position of the first value not above limit, or NOT_FOUND.
+	long FindFirst(int limit) const;
+
+	// Removes the value in a position. Other values keep their positions.
+	//
+	// @param position position of a value which was not removed yet.
+	void Remove(size_t position);
+
+	// Checks whether the value in a position was removed.
+	//
+	// @param position a position returned by Add.
+	bool Contains(size_t position) const;
+
+	// Returns the number of values left.
+	size_t Size() const;
+
+	// Removes all values. Positions start again from 0.
+	void Clear();
+
+private:
+	// Sets a leaf and updates the minimums above it
+	void Set(size_t position, long long value);
+
+	// Number of leaves. Always a power of two, or 0.
+	size_t capacity;
+	// Number of values added, including removed ones
+	size_t added;
+	// Number of values left
+	size_t left;
+	// Node i holds the minimum of nodes 2i and 2i + 1, and the leaves are
+	// nodes capacity ... 2 * capacity - 1. Removed values and unused leaves
+	// hold LLONG_MAX, which no int value reaches.
+	std::vector<long long> minimums;
+};
+
+}  // namespace pokemongo
+}  // namespace mtm
+
+#endif  // FIRST_FIT_INDEX_H
@@ -1,45 +1,86 @@
 #include "gym.h"
 
+#include "metrics.h"
+
 using namespace mtm::pokemongo;
 
+bool Gym::StrongerFirst::operator()(const Candidate & lhs,
+									 const Candidate & rhs) const {
+	if (*lhs.trainer > *rhs.trainer) return true;
+	if (*lhs.trainer < *rhs.trainer) return false;
+	return lhs.arrival < rhs.arrival;
+}
+
 Trainer * Gym::PreferedTeamTrainer(Team team) {
-	Trainer* prefered_trainer = NULL;
+	if (candidates[team].empty()) return NULL;
+	return candidates[team].begin()->trainer;
+}
+
+void Gym::AddCandidate(Trainer & trainer, unsigned long arrival) {
+	Candidate candidate = { &trainer, arrival };
+	places[&trainer] = candidates[trainer.GetTeam()].insert(candidate).first;
+	trainer.SetStrengthObserver(this);
+}
+
+void Gym::RemoveCandidate(Trainer & trainer) {
+	std::unordered_map<const Trainer*, Candidates::iterator>::iterator place =
+		places.find(&trainer);
+	candidates[trainer.GetTeam()].erase(place->second);
+	places.erase(place);
+	trainer.SetStrengthObserver(NULL);
+}
+
+void Gym::StrengthChanged(const Trainer & trainer) {
+	Candidates::iterator& place = places.find(&trainer)->second;
+	Candidate candidate = *place;
+	// The set is out of order until the trainer is taken out, so it's
+	// erased by its position and not by comparing it
+	candidates[trainer.GetTeam()].erase(place);
+	place = candidates[trainer.GetTeam()].insert(candidate).first;
+}
+
+void Gym::IndexTrainers() {
+	places.clear();
+	for (Candidates& team_candidates : candidates) {
+		team_candidates.clear();
+	}
+	next_arrival = 0;
 	for (Trainer* trainer : trainers_) {
-		if (trainer->GetTeam() == team) {
-			if (NULL == prefered_trainer) {
-				prefered_trainer = trainer;
-			}
-			if (*trainer > *prefered_trainer) {
-				prefered_trainer = trainer;
-			}
-		}
+		AddCandidate(*trainer, next_arrival++);
 	}
-	return prefered_trainer;
 }
 
-void Gym::Arrive(Trainer & trainer) {
-	Location::Arrive(trainer);
+LocationStatus Gym::TryArrive(Trainer & trainer) {
+	LocationStatus status = Location::TryArrive(trainer);
+	if (status != LOCATION_SUCCESS) return status;
+	AddCandidate(trainer, next_arrival++);
+	Trainer* previous_leader = leader;
 	if (trainers_.size() == 1) {
 		// If gym was empty - new trainer is the leader
 		leader = &trainer;
 	} else if (leader->GetTeam() != trainer.GetTeam()) {
 		// If new trainer is from a different team, fight for leadership
-		leader->is_leader = false;
+		leader->SetLeader(false);
 		leader = TrainersBattle(*leader, trainer);
 	}
+	if (leader != previous_leader) METRICS_COUNT(METRIC_LEADER_CHANGES);
 
-	leader->is_leader = true;
+	leader->SetLeader(true);
+	return LOCATION_SUCCESS;
 }
 
 
-void Gym::Leave(Trainer & trainer) {
-	Location::Leave(trainer);
-	if (leader != &trainer) return;
+LocationStatus Gym::TryLeave(Trainer & trainer) {
+	LocationStatus status = Location::TryLeave(trainer);
+	if (status != LOCATION_SUCCESS) return status;
+	RemoveCandidate(trainer);
+	if (leader != &trainer) return LOCATION_SUCCESS;
 
-	trainer.is_leader = false;
+	METRICS_COUNT(METRIC_LEADER_CHANGES);
+	trainer.SetLeader(false);
 	if (trainers_.empty()) {
 		leader = NULL;
-		return;
+		return LOCATION_SUCCESS;
 	}
 	// Look for a new leader
 	leader = PreferedTeamTrainer(trainer.GetTeam());
@@ -61,5 +102,12 @@ void Gym::Leave(Trainer & trainer) {
 			leader = TrainersBattle(*first_prefered, *second_prefered);
 		}
 	}
-	leader->is_leader = true;
+	leader->SetLeader(true);
+	return LOCATION_SUCCESS;
+}
+
+TournamentResults Gym::RunTournament(TournamentFormat format,
+									 ThreadPool & pool) const {
+	std::vector<const Trainer*> entrants(trainers_.begin(), trainers_.end());
+	return mtm::pokemongo::RunTournament(entrants, format, pool);
 }
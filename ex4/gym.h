@@ -1,15 +1,47 @@
 #pragma once
+#include <set>
+#include <unordered_map>
+
 #include "location.h"
 #include "exceptions.h"
+#include "tournament.h"
 #include "trainer.h"
 
 namespace mtm {
 namespace pokemongo {
 
-class Gym : public Location {
+class Gym : public Location, private TrainerStrengthObserver {
 
 	Trainer* leader;
 
+	// A trainer in the gym and the order of its arrival
+	struct Candidate {
+		Trainer* trainer;
+		unsigned long arrival;
+	};
+
+	// Orders candidates from the strongest to the weakest. Trainers of equal
+	// strength are ordered by arrival.
+	struct StrongerFirst {
+		bool operator()(const Candidate& lhs, const Candidate& rhs) const;
+	};
+
+	typedef std::set<Candidate, StrongerFirst> Candidates;
+
+	// The gym's trainers of every team, strongest first. The gym observes
+	// the strength of its trainers, and moves a trainer whose strength
+	// changed to its new place.
+	Candidates candidates[RED + 1];
+
+	// The place of every trainer in the gym among the candidates of its team
+	std::unordered_map<const Trainer*, Candidates::iterator> places;
+
+	// Arrival number of the next arriving trainer
+	unsigned long next_arrival;
+
+	// Saves and restores the leader
+	friend class Checkpoint;
+
 	// Gets pointer to the most preferred team trainer in gym.
 	// A preferred trainer is the strongest trainer from the same
 	// team given.
@@ -17,32 +49,74 @@ class Gym : public Location {
 	// return NULL if no trainer for that team exist in gym
 	Trainer* PreferedTeamTrainer(Team team);
 
+	// Adds a trainer in the gym to the candidates of its team, and starts
+	// observing its strength
+	//
+	// @param trainer the trainer to add.
+	// @param arrival the arrival number of the trainer.
+	void AddCandidate(Trainer& trainer, unsigned long arrival);
+
+	// Removes a trainer leaving the gym from the candidates of its team, and
+	// stops observing its strength
+	//
+	// @param trainer the trainer to remove
+	void RemoveCandidate(Trainer& trainer);
+
+	// Moves a trainer to its place among the candidates of its team, after
+	// its strength changed
+	//
+	// @param trainer the trainer whose strength changed
+	void StrengthChanged(const Trainer& trainer) override;
+
+	// Numbers the arrivals of the trainers in the gym by their order, and
+	// builds the candidates of every team from scratch
+	void IndexTrainers();
+
 public:
 
 	~Gym() {}
 
 	// Constructs a new gym with no leader.
-	Gym() : leader(NULL) {}
+	Gym() : leader(NULL), next_arrival(0) {}
 
-	// make copy and assignment operator as compiler's default
-	Gym(const Gym& gym) = default;
-	Gym& operator=(const Gym& gym) = default;
+	// Disable copy and assignment, as the gym's trainers notify the gym
+	// itself of their changes
+	Gym(const Gym& gym) = delete;
+	Gym& operator=(const Gym& gym) = delete;
+
+	LocationType Type() const override {
+		return LOCATION_GYM;
+	}
 
 	// Handle a new trainer arriving to Gym, trying his luck to be the leader!
 	//
 	// @param trainer the trainer arriving.
-	// @throw LocationTrainerAlreadyInLocationException if trainer is already
-	//		  in the gym.
-	void Arrive(Trainer& trainer) override;
+	// @return LOCATION_TRAINER_ALREADY_IN_LOCATION if trainer is already
+	//		   in the gym.
+	LocationStatus TryArrive(Trainer& trainer) override;
 
 	// Handle an old trainer leaving the gym for a new adventure
 	// If the trainer was the leader, making other trainer (if exist) the
 	// leader according to the exercise sheet.
 	//
 	// @param trainer the trainer leaving.
-	// @throw LocationTrainerNotFoundException if trainer is not
-	//		  in the gym.
-	void Leave(Trainer& trainer) override;
+	// @return LOCATION_TRAINER_NOT_FOUND if trainer is not in the gym.
+	LocationStatus TryLeave(Trainer& trainer) override;
+
+	// Returns the leader of the gym, or NULL if the gym is empty.
+	const Trainer* GetLeader() const {
+		return leader;
+	}
+
+	// Runs a tournament between copies of the trainers in the gym, which are
+	// entered by their order of arrival. Neither the gym nor its trainers
+	// change.
+	//
+	// @param format the format of the tournament.
+	// @param pool the threads to run the matches on.
+	// @return the results of the tournament.
+	TournamentResults RunTournament(TournamentFormat format,
+									ThreadPool& pool) const;
 
 };
 
@@ -1,5 +1,7 @@
 #ifndef ITEM_H
 #define ITEM_H
+#include <cstdint>
+
 #include "pokemon.h"
 #include "exceptions.h"
 
@@ -10,6 +12,53 @@ namespace pokemongo {
 // Used in cp_multiplier formula below
 static const int CP_LEVEL_FACTOR = 10;
 
+// Kinds of items
+typedef enum {
+	ITEM_CANDY,
+	ITEM_POTION,
+} ItemKind;
+
+// An item as a plain value: its kind and level, in 8 bytes. Inventories
+// store items this way, so they need no allocation per item and no virtual
+// calls.
+class ItemValue {
+public:
+	// Creates a new item
+	// @param kind - the new item's kind
+	// @param level - the new item's level
+	// @throws ItemInvalidArgException if level is negative
+	ItemValue(ItemKind kind, int level) : level(level), kind(kind) {
+		if (level < 0) throw ItemInvalidArgException();
+	}
+	// Creates a level 0 candy, as a placeholder in containers
+	ItemValue() : level(0), kind(ITEM_CANDY) {}
+
+	ItemKind Kind() const {
+		return (ItemKind)kind;
+	}
+	int Level() const {
+		return level;
+	}
+	// Use the item on a pokemon
+	// @param pokemon - the pokemon to use the item on
+	void Use(Pokemon& pokemon) const {
+		switch (kind) {
+		case ITEM_CANDY:
+			// Train the pokemon
+			pokemon.Train(1 + ((double)pokemon.Level()) / CP_LEVEL_FACTOR);
+			break;
+		case ITEM_POTION:
+			// Heal the pokemon
+			pokemon.Heal();
+			break;
+		}
+	}
+
+private:
+	int32_t level;
+	uint8_t kind;
+};
+
 // Abstract Item class
 class Item {
 public:
@@ -26,6 +75,8 @@ public:
 	// Use the item on a pokemon
 	// @param pokemon - the pokemon to use the item on
 	virtual void Use(Pokemon&) = 0;
+	// The item as a plain value
+	virtual ItemValue Value() const = 0;
 };
 
 // Candy. Used to train a pokemon
@@ -34,9 +85,10 @@ public:
 	Candy(int level) : Item(level) {}
 	~Candy() {}
 	void Use(Pokemon& pokemon) override {
-		int pokemon_level = pokemon.Level();
-		double cp_multiplier = 1 + ((double)pokemon_level)/CP_LEVEL_FACTOR;
-		pokemon.Train(cp_multiplier);
+		Value().Use(pokemon);
+	}
+	ItemValue Value() const override {
+		return ItemValue(ITEM_CANDY, level);
 	}
 };
 
@@ -46,7 +98,10 @@ public:
 	Potion(int level) : Item(level) {}
 	~Potion() {}
 	void Use(Pokemon& pokemon) override {
-		pokemon.Heal();
+		Value().Use(pokemon);
+	}
+	ItemValue Value() const override {
+		return ItemValue(ITEM_POTION, level);
 	}
 };
 } // pokemongo namespace
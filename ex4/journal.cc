@@ -0,0 +1,317 @@
+#include "journal.h"
+
+#include <chrono>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+
+#include "exceptions.h"
+
+using namespace mtm::pokemongo;
+
+// Written at the start of every journal file
+#define JOURNAL_MAGIC			"PGJ1"
+#define JOURNAL_MAGIC_SIZE		4
+// The writer is woken once this many bytes are buffered
+#define FLUSH_THRESHOLD_BYTES	(64 * 1024)
+// Buffered records are written at least this often
+#define FLUSH_INTERVAL_MS		100
+
+// Record types as stored in the file. Kept apart from JournalRecordType so
+// the file format doesn't change if the enum does.
+#define RECORD_LOCATION			0
+#define RECORD_CONNECT			1
+#define RECORD_ADD_TRAINER		2
+#define RECORD_MOVE_TRAINER		3
+#define RECORD_WORLD_CHANGE		4
+
+Journal::Journal(const std::string & path)
+	: file(std::fopen(path.c_str(), "wb")), next_sequence_number(0),
+	  appended_bytes(0), written_bytes(0), flush_requested(false),
+	  stopping(false), failed(false) {
+	if (file == NULL) throw JournalOpenFailedException();
+	pending.append(JOURNAL_MAGIC, JOURNAL_MAGIC_SIZE);
+	appended_bytes = pending.size();
+	writer = std::thread(&Journal::WriterLoop, this);
+}
+
+Journal::~Journal() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	data_ready.notify_one();
+	writer.join();
+	std::fclose(file);
+}
+
+void Journal::WriterLoop() {
+	std::string writing;
+	std::unique_lock<std::mutex> lock(mutex);
+	while (true) {
+		data_ready.wait_for(lock,
+							std::chrono::milliseconds(FLUSH_INTERVAL_MS),
+							[&] {
+			return stopping || flush_requested ||
+				pending.size() >= FLUSH_THRESHOLD_BYTES;
+		});
+		if (pending.empty()) {
+			flush_requested = false;
+			data_written.notify_all();
+			if (stopping) return;
+			continue;
+		}
+		// Write outside the lock, so recording goes on meanwhile
+		writing.swap(pending);
+		flush_requested = false;
+		lock.unlock();
+		bool written = std::fwrite(writing.data(), 1, writing.size(), file) ==
+			writing.size() && std::fflush(file) == 0;
+		lock.lock();
+		written_bytes += writing.size();
+		if (!written) failed = true;
+		writing.clear();
+		data_written.notify_all();
+	}
+}
+
+std::string & Journal::RecordBuffer() {
+	static thread_local std::string buffer;
+	buffer.clear();
+	return buffer;
+}
+
+void Journal::Append(int record_type, const std::string & fields) {
+	std::lock_guard<std::mutex> lock(mutex);
+	size_t size = pending.size();
+	PutVarint(pending, record_type);
+	PutVarint(pending, next_sequence_number++);
+	pending.append(fields);
+	appended_bytes += pending.size() - size;
+	if (pending.size() >= FLUSH_THRESHOLD_BYTES) data_ready.notify_one();
+}
+
+void Journal::RecordLocation(const std::string & line) {
+	std::string& fields = RecordBuffer();
+	PutString(fields, line);
+	Append(RECORD_LOCATION, fields);
+}
+
+void Journal::RecordConnect(const std::string & from, const std::string & to,
+							const Direction & from_direction,
+							const Direction & to_direction) {
+	std::string& fields = RecordBuffer();
+	PutString(fields, from);
+	PutString(fields, to);
+	PutSignedVarint(fields, from_direction);
+	PutSignedVarint(fields, from == to ? 0 : to_direction);
+	Append(RECORD_CONNECT, fields);
+}
+
+void Journal::RecordAddTrainer(const std::string & name, const Team & team,
+							   const std::string & location,
+							   PokemonGoStatus status) {
+	std::string& fields = RecordBuffer();
+	PutString(fields, name);
+	PutVarint(fields, team);
+	PutString(fields, location);
+	PutVarint(fields, status);
+	Append(RECORD_ADD_TRAINER, fields);
+}
+
+void Journal::RecordMoveTrainer(const std::string & trainer_name,
+								const Direction & dir,
+								PokemonGoStatus status) {
+	std::string& fields = RecordBuffer();
+	PutString(fields, trainer_name);
+	PutSignedVarint(fields, dir);
+	PutVarint(fields, status);
+	Append(RECORD_MOVE_TRAINER, fields);
+}
+
+void Journal::RecordCommand(const GameCommand & command,
+							PokemonGoStatus status) {
+	if (command.type == ADD_TRAINER) {
+		RecordAddTrainer(command.trainer_name, command.team, command.location,
+						 status);
+	} else {
+		RecordMoveTrainer(command.trainer_name, command.direction, status);
+	}
+}
+
+void Journal::RecordWorldChange(const WorldChange & change,
+								WorldChangeStatus status) {
+	std::string& fields = RecordBuffer();
+	PutVarint(fields, change.type);
+	PutString(fields, change.line);
+	PutString(fields, change.location);
+	PutString(fields, change.other);
+	PutSignedVarint(fields, change.direction);
+	PutSignedVarint(fields, change.other_direction);
+	PutVarint(fields, status);
+	Append(RECORD_WORLD_CHANGE, fields);
+}
+
+void Journal::Flush() {
+	std::unique_lock<std::mutex> lock(mutex);
+	unsigned long long target = appended_bytes;
+	flush_requested = true;
+	data_ready.notify_one();
+	data_written.wait(lock, [&] { return written_bytes >= target; });
+	if (failed) throw JournalWriteFailedException();
+}
+
+unsigned long long Journal::RecordsNum() const {
+	std::lock_guard<std::mutex> lock(mutex);
+	return next_sequence_number;
+}
+
+JournalReader::JournalReader(const std::string & path)
+	: reader(NULL, NULL), truncated(false) {
+	std::ifstream input(path.c_str(), std::ios::binary);
+	if (!input) throw JournalOpenFailedException();
+	data.assign(std::istreambuf_iterator<char>(input),
+				std::istreambuf_iterator<char>());
+	if (data.compare(0, JOURNAL_MAGIC_SIZE, JOURNAL_MAGIC) != 0) {
+		throw JournalCorruptedException();
+	}
+	reader = BinaryReader(data.data() + JOURNAL_MAGIC_SIZE,
+						  data.data() + data.size());
+}
+
+bool JournalReader::Truncated() const {
+	return truncated;
+}
+
+bool JournalReader::Next(JournalRecord * record) {
+	if (reader.AtEnd()) return false;
+	const char* start = reader.Position();
+	unsigned long long type = 0, status = 0, team = 0, change_type = 0;
+	long long direction = 0, other_direction = 0;
+	bool complete = reader.GetVarint(&type) &&
+		reader.GetVarint(&record->sequence_number);
+	if (complete) {
+		switch (type) {
+		case RECORD_LOCATION:
+			record->type = JOURNAL_LOCATION;
+			complete = reader.GetString(&record->line);
+			break;
+		case RECORD_CONNECT:
+			record->type = JOURNAL_CONNECT;
+			complete = reader.GetString(&record->from) &&
+				reader.GetString(&record->to) &&
+				reader.GetSignedVarint(&direction) &&
+				reader.GetSignedVarint(&other_direction);
+			record->from_direction = (Direction)direction;
+			record->to_direction = (Direction)other_direction;
+			break;
+		case RECORD_ADD_TRAINER:
+			record->type = JOURNAL_COMMAND;
+			record->command = GameCommand::AddTrainer("", BLUE, "");
+			complete = reader.GetString(&record->command.trainer_name) &&
+				reader.GetVarint(&team) &&
+				reader.GetString(&record->command.location) &&
+				reader.GetVarint(&status);
+			if (complete && team > RED) throw JournalCorruptedException();
+			record->command.team = (Team)team;
+			break;
+		case RECORD_MOVE_TRAINER:
+			record->type = JOURNAL_COMMAND;
+			record->command = GameCommand::MoveTrainer("", NORTH);
+			complete = reader.GetString(&record->command.trainer_name) &&
+				reader.GetSignedVarint(&direction) &&
+				reader.GetVarint(&status);
+			record->command.direction = (Direction)direction;
+			break;
+		case RECORD_WORLD_CHANGE:
+			record->type = JOURNAL_WORLD_CHANGE;
+			complete = reader.GetVarint(&change_type) &&
+				reader.GetString(&record->change.line) &&
+				reader.GetString(&record->change.location) &&
+				reader.GetString(&record->change.other) &&
+				reader.GetSignedVarint(&direction) &&
+				reader.GetSignedVarint(&other_direction) &&
+				reader.GetVarint(&status);
+			if (complete && change_type > DISCONNECT_LOCATIONS) {
+				throw JournalCorruptedException();
+			}
+			record->change.type = (WorldChangeType)change_type;
+			record->change.direction = (Direction)direction;
+			record->change.other_direction = (Direction)other_direction;
+			break;
+		default:
+			throw JournalCorruptedException();
+		}
+	}
+	if (!complete) {
+		reader.Seek(start);
+		truncated = true;
+		return false;
+	}
+	if (record->type == JOURNAL_COMMAND) {
+		if (status > POKEMONGO_INVALID_DIRECTION) {
+			throw JournalCorruptedException();
+		}
+		record->status = (PokemonGoStatus)status;
+	} else if (record->type == JOURNAL_WORLD_CHANGE) {
+		if (status > WORLD_CHANGE_NOT_CONNECTED) {
+			throw JournalCorruptedException();
+		}
+		record->change_status = (WorldChangeStatus)status;
+	}
+	return true;
+}
+
+PokemonGo* mtm::pokemongo::ReplayJournal(JournalReader & reader,
+										 JournalReplayStats * stats) {
+	JournalReplayStats counters = { 0, 0, 0 };
+	World* world = new World();
+	PokemonGo* game = NULL;
+	JournalRecord record;
+	try {
+		while (reader.Next(&record)) {
+			counters.records++;
+			if ((record.type == JOURNAL_LOCATION ||
+				 record.type == JOURNAL_CONNECT) && game != NULL) {
+				// Once the game started, its world changes by world change
+				// records only
+				throw JournalCorruptedException();
+			}
+			if (record.type == JOURNAL_LOCATION) {
+				std::istringstream line(record.line);
+				line >> *world;
+			} else if (record.type == JOURNAL_CONNECT) {
+				if (record.from == record.to) {
+					world->Connect(record.from, record.from_direction);
+				} else {
+					world->Connect(record.from, record.to,
+								   record.from_direction, record.to_direction);
+				}
+			} else if (record.type == JOURNAL_WORLD_CHANGE) {
+				if (game == NULL) game = new PokemonGo(world);
+				counters.commands++;
+				if (game->TryApplyWorldChange(record.change) !=
+					record.change_status) {
+					counters.mismatches++;
+				}
+			} else {
+				if (game == NULL) game = new PokemonGo(world);
+				counters.commands++;
+				if (game->TryApply(record.command) != record.status) {
+					counters.mismatches++;
+				}
+			}
+		}
+	}
+	catch (...) {
+		if (game != NULL) {
+			delete game;
+		} else {
+			delete world;
+		}
+		throw;
+	}
+	if (game == NULL) game = new PokemonGo(world);
+	if (stats != NULL) *stats = counters;
+	return game;
+}
@@ -0,0 +1,196 @@
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "binary_io.h"
+#include "command.h"
+#include "pokemon_go.h"
+#include "status.h"
+#include "world.h"
+#include "world_diff.h"
+
+namespace mtm {
+namespace pokemongo {
+
+typedef enum {
+	// A world input line, as read by operator>>(std::istream&, World&)
+	JOURNAL_LOCATION,
+	// Two locations connected, or a location connected to itself
+	JOURNAL_CONNECT,
+	// A call of AddTrainer or MoveTrainer, with its result
+	JOURNAL_COMMAND,
+	// A change applied to the world of a running game, with its result
+	JOURNAL_WORLD_CHANGE,
+} JournalRecordType;
+
+// A single journal entry. Only the fields of the record's type are set.
+struct JournalRecord {
+	JournalRecordType type;
+	// Position of the record in the journal, starting at 0
+	unsigned long long sequence_number;
+
+	// JOURNAL_LOCATION
+	std::string line;
+
+	// JOURNAL_CONNECT. A self loop has from == to, and to_direction unused.
+	std::string from;
+	std::string to;
+	Direction from_direction;
+	Direction to_direction;
+
+	// JOURNAL_COMMAND
+	GameCommand command;
+	PokemonGoStatus status;
+
+	// JOURNAL_WORLD_CHANGE
+	WorldChange change;
+	WorldChangeStatus change_status;
+};
+
+// An append-only binary log of everything which changed a game: the world's
+// locations and edges, then every AddTrainer and MoveTrainer call and every
+// change to the world while the game runs, with its result. Replaying a
+// journal on a new game rebuilds the same game state, which is used for
+// crash recovery and as a realistic benchmark input.
+//
+// Records are encoded with varints (see binary_io.h) into a memory buffer.
+// A background thread writes the buffer to the file once it grows large
+// enough, or periodically, so recording never waits for the disk.
+// Recording is thread safe.
+class Journal {
+public:
+	// Creates a new journal file, overwriting an existing one.
+	//
+	// @param path path of the journal file.
+	// @throw JournalOpenFailedException if the file can't be created.
+	explicit Journal(const std::string& path);
+
+	// Writes all records to the file and closes it.
+	~Journal();
+
+	// Disable copy and assignment.
+	Journal(const Journal&) = delete;
+	Journal& operator=(const Journal&) = delete;
+
+	// Records a location added to the world.
+	//
+	// @param line the world input line which added the location.
+	void RecordLocation(const std::string& line);
+
+	// Records two locations connected in the world. For a self loop pass the
+	// same location twice; to_direction is ignored then.
+	void RecordConnect(const std::string& from, const std::string& to,
+					   const Direction& from_direction,
+					   const Direction& to_direction);
+
+	// Records a game command and its result.
+	void RecordAddTrainer(const std::string& name, const Team& team,
+						  const std::string& location,
+						  PokemonGoStatus status);
+	void RecordMoveTrainer(const std::string& trainer_name,
+						   const Direction& dir, PokemonGoStatus status);
+	void RecordCommand(const GameCommand& command, PokemonGoStatus status);
+
+	// Records a change applied to the world of a running game, and its
+	// result.
+	void RecordWorldChange(const WorldChange& change,
+						   WorldChangeStatus status);
+
+	// Blocks until every record so far is written to the file.
+	//
+	// @throw JournalWriteFailedException if writing to the file failed.
+	void Flush();
+
+	// Returns the number of records so far.
+	unsigned long long RecordsNum() const;
+
+private:
+	// Returns an empty buffer for encoding a record's fields, reused by all
+	// records of the calling thread.
+	static std::string& RecordBuffer();
+
+	// Appends a record to the pending data, numbering it, and wakes the
+	// writer if enough data is buffered.
+	//
+	// @param record_type type of the record in the file.
+	// @param fields the record's encoded fields.
+	void Append(int record_type, const std::string& fields);
+
+	// Main loop of the writer thread
+	void WriterLoop();
+
+	std::FILE* file;
+	mutable std::mutex mutex;
+	std::condition_variable data_ready;
+	std::condition_variable data_written;
+
+	// Guarded by mutex
+	std::string pending;
+	unsigned long long next_sequence_number;
+	unsigned long long appended_bytes;
+	unsigned long long written_bytes;
+	bool flush_requested;
+	bool stopping;
+	bool failed;
+
+	std::thread writer;
+};
+
+// Reads the records of a journal file, in order.
+class JournalReader {
+public:
+	// Reads a whole journal file to memory.
+	//
+	// @param path path of the journal file.
+	// @throw JournalOpenFailedException if the file can't be read.
+	// @throw JournalCorruptedException if the file is not a journal.
+	explicit JournalReader(const std::string& path);
+
+	// Reads the next record.
+	//
+	// @param record set to the next record.
+	// @return false if there are no more records. A partially written last
+	//		   record (e.g. after a crash) ends the journal too.
+	// @throw JournalCorruptedException if the record is invalid.
+	bool Next(JournalRecord* record);
+
+	// Returns true if the journal ended with a partially written record.
+	bool Truncated() const;
+
+private:
+	std::string data;
+	BinaryReader reader;
+	bool truncated;
+};
+
+// Counters of a journal replay
+struct JournalReplayStats {
+	unsigned long long records;
+	// Commands and world changes of the running game
+	unsigned long long commands;
+	// Commands and world changes whose result differs from the recorded one
+	unsigned long long mismatches;
+};
+
+// Rebuilds a game from a journal: builds the world from the location and
+// connection records, then applies every command and world change on a new
+// game.
+//
+// @param reader the journal to replay.
+// @param stats if not NULL, filled with the replay's counters.
+// @return the new game. The caller is responsible for deleting it.
+// @throw JournalCorruptedException if a location or connection record follows
+//		  a command or a world change.
+// @throw WorldInvalidInputLineException, WorldLocationNameAlreadyUsed or
+//		  a KGraph exception if a world record can't be applied.
+PokemonGo* ReplayJournal(JournalReader& reader, JournalReplayStats* stats);
+
+}  // namespace pokemongo
+}  // namespace mtm
+
+#endif  // JOURNAL_H
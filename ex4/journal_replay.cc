@@ -0,0 +1,64 @@
+// Replays a game journal on a new game as fast as possible, and reports the
+// replay's throughput.
+//
+// Usage: journal_replay <journal> [repetitions]
+//
+// The journal is read to memory once. Each repetition builds a new game from
+// it, so only the game's work is measured. The exit status is 1 if any
+// command's result differs from the recorded one.
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "exceptions.h"
+#include "journal.h"
+
+using namespace mtm::pokemongo;
+
+int main(int argc, char* argv[]) {
+	if (argc < 2 || argc > 3) {
+		std::cerr << "Usage: " << argv[0] << " <journal> [repetitions]"
+				  << std::endl;
+		return 2;
+	}
+	int repetitions = argc == 3 ? std::atoi(argv[2]) : 1;
+	if (repetitions < 1) repetitions = 1;
+
+	JournalReplayStats stats = { 0, 0, 0 };
+	double seconds = 0;
+	try {
+		for (int i = 0; i < repetitions; i++) {
+			JournalReader reader(argv[1]);
+			std::chrono::steady_clock::time_point start =
+				std::chrono::steady_clock::now();
+			PokemonGo* game = ReplayJournal(reader, &stats);
+			seconds += std::chrono::duration<double>(
+				std::chrono::steady_clock::now() - start).count();
+			delete game;
+			if (i == 0 && reader.Truncated()) {
+				std::cerr << "warning: journal ends with a partial record"
+						  << std::endl;
+			}
+		}
+	}
+	catch (JournalOpenFailedException&) {
+		std::cerr << "Can't read " << argv[1] << std::endl;
+		return 2;
+	}
+	catch (mtm::MtmException&) {
+		std::cerr << argv[1] << " is not a valid journal" << std::endl;
+		return 2;
+	}
+
+	std::cout << "records: " << stats.records << std::endl;
+	std::cout << "commands: " << stats.commands << std::endl;
+	std::cout << "mismatches: " << stats.mismatches << std::endl;
+	std::cout << "seconds: " << seconds / repetitions << std::endl;
+	if (seconds > 0) {
+		std::cout << "commands/s: "
+				  << stats.commands * repetitions / seconds << std::endl;
+	}
+	return stats.mismatches == 0 ? 0 : 1;
+}
@@ -2,6 +2,8 @@
 #define K_GRAPH_MTM_H
 
 #include "exceptions.h"
+#include "memory_accounting.h"
+#include "status.h"
 #include <unordered_map>
 #include <vector>
 
@@ -18,7 +20,8 @@ template<typename KeyType, typename ValueType, int k> class KGraph {
   class Node {
 	  KeyType key;
 	  ValueType value;
-	  std::vector<Node*> edges;
+	  std::vector<Node*, pokemongo::CountingAllocator<Node*,
+		  pokemongo::MEMORY_GRAPH_NODES> > edges;
     public:
     // Constructs a new node with the given key and value.
     //
@@ -60,9 +63,38 @@ template<typename KeyType, typename ValueType, int k> class KGraph {
 	}
   };
 
-  std::unordered_map<KeyType, Node> nodes;
+  // The nodes by key. Their memory is accounted as graph nodes.
+  typedef std::unordered_map<KeyType, Node, std::hash<KeyType>,
+	  std::equal_to<KeyType>,
+	  pokemongo::CountingAllocator<std::pair<const KeyType, Node>,
+								   pokemongo::MEMORY_GRAPH_NODES> > NodeMap;
+  NodeMap nodes;
   ValueType default_value;
 
+  // Throws the exception matching a failed status. Does nothing on success.
+  //
+  // @param status result of one of the Try functions.
+  static void ThrowOnError(KGraphStatus status) {
+	  switch (status) {
+	  case KGRAPH_KEY_NOT_FOUND:
+		  throw KGraphKeyNotFoundException();
+	  case KGRAPH_KEY_ALREADY_EXISTS:
+		  throw KGraphKeyAlreadyExistsExpection();
+	  case KGRAPH_ITERATOR_REACHED_END:
+		  throw KGraphIteratorReachedEnd();
+	  case KGRAPH_EDGE_OUT_OF_RANGE:
+		  throw KGraphEdgeOutOfRange();
+	  case KGRAPH_EDGE_ALREADY_IN_USE:
+		  throw KGraphEdgeAlreadyInUse();
+	  case KGRAPH_NODES_ALREADY_CONNECTED:
+		  throw KGraphNodesAlreadyConnected();
+	  case KGRAPH_NODES_ARE_NOT_CONNECTED:
+		  throw kGraphNodesAreNotConnected();
+	  default:
+		  return;
+	  }
+  }
+
  public:
   class const_iterator;  // forward declaration
   
@@ -248,7 +280,7 @@ template<typename KeyType, typename ValueType, int k> class KGraph {
   KGraph(const KGraph& k_graph)
 	  : nodes(k_graph.nodes), default_value(k_graph.default_value)
   {
-	  typename std::unordered_map<KeyType, Node>::iterator it;
+	  typename NodeMap::iterator it;
 	  for (it = nodes.begin(); it != nodes.end(); it++) {
 		  Node* new_node = &(*it).second;
 		  const Node* original_node = &k_graph.nodes.at(new_node->Key());
@@ -292,10 +324,17 @@ template<typename KeyType, typename ValueType, int k> class KGraph {
   // @throw KGraphKeyAlreadyExistsExpection when trying to insert a node with a
   //        key that already exists in the graph.
   void Insert(KeyType const& key, ValueType const& value) {
-	  if (Contains(key)) {
-		  throw KGraphKeyAlreadyExistsExpection();
-	  }
+	  ThrowOnError(TryInsert(key, value));
+  }
+
+  // Non-throwing version of Insert.
+  //
+  // @return KGRAPH_KEY_ALREADY_EXISTS if the key is already in the graph,
+  //         KGRAPH_SUCCESS otherwise.
+  KGraphStatus TryInsert(KeyType const& key, ValueType const& value) {
+	  if (Contains(key)) return KGRAPH_KEY_ALREADY_EXISTS;
 	  nodes.insert({ key, Node(key, value) });
+	  return KGRAPH_SUCCESS;
   }
 
   // Inserts a new node with the given key and the default value to the graph.
@@ -304,10 +343,7 @@ template<typename KeyType, typename ValueType, int k> class KGraph {
   // @throw KGraphKeyAlreadyExistsExpection when trying to insert a node with a
   //        key that already exists in the graph.
   void Insert(KeyType const& key) {
-	  if (Contains(key)) {
-		  throw KGraphKeyAlreadyExistsExpection();
-	  }
-	  nodes.insert({ key, Node(key, default_value) });
+	  ThrowOnError(TryInsert(key, default_value));
   }
 
   // Removes the node with the given key from the graph.
@@ -316,13 +352,25 @@ template<typename KeyType, typename ValueType, int k> class KGraph {
   // @throw KGraphKeyNotFoundException when trying to remove a key that cannot
   //        be found in the graph.
   void Remove(KeyType const& key) {
-	  if (!Contains(key)) throw KGraphKeyNotFoundException();
+	  ThrowOnError(TryRemove(key));
+  }
+
+  // Non-throwing version of Remove.
+  //
+  // @return KGRAPH_KEY_NOT_FOUND if the key is not in the graph,
+  //         KGRAPH_SUCCESS otherwise.
+  KGraphStatus TryRemove(KeyType const& key) {
+	  typename NodeMap::iterator found =
+		  nodes.find(key);
+	  if (found == nodes.end()) return KGRAPH_KEY_NOT_FOUND;
+	  Node& node = found->second;
 	  for (int i = 0; i < k; i++) {
-		  if (nodes.at(key)[i] != NULL) {
-			  Disconnect(nodes.at(key).Key(), (*nodes.at(key)[i]).Key());
+		  if (node[i] != NULL) {
+			  TryDisconnect(node.Key(), node[i]->Key());
 		  }
 	  }
-	  nodes.erase(key);
+	  nodes.erase(found);
+	  return KGRAPH_SUCCESS;
   }
 
   // Removes the node pointed by the given iterator from the graph. If the
@@ -334,12 +382,9 @@ template<typename KeyType, typename ValueType, int k> class KGraph {
   //        of the graph.
   void Remove(const iterator& it) {
 	  if (it == End()) throw KGraphIteratorReachedEnd();
-	  for (int i = 0; i < k; i++) {
-		  if (nodes.at(*it)[i] != NULL) {
-			  Disconnect(nodes.at(*it).Key(), (*nodes.at(*it)[i]).Key());
-		  }
-	  }
-	  nodes.erase(*it);
+	  // Copy the key, the node holding it is erased
+	  KeyType key = *it;
+	  ThrowOnError(TryRemove(key));
 	  // TODO: what happens to iterator after it's node is erased?!
   }
 
@@ -369,6 +414,41 @@ template<typename KeyType, typename ValueType, int k> class KGraph {
 	  return nodes.at(key).Value();
   }
 
+  // Non-throwing version of the const subscript operator.
+  //
+  // @param key the key to return its value.
+  // @param value set to the value assigned to the key, on success.
+  // @return KGRAPH_KEY_NOT_FOUND if the key is not in the graph,
+  //         KGRAPH_SUCCESS otherwise.
+  KGraphStatus TryGet(KeyType const& key, ValueType* value) const {
+	  typename NodeMap::const_iterator found =
+		  nodes.find(key);
+	  if (found == nodes.end()) return KGRAPH_KEY_NOT_FOUND;
+	  *value = found->second.Value();
+	  return KGRAPH_SUCCESS;
+  }
+
+  // Finds the neighbor connected to a node through edge i, the same as
+  // BeginAt(key).Move(i) without throwing.
+  //
+  // @param key the key of the node.
+  // @param i the edge over which to move.
+  // @param neighbor set to the key of the neighbor, on success.
+  // @return KGRAPH_KEY_NOT_FOUND if the key is not in the graph,
+  //         KGRAPH_EDGE_OUT_OF_RANGE if i is not in the range [0,k-1],
+  //         KGRAPH_ITERATOR_REACHED_END if nothing is connected through i,
+  //         KGRAPH_SUCCESS otherwise.
+  KGraphStatus TryMove(KeyType const& key, int i, KeyType* neighbor) const {
+	  typename NodeMap::const_iterator found =
+		  nodes.find(key);
+	  if (found == nodes.end()) return KGRAPH_KEY_NOT_FOUND;
+	  if (i < 0 || i >= k) return KGRAPH_EDGE_OUT_OF_RANGE;
+	  const Node* next = found->second[i];
+	  if (NULL == next) return KGRAPH_ITERATOR_REACHED_END;
+	  *neighbor = next->Key();
+	  return KGRAPH_SUCCESS;
+  }
+
   // Checks whether the graph contains the given key.
   //
   // @param key
@@ -390,26 +470,39 @@ template<typename KeyType, typename ValueType, int k> class KGraph {
   // @throw KGraphEdgeAlreadyInUse if at least one of the indices of the edge at
   //        one of the nodes is already in use.
   void Connect(KeyType const& key_u, KeyType const& key_v, int i_u, int i_v) {
-	  if (nodes.find(key_u) == nodes.end() ||
-		  nodes.find(key_v) == nodes.end()) {
-		  throw KGraphKeyNotFoundException();
+	  ThrowOnError(TryConnect(key_u, key_v, i_u, i_v));
+  }
+
+  // Non-throwing version of Connect.
+  //
+  // @return the status matching each of the exceptions Connect throws,
+  //         KGRAPH_SUCCESS if the nodes were connected.
+  KGraphStatus TryConnect(KeyType const& key_u, KeyType const& key_v,
+						  int i_u, int i_v) {
+	  typename NodeMap::iterator u_it =
+		  nodes.find(key_u);
+	  typename NodeMap::iterator v_it =
+		  nodes.find(key_v);
+	  if (u_it == nodes.end() || v_it == nodes.end()) {
+		  return KGRAPH_KEY_NOT_FOUND;
 	  }
 	  if (i_u < 0 || i_u >= k ||
 		  i_v < 0 || i_v >= k) {
-		  throw KGraphEdgeOutOfRange();
+		  return KGRAPH_EDGE_OUT_OF_RANGE;
 	  }
+	  Node& u = u_it->second;
+	  Node& v = v_it->second;
 	  for (int i = 0; i < k; i++) {
-		  if (nodes.at(key_u)[i] == &nodes.at(key_v) ||
-			  nodes.at(key_v)[i] == &nodes.at(key_u)) {
-			  throw KGraphNodesAlreadyConnected();
+		  if (u[i] == &v || v[i] == &u) {
+			  return KGRAPH_NODES_ALREADY_CONNECTED;
 		  }
 	  }
-	  if (nodes.at(key_u)[i_u] != NULL ||
-		  nodes.at(key_v)[i_v] != NULL) {
-		  throw KGraphEdgeAlreadyInUse();
+	  if (u[i_u] != NULL || v[i_v] != NULL) {
+		  return KGRAPH_EDGE_ALREADY_IN_USE;
 	  }
-	  nodes.at(key_v)[i_v] = &nodes.at(key_u);
-	  nodes.at(key_u)[i_u] = &nodes.at(key_v);
+	  v[i_v] = &u;
+	  u[i_u] = &v;
+	  return KGRAPH_SUCCESS;
   }
 
   // Connects a node to itself via a self loop.
@@ -423,21 +516,25 @@ template<typename KeyType, typename ValueType, int k> class KGraph {
   // @throw KGraphEdgeAlreadyInUse if the index of the self loop is already in
   //        use.
   void Connect(KeyType const& key, int i) {
-	  if (nodes.find(key) == nodes.end()) {
-		  throw KGraphKeyNotFoundException();
-	  }
-	  if (i < 0 || i >= k) {
-		  throw KGraphEdgeOutOfRange();
-	  }
-	  for (int i = 0; i < k; i++) {
-		  if (nodes.at(key)[i] == &nodes.at(key)) {
-			  throw KGraphNodesAlreadyConnected();
-		  }
-	  }
-	  if (nodes.at(key)[i] != NULL) {
-		  throw KGraphEdgeAlreadyInUse();
+	  ThrowOnError(TryConnect(key, i));
+  }
+
+  // Non-throwing version of the self loop Connect.
+  //
+  // @return the status matching each of the exceptions Connect throws,
+  //         KGRAPH_SUCCESS if the self loop was added.
+  KGraphStatus TryConnect(KeyType const& key, int i) {
+	  typename NodeMap::iterator found =
+		  nodes.find(key);
+	  if (found == nodes.end()) return KGRAPH_KEY_NOT_FOUND;
+	  if (i < 0 || i >= k) return KGRAPH_EDGE_OUT_OF_RANGE;
+	  Node& node = found->second;
+	  for (int j = 0; j < k; j++) {
+		  if (node[j] == &node) return KGRAPH_NODES_ALREADY_CONNECTED;
 	  }
-	  nodes.at(key)[i] = &nodes.at(key);
+	  if (node[i] != NULL) return KGRAPH_EDGE_ALREADY_IN_USE;
+	  node[i] = &node;
+	  return KGRAPH_SUCCESS;
   }
 
   // Disconnects two connected nodes.
@@ -448,23 +545,37 @@ template<typename KeyType, typename ValueType, int k> class KGraph {
   //        be found in the graph.
   // @throw kGraphNodesAreNotConnected if the two nodes are not connected.
   void Disconnect(KeyType const& key_u, KeyType const& key_v) {
-	  if (nodes.find(key_u) == nodes.end() ||
-		  nodes.find(key_v) == nodes.end()) {
-		  throw KGraphKeyNotFoundException();
+	  ThrowOnError(TryDisconnect(key_u, key_v));
+  }
+
+  // Non-throwing version of Disconnect.
+  //
+  // @return KGRAPH_KEY_NOT_FOUND if one of the keys is not in the graph,
+  //         KGRAPH_NODES_ARE_NOT_CONNECTED if the nodes are not connected,
+  //         KGRAPH_SUCCESS otherwise.
+  KGraphStatus TryDisconnect(KeyType const& key_u, KeyType const& key_v) {
+	  typename NodeMap::iterator u_it =
+		  nodes.find(key_u);
+	  typename NodeMap::iterator v_it =
+		  nodes.find(key_v);
+	  if (u_it == nodes.end() || v_it == nodes.end()) {
+		  return KGRAPH_KEY_NOT_FOUND;
 	  }
+	  Node& u = u_it->second;
+	  Node& v = v_it->second;
 	  for (int i_u = 0; i_u < k; i_u++) {
-		  if (nodes.at(key_u)[i_u] == &nodes.at(key_v)) {
+		  if (u[i_u] == &v) {
 			  for (int i_v = 0; i_v < k; i_v++) {
-				  if (nodes.at(key_v)[i_v] == &nodes.at(key_u)) {
-					  nodes.at(key_v)[i_v] = NULL;
-					  nodes.at(key_u)[i_u] = NULL;
-					  return;
+				  if (v[i_v] == &u) {
+					  v[i_v] = NULL;
+					  u[i_u] = NULL;
+					  return KGRAPH_SUCCESS;
 				  }
 			  }
 			  break;
 		  }
 	  }
-	  throw kGraphNodesAreNotConnected();
+	  return KGRAPH_NODES_ARE_NOT_CONNECTED;
   }
 };
 
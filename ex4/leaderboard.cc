@@ -0,0 +1,85 @@
+#include "leaderboard.h"
+
+using namespace mtm::pokemongo;
+
+bool Leaderboard::HigherFirst::operator()(const LeaderboardEntry & lhs,
+										  const LeaderboardEntry & rhs) const {
+	if (lhs.score != rhs.score) return lhs.score > rhs.score;
+	return lhs.name < rhs.name;
+}
+
+Leaderboard::Leaderboard() : mutex(), all(), teams(), entries(), trainers() {}
+
+Leaderboard::~Leaderboard() {
+	for (const std::pair<const std::string, Trainer*>& trainer : trainers) {
+		trainer.second->SetObserver(NULL);
+	}
+}
+
+void Leaderboard::Add(const std::string & name, Trainer & trainer) {
+	std::lock_guard<std::mutex> lock(mutex);
+	LeaderboardEntry entry = {name, trainer.GetTeam(), trainer.TotalScore()};
+	all.Insert(entry);
+	teams[entry.team].Insert(entry);
+	entries[&trainer] = entry;
+	trainers[name] = &trainer;
+	trainer.SetObserver(this);
+}
+
+bool Leaderboard::Remove(const std::string & name) {
+	std::lock_guard<std::mutex> lock(mutex);
+	std::unordered_map<std::string, Trainer*>::iterator trainer =
+		trainers.find(name);
+	if (trainer == trainers.end()) return false;
+	const LeaderboardEntry& entry = entries[trainer->second];
+	all.Erase(entry);
+	teams[entry.team].Erase(entry);
+	entries.erase(trainer->second);
+	trainer->second->SetObserver(NULL);
+	trainers.erase(trainer);
+	return true;
+}
+
+void Leaderboard::ScoreChanged(const Trainer & trainer, int) {
+	std::lock_guard<std::mutex> lock(mutex);
+	std::unordered_map<const Trainer*, LeaderboardEntry>::iterator entry =
+		entries.find(&trainer);
+	if (entry == entries.end()) return;
+	all.Erase(entry->second);
+	teams[entry->second.team].Erase(entry->second);
+	entry->second.score = trainer.TotalScore();
+	all.Insert(entry->second);
+	teams[entry->second.team].Insert(entry->second);
+}
+
+std::vector<LeaderboardEntry> Leaderboard::TopK(size_t k) const {
+	std::lock_guard<std::mutex> lock(mutex);
+	return all.First(k);
+}
+
+std::vector<LeaderboardEntry> Leaderboard::TopK(size_t k, Team team) const {
+	std::lock_guard<std::mutex> lock(mutex);
+	return teams[team].First(k);
+}
+
+size_t Leaderboard::RankOf(const std::string & name) const {
+	std::lock_guard<std::mutex> lock(mutex);
+	std::unordered_map<std::string, Trainer*>::const_iterator trainer =
+		trainers.find(name);
+	if (trainer == trainers.end()) return 0;
+	return all.Rank(entries.at(trainer->second)) + 1;
+}
+
+size_t Leaderboard::TeamRankOf(const std::string & name) const {
+	std::lock_guard<std::mutex> lock(mutex);
+	std::unordered_map<std::string, Trainer*>::const_iterator trainer =
+		trainers.find(name);
+	if (trainer == trainers.end()) return 0;
+	const LeaderboardEntry& entry = entries.at(trainer->second);
+	return teams[entry.team].Rank(entry) + 1;
+}
+
+size_t Leaderboard::Size() const {
+	std::lock_guard<std::mutex> lock(mutex);
+	return all.Size();
+}
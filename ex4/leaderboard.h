@@ -0,0 +1,102 @@
+#ifndef LEADERBOARD_H
+#define LEADERBOARD_H
+
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "rank_tree.h"
+#include "trainer.h"
+
+namespace mtm {
+namespace pokemongo {
+
+// A trainer's place on a leaderboard
+struct LeaderboardEntry {
+	std::string name;
+	Team team;
+	int score;
+};
+
+// Trainers ordered by their total score, overall and by team, kept up to
+// date as scores change. Trainers of equal score are ordered by name.
+//
+// Ranks are 1 for the best trainer. Finding a rank takes O(log n), and
+// listing the top k trainers takes O(log n + k).
+//
+// Score changes may arrive from several threads at once, so all functions
+// are thread safe.
+class Leaderboard : public TrainerObserver {
+public:
+	Leaderboard();
+
+	// Stops observing the trainers on the board.
+	~Leaderboard();
+
+	// Disable copy and assignment.
+	Leaderboard(const Leaderboard&) = delete;
+	Leaderboard& operator=(const Leaderboard&) = delete;
+
+	// Puts a trainer on the board, and observes its score from now on.
+	//
+	// @param name the name of the trainer, which is not on the board yet.
+	// @param trainer the trainer. Must outlive the board, or be removed
+	//		  first.
+	void Add(const std::string& name, Trainer& trainer);
+
+	// Takes a trainer off the board, and stops observing it.
+	//
+	// @param name the name of the trainer.
+	// @return false if the trainer wasn't on the board.
+	bool Remove(const std::string& name);
+
+	// Moves a trainer to its place by its new score.
+	void ScoreChanged(const Trainer& trainer, int old_score) override;
+
+	// Returns the best trainers, best first.
+	//
+	// @param k number of trainers to return, or less if there are fewer.
+	std::vector<LeaderboardEntry> TopK(size_t k) const;
+
+	// Returns the best trainers of a team, best first.
+	//
+	// @param k number of trainers to return, or less if there are fewer.
+	// @param team the team of the trainers.
+	std::vector<LeaderboardEntry> TopK(size_t k, Team team) const;
+
+	// Returns the rank of a trainer among all trainers.
+	//
+	// @param name the name of the trainer.
+	// @return the rank of the trainer, or 0 if it's not on the board.
+	size_t RankOf(const std::string& name) const;
+
+	// Returns the rank of a trainer among the trainers of its team.
+	//
+	// @param name the name of the trainer.
+	// @return the rank of the trainer, or 0 if it's not on the board.
+	size_t TeamRankOf(const std::string& name) const;
+
+	// Returns the number of trainers on the board.
+	size_t Size() const;
+
+private:
+	// Orders entries from the highest score to the lowest, then by name
+	struct HigherFirst {
+		bool operator()(const LeaderboardEntry& lhs,
+						const LeaderboardEntry& rhs) const;
+	};
+
+	mutable std::mutex mutex;
+	RankTree<LeaderboardEntry, HigherFirst> all;
+	RankTree<LeaderboardEntry, HigherFirst> teams[RED + 1];
+	// The current entry of every trainer on the board
+	std::unordered_map<const Trainer*, LeaderboardEntry> entries;
+	std::unordered_map<std::string, Trainer*> trainers;
+};
+
+}  // namespace pokemongo
+}  // namespace mtm
+
+#endif  // LEADERBOARD_H
@@ -0,0 +1,420 @@
+// Synthetic load for PokemonGo: builds a parameterised world and trainer
+// population, drives the game with a stream of moves and queries, and
+// reports throughput and latency percentiles per operation, and the peak
+// memory of the process. This is the benchmark to run before and after any
+// performance change.
+//
+// Usage: load_generator [--option=value ...]
+//
+//   --width=64 --height=64  size of the world's grid
+//   --torus                 wrap edges around (width and height must be at
+//                           least 3)
+//   --gyms=1 --pokestops=1 --starbucks=1
+//                           relative weights of the location types
+//   --items=8 --pokemons=8  items per Pokestop and Pokemons per Starbucks
+//   --trainers=10000        trainers added before the moves start
+//   --ops=1000000           operations after the trainers are added
+//   --zipf=1.0              skew of location popularity (0 is uniform)
+//   --random-moves=0.05     share of moves in a random direction, instead
+//                           of toward the trainer's destination
+//   --where-is=0.05 --trainers-in=0.05 --score=0.0001
+//                           share of each query among the operations
+//   --seed=1                seed of every random choice
+//   --journal=<path>        record the run to a journal (see
+//                           journal_replay)
+//   --stats=text|json       print the game's own metrics after the run
+//                           (and its memory by subsystem, as text)
+//
+// The same options and seed always produce the same operations.
+
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "journal.h"
+#include "pokemon_go.h"
+
+using namespace mtm::pokemongo;
+
+typedef enum {
+	OP_ADD_TRAINER,
+	OP_MOVE_TRAINER,
+	OP_WHERE_IS,
+	OP_TRAINERS_IN,
+	OP_SCORE,
+	OPS_NUM,
+} OperationType;
+
+static const char* OPERATION_NAMES[OPS_NUM] = {
+	"AddTrainer", "MoveTrainer", "WhereIs", "GetTrainersIn", "GetScore",
+};
+
+static const char* SPECIES[] = {
+	"pikachu", "squirtle", "charmander", "bulbasaur", "mew", "pidgey",
+	"psyduck", "eevee", "snorlax", "jigglypuff",
+};
+
+struct Options {
+	int width;
+	int height;
+	bool torus;
+	double gyms;
+	double pokestops;
+	double starbucks;
+	int items;
+	int pokemons;
+	int trainers;
+	long ops;
+	double zipf;
+	double random_moves;
+	double where_is;
+	double trainers_in;
+	double score;
+	unsigned long seed;
+	std::string journal;
+	std::string stats;
+};
+
+// Parses the command line.
+//
+// @return false if an option is unknown or invalid.
+static bool ParseOptions(int argc, char* argv[], Options* options) {
+	Options parsed = { 64, 64, false, 1, 1, 1, 8, 8, 10000, 1000000, 1.0,
+					   0.05, 0.05, 0.05, 0.0001, 1, "", "" };
+	for (int i = 1; i < argc; i++) {
+		std::string argument(argv[i]);
+		if (argument == "--torus") {
+			parsed.torus = true;
+			continue;
+		}
+		size_t equals = argument.find('=');
+		if (argument.compare(0, 2, "--") != 0 ||
+			equals == std::string::npos) {
+			return false;
+		}
+		std::string name = argument.substr(2, equals - 2);
+		std::string value = argument.substr(equals + 1);
+		const char* text = value.c_str();
+		if (name == "width") parsed.width = std::atoi(text);
+		else if (name == "height") parsed.height = std::atoi(text);
+		else if (name == "gyms") parsed.gyms = std::atof(text);
+		else if (name == "pokestops") parsed.pokestops = std::atof(text);
+		else if (name == "starbucks") parsed.starbucks = std::atof(text);
+		else if (name == "items") parsed.items = std::atoi(text);
+		else if (name == "pokemons") parsed.pokemons = std::atoi(text);
+		else if (name == "trainers") parsed.trainers = std::atoi(text);
+		else if (name == "ops") parsed.ops = std::atol(text);
+		else if (name == "zipf") parsed.zipf = std::atof(text);
+		else if (name == "random-moves") parsed.random_moves = std::atof(text);
+		else if (name == "where-is") parsed.where_is = std::atof(text);
+		else if (name == "trainers-in") parsed.trainers_in = std::atof(text);
+		else if (name == "score") parsed.score = std::atof(text);
+		else if (name == "seed") parsed.seed = std::strtoul(text, NULL, 10);
+		else if (name == "journal") parsed.journal = value;
+		else if (name == "stats") parsed.stats = value;
+		else return false;
+	}
+	int min_size = parsed.torus ? 3 : 1;
+	if (parsed.width < min_size || parsed.height < min_size ||
+		parsed.gyms < 0 || parsed.pokestops < 0 || parsed.starbucks < 0 ||
+		parsed.gyms + parsed.pokestops + parsed.starbucks <= 0 ||
+		parsed.items < 0 || parsed.pokemons < 0 || parsed.trainers < 1 ||
+		parsed.ops < 0 || parsed.zipf < 0 ||
+		parsed.where_is + parsed.trainers_in + parsed.score > 1 ||
+		(!parsed.stats.empty() && parsed.stats != "text" &&
+		 parsed.stats != "json")) {
+		return false;
+	}
+	*options = parsed;
+	return true;
+}
+
+// Draws ranks 0..n-1 with probability proportional to 1 / (rank + 1)^s
+class ZipfSampler {
+public:
+	ZipfSampler(size_t n, double s) : cdf(n) {
+		double sum = 0;
+		for (size_t rank = 0; rank < n; rank++) {
+			sum += 1 / std::pow((double)(rank + 1), s);
+			cdf[rank] = sum;
+		}
+		for (double& value : cdf) {
+			value /= sum;
+		}
+	}
+
+	size_t operator()(std::mt19937_64& random) const {
+		double value = std::uniform_real_distribution<double>(0, 1)(random);
+		size_t rank = std::lower_bound(cdf.begin(), cdf.end(), value) -
+			cdf.begin();
+		return std::min(rank, cdf.size() - 1);
+	}
+
+private:
+	std::vector<double> cdf;
+};
+
+static std::string LocationName(int row, int column) {
+	std::ostringstream name;
+	name << "loc_" << row << "_" << column;
+	return name.str();
+}
+
+// Creates the input line of a random location
+static std::string LocationLine(const Options& options, int row, int column,
+								std::mt19937_64& random) {
+	std::ostringstream line;
+	double kind = std::uniform_real_distribution<double>(0,
+		options.gyms + options.pokestops + options.starbucks)(random);
+	if (kind < options.gyms) {
+		line << "GYM " << LocationName(row, column);
+	} else if (kind < options.gyms + options.pokestops) {
+		line << "POKESTOP " << LocationName(row, column);
+		for (int i = 0; i < options.items; i++) {
+			line << (random() % 2 ? " CANDY " : " POTION ")
+				 << random() % 5 + 1;
+		}
+	} else {
+		line << "STARBUCKS " << LocationName(row, column);
+		for (int i = 0; i < options.pokemons; i++) {
+			line << " " << SPECIES[random() % 10] << " "
+				 << (double)(random() % 100 + 1) / 10 << " "
+				 << random() % 4 + 1;
+		}
+	}
+	return line.str();
+}
+
+static World* CreateWorld(const Options& options, std::mt19937_64& random,
+						  Journal* journal) {
+	World* world = new World();
+	for (int row = 0; row < options.height; row++) {
+		for (int column = 0; column < options.width; column++) {
+			std::string line = LocationLine(options, row, column, random);
+			std::istringstream line_stream(line);
+			line_stream >> *world;
+			if (journal != NULL) journal->RecordLocation(line);
+		}
+	}
+	for (int row = 0; row < options.height; row++) {
+		for (int column = 0; column < options.width; column++) {
+			std::string name = LocationName(row, column);
+			if (column + 1 < options.width || options.torus) {
+				std::string east = LocationName(row,
+												(column + 1) % options.width);
+				world->Connect(name, east, EAST, WEST);
+				if (journal != NULL) {
+					journal->RecordConnect(name, east, EAST, WEST);
+				}
+			}
+			if (row + 1 < options.height || options.torus) {
+				std::string south = LocationName((row + 1) % options.height,
+												 column);
+				world->Connect(name, south, SOUTH, NORTH);
+				if (journal != NULL) {
+					journal->RecordConnect(name, south, SOUTH, NORTH);
+				}
+			}
+		}
+	}
+	return world;
+}
+
+// Returns the direction of the first step from one position to another
+// along a row or column. On a torus, goes the short way around.
+static Direction StepToward(int from, int to, int size, bool torus,
+							Direction forward, Direction backward) {
+	int distance = to - from;
+	if (torus && std::abs(distance) * 2 > size) distance = -distance;
+	return distance > 0 ? forward : backward;
+}
+
+struct SimulatedTrainer {
+	std::string name;
+	int row;
+	int column;
+	int target_row;
+	int target_column;
+};
+
+// Latencies of one operation type, in nanoseconds
+struct LatencyLog {
+	std::vector<long long> samples;
+	long failures;
+
+	long long Percentile(double percentile) {
+		if (samples.empty()) return 0;
+		size_t index = (size_t)(percentile * (samples.size() - 1));
+		std::nth_element(samples.begin(), samples.begin() + index,
+						 samples.end());
+		return samples[index];
+	}
+};
+
+static long PeakMemoryKB() {
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+	// Reported in bytes on macOS
+	return usage.ru_maxrss / 1024;
+#else
+	return usage.ru_maxrss;
+#endif
+}
+
+int main(int argc, char* argv[]) {
+	Options options;
+	if (!ParseOptions(argc, argv, &options)) {
+		std::cerr << "Usage: " << argv[0] << " [--option=value ...]. See "
+				  << "load_generator.cc for the options." << std::endl;
+		return 2;
+	}
+	std::mt19937_64 random(options.seed);
+	Journal* journal = options.journal.empty() ? NULL :
+		new Journal(options.journal);
+
+	int locations_num = options.width * options.height;
+	// Popularity rank of every location, in random order
+	std::vector<int> popularity(locations_num);
+	for (int i = 0; i < locations_num; i++) popularity[i] = i;
+	std::shuffle(popularity.begin(), popularity.end(), random);
+	ZipfSampler zipf(locations_num, options.zipf);
+
+	PokemonGo game(CreateWorld(options, random, journal));
+	game.AttachJournal(journal);
+	std::vector<SimulatedTrainer> trainers(options.trainers);
+	std::vector<LatencyLog> logs(OPS_NUM);
+	for (LatencyLog& log : logs) log.failures = 0;
+	typedef std::chrono::steady_clock Clock;
+	Clock::time_point started = Clock::now();
+
+	for (int i = 0; i < options.trainers; i++) {
+		SimulatedTrainer& trainer = trainers[i];
+		std::ostringstream name;
+		name << "trainer_" << i;
+		trainer.name = name.str();
+		int start = popularity[zipf(random)];
+		trainer.row = trainer.target_row = start / options.width;
+		trainer.column = trainer.target_column = start % options.width;
+		Clock::time_point before = Clock::now();
+		PokemonGoStatus status = game.TryAddTrainer(trainer.name,
+			(Team)(random() % 3), LocationName(trainer.row, trainer.column));
+		logs[OP_ADD_TRAINER].samples.push_back(
+			std::chrono::duration_cast<std::chrono::nanoseconds>(
+				Clock::now() - before).count());
+		if (status != POKEMONGO_SUCCESS) logs[OP_ADD_TRAINER].failures++;
+	}
+
+	std::uniform_real_distribution<double> uniform(0, 1);
+	for (long op = 0; op < options.ops; op++) {
+		SimulatedTrainer& trainer = trainers[random() % trainers.size()];
+		double kind = uniform(random);
+		OperationType type = OP_MOVE_TRAINER;
+		PokemonGoStatus status = POKEMONGO_SUCCESS;
+		Clock::time_point before;
+		if (kind < options.where_is) {
+			type = OP_WHERE_IS;
+			std::string where;
+			before = Clock::now();
+			status = game.TryWhereIs(trainer.name, &where);
+		} else if (kind < options.where_is + options.trainers_in) {
+			type = OP_TRAINERS_IN;
+			int location = popularity[zipf(random)];
+			std::string name = LocationName(location / options.width,
+											location % options.width);
+			const std::vector<Trainer*>* found = NULL;
+			before = Clock::now();
+			status = game.TryGetTrainersIn(name, &found);
+		} else if (kind < options.where_is + options.trainers_in +
+				   options.score) {
+			type = OP_SCORE;
+			before = Clock::now();
+			game.GetScore((Team)(random() % 3));
+		} else {
+			if (trainer.row == trainer.target_row &&
+				trainer.column == trainer.target_column) {
+				int target = popularity[zipf(random)];
+				trainer.target_row = target / options.width;
+				trainer.target_column = target % options.width;
+			}
+			Direction dir;
+			if (uniform(random) < options.random_moves) {
+				dir = (Direction)(random() % 4);
+			} else if (trainer.column != trainer.target_column) {
+				dir = StepToward(trainer.column, trainer.target_column,
+								 options.width, options.torus, EAST, WEST);
+			} else if (trainer.row != trainer.target_row) {
+				dir = StepToward(trainer.row, trainer.target_row,
+								 options.height, options.torus, SOUTH, NORTH);
+			} else {
+				// Already there, look around
+				dir = (Direction)(random() % 4);
+			}
+			before = Clock::now();
+			status = game.TryMoveTrainer(trainer.name, dir);
+			if (status == POKEMONGO_SUCCESS) {
+				int row_step = dir == SOUTH ? 1 : dir == NORTH ? -1 : 0;
+				int column_step = dir == EAST ? 1 : dir == WEST ? -1 : 0;
+				trainer.row = (trainer.row + row_step + options.height) %
+					options.height;
+				trainer.column = (trainer.column + column_step +
+								  options.width) % options.width;
+			}
+		}
+		logs[type].samples.push_back(
+			std::chrono::duration_cast<std::chrono::nanoseconds>(
+				Clock::now() - before).count());
+		if (status != POKEMONGO_SUCCESS) logs[type].failures++;
+	}
+	double seconds = std::chrono::duration<double>(Clock::now() -
+												   started).count();
+	game.AttachJournal(NULL);
+	delete journal;
+
+	std::cout << "world: " << options.width << "x" << options.height
+			  << (options.torus ? " torus" : " grid") << ", "
+			  << options.trainers << " trainers, " << options.ops
+			  << " ops, zipf " << options.zipf << ", seed " << options.seed
+			  << std::endl;
+	std::cout << std::left << std::setw(15) << "operation"
+			  << std::right << std::setw(10) << "count"
+			  << std::setw(10) << "failed" << std::setw(12) << "ops/s"
+			  << std::setw(10) << "p50 ns" << std::setw(10) << "p99 ns"
+			  << std::setw(10) << "p999 ns" << std::endl;
+	long total = 0;
+	for (int type = 0; type < OPS_NUM; type++) {
+		LatencyLog& log = logs[type];
+		if (log.samples.empty()) continue;
+		total += log.samples.size();
+		long long busy = 0;
+		for (long long sample : log.samples) busy += sample;
+		std::cout << std::left << std::setw(15) << OPERATION_NAMES[type]
+				  << std::right << std::setw(10) << log.samples.size()
+				  << std::setw(10) << log.failures << std::setw(12)
+				  << (long)(busy > 0 ? log.samples.size() * 1e9 / busy : 0)
+				  << std::setw(10) << log.Percentile(0.5)
+				  << std::setw(10) << log.Percentile(0.99)
+				  << std::setw(10) << log.Percentile(0.999) << std::endl;
+	}
+	std::cout << "total: " << total << " ops in " << seconds << " s, "
+			  << (long)(total / seconds) << " ops/s" << std::endl;
+	std::cout << "peak memory: " << PeakMemoryKB() << " KB" << std::endl;
+	if (options.stats == "text") {
+		game.Stats().WriteText(std::cout);
+		game.MemoryStats().WriteText(std::cout);
+	} else if (options.stats == "json") {
+		game.Stats().WriteJson(std::cout);
+		std::cout << std::endl;
+	}
+	return 0;
+}
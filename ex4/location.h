@@ -5,37 +5,114 @@
 #include <vector>
 
 #include "exceptions.h"
+#include "memory_accounting.h"
+#include "status.h"
 #include "trainer.h"
 
 namespace mtm {
 namespace pokemongo {
 
-class Location {
+class Checkpoint;
+
+// Kinds of locations in the world.
+typedef enum {
+  LOCATION_GYM,
+  LOCATION_POKESTOP,
+  LOCATION_STARBUCKS,
+} LocationType;
+
+class Location : public HeapAccounted<MEMORY_LOCATIONS> {
  public:
   virtual ~Location() {};
-  virtual void Arrive(Trainer& trainer) {
+
+  // Returns the kind of the location.
+  virtual LocationType Type() const = 0;
+
+  // Adds a trainer to the location. Locations with special behaviour on
+  // arrival override this function, calling the base version first.
+  //
+  // @param trainer the trainer arriving.
+  // @return LOCATION_TRAINER_ALREADY_IN_LOCATION if the trainer is already in
+  //         the location, LOCATION_SUCCESS otherwise.
+  virtual LocationStatus TryArrive(Trainer& trainer) {
     if (std::find(trainers_.begin(), trainers_.end(), &trainer) !=
             trainers_.end()) {
-      throw LocationTrainerAlreadyInLocationException();
+      return LOCATION_TRAINER_ALREADY_IN_LOCATION;
     }
     trainers_.push_back(&trainer);
+    team_trainers_[trainer.GetTeam()].push_back(&trainer);
+    return LOCATION_SUCCESS;
   }
 
-  virtual void Leave(Trainer& trainer) {
+  // Removes a trainer from the location. Locations with special behaviour on
+  // departure override this function, calling the base version first.
+  //
+  // @param trainer the trainer leaving.
+  // @return LOCATION_TRAINER_NOT_FOUND if the trainer is not in the
+  //         location, LOCATION_SUCCESS otherwise.
+  virtual LocationStatus TryLeave(Trainer& trainer) {
     std::vector<Trainer*>::iterator position =
         std::find(trainers_.begin(), trainers_.end(), &trainer);
     if (position == trainers_.end()) {
-      throw LocationTrainerNotFoundException();
+      return LOCATION_TRAINER_NOT_FOUND;
     }
     trainers_.erase(position);
+    std::vector<Trainer*>& team_trainers = team_trainers_[trainer.GetTeam()];
+    team_trainers.erase(
+        std::find(team_trainers.begin(), team_trainers.end(), &trainer));
+    return LOCATION_SUCCESS;
+  }
+
+  // Throwing version of TryArrive. Not virtual: locations change what
+  // happens on arrival by overriding TryArrive, which this calls.
+  //
+  // @throw LocationTrainerAlreadyInLocationException if trainer is already
+  //        in the location.
+  void Arrive(Trainer& trainer) {
+    if (TryArrive(trainer) == LOCATION_TRAINER_ALREADY_IN_LOCATION) {
+      throw LocationTrainerAlreadyInLocationException();
+    }
+  }
+
+  // Throwing version of TryLeave. Not virtual: locations change what
+  // happens on departure by overriding TryLeave, which this calls.
+  //
+  // @throw LocationTrainerNotFoundException if trainer is not in the
+  //        location.
+  void Leave(Trainer& trainer) {
+    if (TryLeave(trainer) == LOCATION_TRAINER_NOT_FOUND) {
+      throw LocationTrainerNotFoundException();
+    }
   }
 
   const std::vector<Trainer*>& GetTrainers() {
     return trainers_;
   }
 
+  // Returns the trainers of a team in the location, by their order of
+  // arrival. The list is kept up to date, so it's never copied.
+  //
+  // @param team the team of the trainers.
+  const std::vector<Trainer*>& GetTrainers(Team team) const {
+    return team_trainers_[team];
+  }
+
+  // Returns the number of trainers of a team in the location, in constant
+  // time.
+  //
+  // @param team the team of the trainers.
+  size_t CountTrainers(Team team) const {
+    return team_trainers_[team].size();
+  }
+
  protected:
   std::vector<Trainer*> trainers_;
+
+  // The trainers of every team, each by their order of arrival
+  std::vector<Trainer*> team_trainers_[RED + 1];
+
+  // Saves and restores the arrival order of trainers
+  friend class Checkpoint;
 };
 
 }  // pokemongo
@@ -0,0 +1,229 @@
+#include "memory_accounting.h"
+
+#include <atomic>
+#include <cstring>
+#include <iomanip>
+#include <mutex>
+#include <vector>
+
+using namespace mtm::pokemongo;
+
+static const char* CATEGORY_NAMES[MEMORY_CATEGORIES_NUM] = {
+	"trainers", "pokemons", "items", "locations", "graph_nodes",
+};
+
+#ifndef POKEMONGO_NO_METRICS
+
+namespace {
+
+const size_t CACHE_LINE_SIZE = 64;
+
+// The counts every thread reported, of one category. Categories are on
+// separate cache lines, so threads reporting different categories don't
+// contend.
+struct SharedUsage {
+	std::atomic<long long> bytes;
+	std::atomic<long long> objects;
+	std::atomic<long long> peak_bytes;
+	char padding[CACHE_LINE_SIZE - 3 * sizeof(std::atomic<long long>)];
+
+	// Adds to the counts, and raises the peak if it was passed
+	void Report(long long reported_bytes, long long reported_objects);
+
+	// Raises the peak to a number of live bytes, if it's higher
+	void RaisePeak(long long live);
+};
+
+SharedUsage shared_usage[MEMORY_CATEGORIES_NUM];
+
+void SharedUsage::Report(long long reported_bytes,
+						 long long reported_objects) {
+	long long live = bytes.fetch_add(reported_bytes,
+									 std::memory_order_relaxed) +
+		reported_bytes;
+	objects.fetch_add(reported_objects, std::memory_order_relaxed);
+	RaisePeak(live);
+}
+
+void SharedUsage::RaisePeak(long long live) {
+	long long peak = peak_bytes.load(std::memory_order_relaxed);
+	while (live > peak &&
+		   !peak_bytes.compare_exchange_weak(peak, live,
+											 std::memory_order_relaxed)) {}
+}
+
+// The counts of a single thread not reported yet. Only the owning thread
+// writes them, so plain loads and stores are enough; they are atomic only
+// so snapshots can read them while the thread runs.
+struct ThreadUsage {
+	std::atomic<long long> bytes[MEMORY_CATEGORIES_NUM];
+	std::atomic<long long> objects[MEMORY_CATEGORIES_NUM];
+
+	ThreadUsage();
+	// Reports what's left
+	~ThreadUsage();
+
+	// Counts memory of a category, and reports the category's counts once
+	// they moved by MEMORY_REPORT_BYTES
+	void Count(MemoryCategory category, long long counted_bytes,
+			   long long counted_objects);
+
+	// Moves the counts of a category to the shared ones
+	void Report(int category);
+};
+
+// All live threads' counts
+struct Registry {
+	std::mutex mutex;
+	std::vector<const ThreadUsage*> threads;
+};
+
+Registry& GetRegistry() {
+	// Never destroyed, since threads may exit after static destructors run
+	static Registry* registry = new Registry();
+	return *registry;
+}
+
+// Set once the calling thread's counts are gone, so objects destroyed
+// after them are reported directly
+thread_local bool thread_usage_destroyed = false;
+
+ThreadUsage::ThreadUsage() {
+	for (int category = 0; category < MEMORY_CATEGORIES_NUM; category++) {
+		bytes[category].store(0, std::memory_order_relaxed);
+		objects[category].store(0, std::memory_order_relaxed);
+	}
+	Registry& registry = GetRegistry();
+	std::lock_guard<std::mutex> lock(registry.mutex);
+	registry.threads.push_back(this);
+}
+
+ThreadUsage::~ThreadUsage() {
+	Registry& registry = GetRegistry();
+	std::lock_guard<std::mutex> lock(registry.mutex);
+	for (int category = 0; category < MEMORY_CATEGORIES_NUM; category++) {
+		Report(category);
+	}
+	for (size_t i = 0; i < registry.threads.size(); i++) {
+		if (registry.threads[i] == this) {
+			registry.threads[i] = registry.threads.back();
+			registry.threads.pop_back();
+			break;
+		}
+	}
+	thread_usage_destroyed = true;
+}
+
+void ThreadUsage::Count(MemoryCategory category, long long counted_bytes,
+						long long counted_objects) {
+	long long unreported = bytes[category].load(std::memory_order_relaxed) +
+		counted_bytes;
+	bytes[category].store(unreported, std::memory_order_relaxed);
+	objects[category].store(
+		objects[category].load(std::memory_order_relaxed) + counted_objects,
+		std::memory_order_relaxed);
+	if (unreported >= MEMORY_REPORT_BYTES ||
+		unreported <= -MEMORY_REPORT_BYTES) {
+		Report(category);
+	}
+}
+
+void ThreadUsage::Report(int category) {
+	shared_usage[category].Report(
+		bytes[category].load(std::memory_order_relaxed),
+		objects[category].load(std::memory_order_relaxed));
+	bytes[category].store(0, std::memory_order_relaxed);
+	objects[category].store(0, std::memory_order_relaxed);
+}
+
+thread_local ThreadUsage thread_usage;
+
+// Counts memory in the calling thread's counts, or in the shared ones once
+// they're gone
+void Count(MemoryCategory category, long long bytes, long long objects) {
+	if (thread_usage_destroyed) {
+		shared_usage[category].Report(bytes, objects);
+	} else {
+		thread_usage.Count(category, bytes, objects);
+	}
+}
+
+}  // namespace
+
+void MemoryAccounting::Allocated(MemoryCategory category, size_t bytes,
+								 size_t objects) {
+	Count(category, (long long)bytes, (long long)objects);
+}
+
+void MemoryAccounting::Freed(MemoryCategory category, size_t bytes,
+							 size_t objects) {
+	Count(category, -(long long)bytes, -(long long)objects);
+}
+
+MemorySnapshot MemoryAccounting::Snapshot() {
+	MemorySnapshot snapshot;
+	Registry& registry = GetRegistry();
+	std::lock_guard<std::mutex> lock(registry.mutex);
+	for (int category = 0; category < MEMORY_CATEGORIES_NUM; category++) {
+		MemoryUsage& read = snapshot.categories[category];
+		SharedUsage& shared = shared_usage[category];
+		read.bytes = shared.bytes.load(std::memory_order_relaxed);
+		read.objects = shared.objects.load(std::memory_order_relaxed);
+		for (const ThreadUsage* thread : registry.threads) {
+			read.bytes += thread->bytes[category].load(
+				std::memory_order_relaxed);
+			read.objects += thread->objects[category].load(
+				std::memory_order_relaxed);
+		}
+		// The merged counts are a point the reports may have missed
+		shared.RaisePeak(read.bytes);
+		read.peak_bytes = shared.peak_bytes.load(std::memory_order_relaxed);
+	}
+	return snapshot;
+}
+
+#else
+
+void MemoryAccounting::Allocated(MemoryCategory, size_t, size_t) {}
+
+void MemoryAccounting::Freed(MemoryCategory, size_t, size_t) {}
+
+MemorySnapshot MemoryAccounting::Snapshot() {
+	MemorySnapshot snapshot;
+	std::memset(&snapshot, 0, sizeof(snapshot));
+	return snapshot;
+}
+
+#endif  // POKEMONGO_NO_METRICS
+
+const char* MemoryAccounting::Name(MemoryCategory category) {
+	return CATEGORY_NAMES[category];
+}
+
+MemoryUsage MemorySnapshot::Total() const {
+	MemoryUsage total = { 0, 0, 0 };
+	for (const MemoryUsage& category : categories) {
+		total.bytes += category.bytes;
+		total.objects += category.objects;
+		total.peak_bytes += category.peak_bytes;
+	}
+	return total;
+}
+
+// Prints a row of the memory table
+static void WriteRow(std::ostream & output, const char* name,
+					 const MemoryUsage & usage) {
+	output << std::left << std::setw(15) << name << std::right
+		   << std::setw(12) << usage.bytes << std::setw(12) << usage.objects
+		   << std::setw(12) << usage.peak_bytes << std::endl;
+}
+
+void MemorySnapshot::WriteText(std::ostream & output) const {
+	output << std::left << std::setw(15) << "memory" << std::right
+		   << std::setw(12) << "bytes" << std::setw(12) << "objects"
+		   << std::setw(12) << "peak bytes" << std::endl;
+	for (int category = 0; category < MEMORY_CATEGORIES_NUM; category++) {
+		WriteRow(output, CATEGORY_NAMES[category], categories[category]);
+	}
+	WriteRow(output, "total", Total());
+}
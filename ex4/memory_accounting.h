@@ -0,0 +1,162 @@
+#ifndef MEMORY_ACCOUNTING_H
+#define MEMORY_ACCOUNTING_H
+
+#include <cstddef>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <type_traits>
+
+namespace mtm {
+namespace pokemongo {
+
+// Accounting of the memory the game engine holds, by subsystem: live bytes,
+// live objects and the highest number of live bytes seen.
+//
+// Containers are accounted by their allocations, through CountingAllocator,
+// so an object is a single allocation (a node of a map, or a whole vector
+// buffer). Trainers are accounted per instance, wherever they live, and
+// locations per heap allocation. Accounting is process wide, and building
+// with -DPOKEMONGO_NO_METRICS compiles it out; snapshots are then always
+// empty.
+//
+// Like the metrics, every thread counts in its own unshared counters, which
+// snapshots merge, so threads allocating at once don't contend. A thread
+// reports its counts to shared ones once they moved by MEMORY_REPORT_BYTES,
+// and peaks are taken from the shared counts, so a peak may miss up to
+// MEMORY_REPORT_BYTES per running thread.
+
+// Bytes a thread takes or gives back before reporting them to the shared
+// counts
+static const long long MEMORY_REPORT_BYTES = 4096;
+
+typedef enum {
+	// Trainer objects
+	MEMORY_TRAINERS,
+	// Pokemons owned by trainers or waiting in Starbucks, and the index of
+	// trainers' Pokemons by strength
+	MEMORY_POKEMONS,
+	// Items owned by trainers or kept by Pokestops
+	MEMORY_ITEMS,
+	// Gym, Pokestop and Starbucks objects
+	MEMORY_LOCATIONS,
+	// Nodes of the world graph and of KGraph
+	MEMORY_GRAPH_NODES,
+	MEMORY_CATEGORIES_NUM,
+} MemoryCategory;
+
+// The memory held by one category.
+struct MemoryUsage {
+	long long bytes;
+	long long objects;
+	long long peak_bytes;
+};
+
+// The memory held by every category at some point in time.
+struct MemorySnapshot {
+	MemoryUsage categories[MEMORY_CATEGORIES_NUM];
+
+	// Returns the total of all categories. The peak of the total is the sum
+	// of the peaks, which may not have happened at the same time.
+	MemoryUsage Total() const;
+
+	// Prints a table of the categories and their total, one per line.
+	void WriteText(std::ostream& output) const;
+};
+
+class MemoryAccounting {
+public:
+	// Counts memory taken or given back by a category, in the calling
+	// thread's counters.
+	//
+	// @param category the category of the memory.
+	// @param bytes number of bytes.
+	// @param objects number of objects the bytes hold.
+	static void Allocated(MemoryCategory category, size_t bytes,
+						  size_t objects);
+	static void Freed(MemoryCategory category, size_t bytes, size_t objects);
+
+	// Reads the counts of all categories.
+	static MemorySnapshot Snapshot();
+
+	// Returns the name of a category, as printed in dumps.
+	static const char* Name(MemoryCategory category);
+};
+
+// A standard allocator which accounts everything it allocates to a
+// category. All counting allocators are equal, so containers using them move
+// and swap as cheaply as with std::allocator.
+template<typename T, MemoryCategory category> class CountingAllocator {
+public:
+	typedef T value_type;
+	typedef std::true_type propagate_on_container_move_assignment;
+
+	template<typename U> struct rebind {
+		typedef CountingAllocator<U, category> other;
+	};
+
+	CountingAllocator() {}
+
+	template<typename U>
+	CountingAllocator(const CountingAllocator<U, category>&) {}
+
+	T* allocate(size_t n) {
+		T* allocated = std::allocator<T>().allocate(n);
+		MemoryAccounting::Allocated(category, n * sizeof(T), 1);
+		return allocated;
+	}
+
+	void deallocate(T* allocated, size_t n) {
+		MemoryAccounting::Freed(category, n * sizeof(T), 1);
+		std::allocator<T>().deallocate(allocated, n);
+	}
+
+	template<typename U>
+	bool operator==(const CountingAllocator<U, category>&) const {
+		return true;
+	}
+	template<typename U>
+	bool operator!=(const CountingAllocator<U, category>&) const {
+		return false;
+	}
+};
+
+// A base class accounting every heap allocation of its subclasses to a
+// category, by the size of the allocated subclass. Subclasses must have a
+// virtual destructor if they're deleted through a base pointer.
+template<MemoryCategory category> class HeapAccounted {
+public:
+	static void* operator new(size_t size) {
+		void* allocated = ::operator new(size);
+		MemoryAccounting::Allocated(category, size, 1);
+		return allocated;
+	}
+
+	static void operator delete(void* allocated, size_t size) {
+		MemoryAccounting::Freed(category, size, 1);
+		::operator delete(allocated);
+	}
+};
+
+// A base class accounting every instance of Derived to a category, whether
+// it's on the heap, on the stack or inside a container.
+template<typename Derived, MemoryCategory category> class InstanceAccounted {
+public:
+	InstanceAccounted() {
+		MemoryAccounting::Allocated(category, sizeof(Derived), 1);
+	}
+	InstanceAccounted(const InstanceAccounted&) {
+		MemoryAccounting::Allocated(category, sizeof(Derived), 1);
+	}
+	InstanceAccounted& operator=(const InstanceAccounted&) {
+		return *this;
+	}
+	~InstanceAccounted() {
+		MemoryAccounting::Freed(category, sizeof(Derived), 1);
+	}
+};
+
+}  // namespace pokemongo
+}  // namespace mtm
+
+#endif  // MEMORY_ACCOUNTING_H
@@ -0,0 +1,228 @@
+#include "metrics.h"
+
+#include <atomic>
+#include <cstring>
+#include <iomanip>
+#include <mutex>
+#include <vector>
+
+using namespace mtm::pokemongo;
+
+static const char* COUNTER_NAMES[METRIC_COUNTERS_NUM] = {
+	"moves", "dead_ends", "gym_arrivals", "pokestop_arrivals",
+	"starbucks_arrivals", "battles", "leader_changes", "items_handed_out",
+	"pokemons_handed_out",
+};
+
+static const char* CALL_NAMES[METRIC_CALLS_NUM] = {
+	"AddTrainer", "MoveTrainer", "WhereIs", "GetTrainersIn", "GetScore",
+	"CountIn",
+};
+
+int LatencyHistogram::Bucket(unsigned long long nanoseconds) {
+	int log = 0;
+	while (nanoseconds >= 2 * LATENCY_SUB_BUCKETS) {
+		nanoseconds >>= 1;
+		log++;
+	}
+	return log * LATENCY_SUB_BUCKETS + (int)nanoseconds;
+}
+
+unsigned long long LatencyHistogram::BucketUpperBound(int bucket) {
+	if (bucket < 2 * LATENCY_SUB_BUCKETS) return bucket;
+	int log = bucket / LATENCY_SUB_BUCKETS - 1;
+	unsigned long long mantissa = LATENCY_SUB_BUCKETS +
+		bucket % LATENCY_SUB_BUCKETS;
+	return ((mantissa + 1) << log) - 1;
+}
+
+unsigned long long LatencyHistogram::Percentile(double percentile) const {
+	if (count == 0) return 0;
+	unsigned long long rank = (unsigned long long)(percentile * count);
+	if (rank >= count) rank = count - 1;
+	unsigned long long seen = 0;
+	for (int bucket = 0; bucket < LATENCY_BUCKETS_NUM; bucket++) {
+		seen += buckets[bucket];
+		if (seen > rank) return BucketUpperBound(bucket);
+	}
+	return BucketUpperBound(LATENCY_BUCKETS_NUM - 1);
+}
+
+const char* Metrics::Name(MetricCounter counter) {
+	return COUNTER_NAMES[counter];
+}
+
+const char* Metrics::Name(MetricCall call) {
+	return CALL_NAMES[call];
+}
+
+#ifndef POKEMONGO_NO_METRICS
+
+namespace {
+
+// The metrics of a single thread. Only the owning thread writes them, so
+// plain loads and stores are enough; they are atomic only so snapshots
+// can read them while the thread runs.
+struct ThreadMetrics {
+	std::atomic<unsigned long long> counters[METRIC_COUNTERS_NUM];
+	std::atomic<unsigned long long> buckets[METRIC_CALLS_NUM]
+										   [LATENCY_BUCKETS_NUM];
+	std::atomic<unsigned long long> total_nanoseconds[METRIC_CALLS_NUM];
+
+	ThreadMetrics();
+	~ThreadMetrics();
+
+	static void Add(std::atomic<unsigned long long>& value,
+					unsigned long long amount) {
+		value.store(value.load(std::memory_order_relaxed) + amount,
+					std::memory_order_relaxed);
+	}
+
+	// Adds this thread's metrics to a snapshot
+	void MergeInto(MetricsSnapshot& snapshot) const;
+};
+
+// All live threads' metrics, and the sum of the exited threads' metrics
+struct Registry {
+	std::mutex mutex;
+	std::vector<const ThreadMetrics*> threads;
+	MetricsSnapshot exited;
+
+	Registry() {
+		std::memset(&exited, 0, sizeof(exited));
+	}
+};
+
+Registry& GetRegistry() {
+	// Never destroyed, since threads may exit after static destructors run
+	static Registry* registry = new Registry();
+	return *registry;
+}
+
+ThreadMetrics::ThreadMetrics() {
+	for (std::atomic<unsigned long long>& counter : counters) {
+		counter.store(0, std::memory_order_relaxed);
+	}
+	for (int call = 0; call < METRIC_CALLS_NUM; call++) {
+		for (std::atomic<unsigned long long>& bucket : buckets[call]) {
+			bucket.store(0, std::memory_order_relaxed);
+		}
+		total_nanoseconds[call].store(0, std::memory_order_relaxed);
+	}
+	Registry& registry = GetRegistry();
+	std::lock_guard<std::mutex> lock(registry.mutex);
+	registry.threads.push_back(this);
+}
+
+ThreadMetrics::~ThreadMetrics() {
+	Registry& registry = GetRegistry();
+	std::lock_guard<std::mutex> lock(registry.mutex);
+	MergeInto(registry.exited);
+	for (size_t i = 0; i < registry.threads.size(); i++) {
+		if (registry.threads[i] == this) {
+			registry.threads[i] = registry.threads.back();
+			registry.threads.pop_back();
+			break;
+		}
+	}
+}
+
+void ThreadMetrics::MergeInto(MetricsSnapshot & snapshot) const {
+	for (int counter = 0; counter < METRIC_COUNTERS_NUM; counter++) {
+		snapshot.counters[counter] +=
+			counters[counter].load(std::memory_order_relaxed);
+	}
+	for (int call = 0; call < METRIC_CALLS_NUM; call++) {
+		LatencyHistogram& histogram = snapshot.calls[call];
+		for (int bucket = 0; bucket < LATENCY_BUCKETS_NUM; bucket++) {
+			unsigned long long value =
+				buckets[call][bucket].load(std::memory_order_relaxed);
+			histogram.buckets[bucket] += value;
+			histogram.count += value;
+		}
+		histogram.total_nanoseconds +=
+			total_nanoseconds[call].load(std::memory_order_relaxed);
+	}
+}
+
+thread_local ThreadMetrics thread_metrics;
+
+}  // namespace
+
+void Metrics::Count(MetricCounter counter, unsigned long long amount) {
+	ThreadMetrics::Add(thread_metrics.counters[counter], amount);
+}
+
+void Metrics::RecordLatency(MetricCall call, unsigned long long nanoseconds) {
+	ThreadMetrics::Add(
+		thread_metrics.buckets[call][LatencyHistogram::Bucket(nanoseconds)],
+		1);
+	ThreadMetrics::Add(thread_metrics.total_nanoseconds[call], nanoseconds);
+}
+
+MetricsSnapshot Metrics::Snapshot() {
+	// Make sure the registry exists, even if no thread counted anything
+	Registry& registry = GetRegistry();
+	std::lock_guard<std::mutex> lock(registry.mutex);
+	MetricsSnapshot snapshot = registry.exited;
+	for (const ThreadMetrics* thread : registry.threads) {
+		thread->MergeInto(snapshot);
+	}
+	return snapshot;
+}
+
+#else
+
+void Metrics::Count(MetricCounter, unsigned long long) {}
+
+void Metrics::RecordLatency(MetricCall, unsigned long long) {}
+
+MetricsSnapshot Metrics::Snapshot() {
+	MetricsSnapshot snapshot;
+	std::memset(&snapshot, 0, sizeof(snapshot));
+	return snapshot;
+}
+
+#endif  // POKEMONGO_NO_METRICS
+
+void MetricsSnapshot::WriteText(std::ostream & output) const {
+	for (int counter = 0; counter < METRIC_COUNTERS_NUM; counter++) {
+		output << COUNTER_NAMES[counter] << " " << counters[counter]
+			   << std::endl;
+	}
+	output << std::left << std::setw(15) << "call" << std::right
+		   << std::setw(12) << "count" << std::setw(12) << "mean ns"
+		   << std::setw(12) << "p50 ns" << std::setw(12) << "p99 ns"
+		   << std::setw(12) << "p999 ns" << std::endl;
+	for (int call = 0; call < METRIC_CALLS_NUM; call++) {
+		const LatencyHistogram& histogram = calls[call];
+		output << std::left << std::setw(15) << CALL_NAMES[call]
+			   << std::right << std::setw(12) << histogram.count
+			   << std::setw(12) << (histogram.count == 0 ? 0 :
+					histogram.total_nanoseconds / histogram.count)
+			   << std::setw(12) << histogram.Percentile(0.5)
+			   << std::setw(12) << histogram.Percentile(0.99)
+			   << std::setw(12) << histogram.Percentile(0.999) << std::endl;
+	}
+}
+
+void MetricsSnapshot::WriteJson(std::ostream & output) const {
+	output << "{\"counters\":{";
+	for (int counter = 0; counter < METRIC_COUNTERS_NUM; counter++) {
+		if (counter > 0) output << ",";
+		output << "\"" << COUNTER_NAMES[counter] << "\":" << counters[counter];
+	}
+	output << "},\"latency_ns\":{";
+	for (int call = 0; call < METRIC_CALLS_NUM; call++) {
+		const LatencyHistogram& histogram = calls[call];
+		if (call > 0) output << ",";
+		output << "\"" << CALL_NAMES[call] << "\":{\"count\":"
+			   << histogram.count << ",\"mean\":"
+			   << (histogram.count == 0 ? 0 :
+				   histogram.total_nanoseconds / histogram.count)
+			   << ",\"p50\":" << histogram.Percentile(0.5)
+			   << ",\"p99\":" << histogram.Percentile(0.99)
+			   << ",\"p999\":" << histogram.Percentile(0.999) << "}";
+	}
+	output << "}}";
+}
@@ -0,0 +1,143 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <chrono>
+#include <iostream>
+
+namespace mtm {
+namespace pokemongo {
+
+// Runtime metrics of the game engine: event counters and a latency
+// histogram for every API call.
+//
+// Metrics are process wide, since the events happen deep inside locations
+// and battles which don't know the game they belong to. Every thread counts
+// into its own buckets, with no locks and no shared cache lines, and the
+// buckets of all threads are merged only when a snapshot is taken.
+//
+// Building with -DPOKEMONGO_NO_METRICS compiles all the instrumentation out.
+// Snapshots are then always empty.
+
+typedef enum {
+	// Successful moves
+	METRIC_MOVES,
+	// Moves which failed with a dead end
+	METRIC_DEAD_ENDS,
+	// Arrivals of trainers, by location type
+	METRIC_GYM_ARRIVALS,
+	METRIC_POKESTOP_ARRIVALS,
+	METRIC_STARBUCKS_ARRIVALS,
+	// Calls of TrainersBattle
+	METRIC_BATTLES,
+	// Gyms which got a new leader, or lost their leader
+	METRIC_LEADER_CHANGES,
+	// Items given by Pokestops
+	METRIC_ITEMS_HANDED_OUT,
+	// Pokemons caught in Starbucks
+	METRIC_POKEMONS_HANDED_OUT,
+	METRIC_COUNTERS_NUM,
+} MetricCounter;
+
+typedef enum {
+	METRIC_CALL_ADD_TRAINER,
+	METRIC_CALL_MOVE_TRAINER,
+	METRIC_CALL_WHERE_IS,
+	METRIC_CALL_GET_TRAINERS_IN,
+	METRIC_CALL_GET_SCORE,
+	METRIC_CALL_COUNT_IN,
+	METRIC_CALLS_NUM,
+} MetricCall;
+
+// Latencies of values below 2 * LATENCY_SUB_BUCKETS nanoseconds are counted
+// exactly. Above that, every power of two is split into LATENCY_SUB_BUCKETS
+// buckets, so percentiles are accurate to within 25%.
+static const int LATENCY_SUB_BUCKETS = 4;
+static const int LATENCY_BUCKETS_NUM = 64 * LATENCY_SUB_BUCKETS;
+
+// A histogram of the latencies of one API call.
+struct LatencyHistogram {
+	unsigned long long buckets[LATENCY_BUCKETS_NUM];
+	unsigned long long count;
+	unsigned long long total_nanoseconds;
+
+	// Returns the latency below which the given share of the calls are.
+	//
+	// @param percentile share of the calls, between 0 and 1.
+	// @return the upper bound of the bucket holding the percentile, in
+	//		   nanoseconds, or 0 if there were no calls.
+	unsigned long long Percentile(double percentile) const;
+
+	// Returns the index of the bucket a latency is counted in.
+	static int Bucket(unsigned long long nanoseconds);
+
+	// Returns the highest latency counted in a bucket.
+	static unsigned long long BucketUpperBound(int bucket);
+};
+
+// The merged metrics of all threads at some point in time.
+struct MetricsSnapshot {
+	unsigned long long counters[METRIC_COUNTERS_NUM];
+	LatencyHistogram calls[METRIC_CALLS_NUM];
+
+	// Prints the metrics as lines of "<name> <value>", followed by a table
+	// of call latencies.
+	void WriteText(std::ostream& output) const;
+
+	// Prints the metrics as a single JSON object.
+	void WriteJson(std::ostream& output) const;
+};
+
+class Metrics {
+public:
+	// Adds to an event counter of the calling thread.
+	static void Count(MetricCounter counter, unsigned long long amount = 1);
+
+	// Counts a call's latency in the calling thread's histogram.
+	static void RecordLatency(MetricCall call,
+							  unsigned long long nanoseconds);
+
+	// Merges the metrics of all threads, including threads which already
+	// exited.
+	static MetricsSnapshot Snapshot();
+
+	// Returns the name of a counter or call, as printed in dumps.
+	static const char* Name(MetricCounter counter);
+	static const char* Name(MetricCall call);
+};
+
+// Records the latency of a call, from construction to destruction.
+class CallTimer {
+public:
+	explicit CallTimer(MetricCall call)
+		: call(call), start(std::chrono::steady_clock::now()) {}
+
+	~CallTimer() {
+		Metrics::RecordLatency(call,
+			std::chrono::duration_cast<std::chrono::nanoseconds>(
+				std::chrono::steady_clock::now() - start).count());
+	}
+
+	// Disable copy and assignment.
+	CallTimer(const CallTimer&) = delete;
+	CallTimer& operator=(const CallTimer&) = delete;
+
+private:
+	MetricCall call;
+	std::chrono::steady_clock::time_point start;
+};
+
+}  // namespace pokemongo
+}  // namespace mtm
+
+// Instrumentation points. Expand to nothing with POKEMONGO_NO_METRICS.
+#ifndef POKEMONGO_NO_METRICS
+#define METRICS_COUNT(counter) \
+	::mtm::pokemongo::Metrics::Count(counter)
+#define METRICS_TIME_CALL(call) \
+	::mtm::pokemongo::CallTimer metrics_call_timer(call)
+#else
+#define METRICS_COUNT(counter) do {} while (0)
+#define METRICS_TIME_CALL(call) do {} while (0)
+#endif
+
+#endif  // METRICS_H
@@ -0,0 +1,134 @@
+#include "movement_history.h"
+
+#include <algorithm>
+
+using namespace mtm::pokemongo;
+
+const size_t MovementHistory::CHECKPOINT_INTERVAL;
+const size_t MovementHistory::MOVES_PER_WORD;
+
+MovementHistory::MovementHistory(const std::string & start)
+	: start(start), moves(0), directions(), checkpoints(), jumps() {}
+
+void MovementHistory::Jump(const std::string & destination) {
+	JumpMove jump = { moves, destination };
+	jumps.push_back(jump);
+	// The jump takes a move's place in the directions, with any direction
+	Append(0, destination);
+}
+
+// Returns whether the move from location in dir goes over one of the edges
+static bool IsOver(const std::vector<MovementHistory::Edge>& edges,
+				   const std::string& location, Direction dir) {
+	for (const MovementHistory::Edge& edge : edges) {
+		if (edge.second == dir && edge.first == location) return true;
+	}
+	return false;
+}
+
+void MovementHistory::PinMoves(const World & world,
+							   const std::vector<Edge>& edges) {
+	std::vector<JumpMove> pinned;
+	std::string location = start;
+	std::vector<JumpMove>::const_iterator jump = jumps.begin();
+	for (size_t move = 0; move < moves; move++) {
+		std::string next;
+		if (jump != jumps.end() && jump->move == move) {
+			next = jump->destination;
+			++jump;
+		} else {
+			Direction dir = At(move);
+			if (world.TryNeighbor(location, dir, &next) != WORLD_SUCCESS) {
+				break;
+			}
+			if (IsOver(edges, location, dir)) {
+				JumpMove pin = { move, next };
+				pinned.push_back(pin);
+			}
+		}
+		if ((move + 1) % CHECKPOINT_INTERVAL == 0) {
+			next = checkpoints[move / CHECKPOINT_INTERVAL];
+		}
+		location.swap(next);
+	}
+	size_t jumps_num = jumps.size();
+	jumps.insert(jumps.end(), pinned.begin(), pinned.end());
+	std::inplace_merge(jumps.begin(), jumps.begin() + jumps_num, jumps.end(),
+					   [](const JumpMove& first, const JumpMove& second) {
+		return first.move < second.move;
+	});
+}
+
+size_t MovementHistory::Size() const {
+	return moves;
+}
+
+const std::string & MovementHistory::Start() const {
+	return start;
+}
+
+Direction MovementHistory::At(size_t move) const {
+	return (directions[move / MOVES_PER_WORD] >>
+			(2 * (move % MOVES_PER_WORD))) & 3;
+}
+
+bool MovementHistory::IsJump(size_t move) const {
+	std::vector<JumpMove>::const_iterator jump = FirstJumpFrom(move);
+	return jump != jumps.end() && jump->move == move;
+}
+
+std::vector<MovementHistory::JumpMove>::const_iterator
+MovementHistory::FirstJumpFrom(size_t move) const {
+	return std::lower_bound(jumps.begin(), jumps.end(), move,
+							[](const JumpMove& jump, size_t first) {
+		return jump.move < first;
+	});
+}
+
+WorldStatus MovementHistory::TryLocationAfter(const World & world,
+											  size_t moves_num,
+											  std::string * location) const {
+	size_t checkpoint = moves_num / CHECKPOINT_INTERVAL;
+	std::string reached = checkpoint == 0 ? start :
+		checkpoints[checkpoint - 1];
+	auto ignore = [](const std::string&) {};
+	WorldStatus status = WalkMoves(world, checkpoint * CHECKPOINT_INTERVAL,
+								   moves_num, &reached, ignore);
+	if (status == WORLD_SUCCESS) location->swap(reached);
+	return status;
+}
+
+WorldStatus MovementHistory::TryDecodePath(
+		const World & world, std::vector<std::string>* path) const {
+	std::vector<std::string> decoded;
+	decoded.reserve(moves + 1);
+	WorldStatus status = Walk(world, [&](const std::string& location) {
+		decoded.push_back(location);
+	});
+	if (status == WORLD_SUCCESS) path->swap(decoded);
+	return status;
+}
+
+WorldStatus MovementHistory::TryCountVisits(
+		const World & world,
+		std::unordered_map<std::string, size_t>* visits) const {
+	std::unordered_map<std::string, size_t> counted;
+	WorldStatus status = Walk(world, [&](const std::string& location) {
+		counted[location]++;
+	});
+	if (status == WORLD_SUCCESS) visits->swap(counted);
+	return status;
+}
+
+size_t MovementHistory::MemoryBytes() const {
+	size_t bytes = directions.capacity() * sizeof(uint64_t) +
+		checkpoints.capacity() * sizeof(std::string);
+	for (const std::string& checkpoint : checkpoints) {
+		bytes += checkpoint.capacity();
+	}
+	bytes += jumps.capacity() * sizeof(JumpMove);
+	for (const JumpMove& jump : jumps) {
+		bytes += jump.destination.capacity();
+	}
+	return bytes + start.capacity();
+}
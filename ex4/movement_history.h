@@ -0,0 +1,185 @@
+#ifndef MOVEMENT_HISTORY_H
+#define MOVEMENT_HISTORY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "status.h"
+#include "world.h"
+
+namespace mtm {
+namespace pokemongo {
+
+// The path of a trainer: the location it started at, followed by the
+// direction of every successful move. Since the world has 4 directions, a
+// move takes 2 bits, packed 32 to a word. Every CHECKPOINT_INTERVAL moves
+// the location reached is also kept by name, so a location in the middle of
+// the path can be found without walking from the start, and so a walk picks
+// up the right place again even if the world changed under it.
+//
+// A trainer may also be put somewhere with no move, when the world changes
+// under it. Such a jump takes the place of a move in the path, with its
+// destination kept by name.
+//
+// Decoding walks the directions through a World, which must have the
+// locations and edges the trainer moved through. Before an edge is removed
+// from the world, the moves over it are pinned: turned into jumps to the
+// location they reached (see PinMoves).
+class MovementHistory {
+public:
+	// Number of moves between two locations kept by name
+	static const size_t CHECKPOINT_INTERVAL = 256;
+
+	// An edge of the world, by the name of the location it leaves and its
+	// direction
+	typedef std::pair<std::string, Direction> Edge;
+
+	// Constructs an empty path.
+	//
+	// @param start the name of the location the path starts at.
+	explicit MovementHistory(const std::string& start);
+
+	// Adds a move to the end of the path.
+	//
+	// @param dir the direction of the move.
+	// @param destination the name of the location the move reached. Only
+	//		  kept on checkpoint moves.
+	void Append(Direction dir, const std::string& destination) {
+		size_t bit = 2 * (moves % MOVES_PER_WORD);
+		if (bit == 0) directions.push_back(0);
+		directions.back() |= (uint64_t)dir << bit;
+		if (++moves % CHECKPOINT_INTERVAL == 0) {
+			checkpoints.push_back(destination);
+		}
+	}
+
+	// Adds a jump to the end of the path.
+	//
+	// @param destination the name of the location the trainer was put at.
+	void Jump(const std::string& destination);
+
+	// Turns every move over one of the given edges into a jump, so that the
+	// path still decodes after the edges are removed from the world. Walks
+	// the whole path, up to the first move which can't be walked.
+	//
+	// @param world the world to walk through, still having the edges.
+	// @param edges the edges whose moves are pinned.
+	void PinMoves(const World& world, const std::vector<Edge>& edges);
+
+	// Returns the number of moves in the path, including jumps.
+	size_t Size() const;
+
+	// Returns the name of the location the path starts at.
+	const std::string& Start() const;
+
+	// Returns the direction of a move.
+	//
+	// @param move index of the move, smaller than Size(). Must not be a
+	//		  jump.
+	Direction At(size_t move) const;
+
+	// Returns whether a move is a jump.
+	//
+	// @param move index of the move, smaller than Size().
+	bool IsJump(size_t move) const;
+
+	// Walks the path through a world, calling visit with the name of every
+	// location on it: the start, then the location reached by every move.
+	//
+	// @param world the world to walk through.
+	// @param visit called with a const std::string& of every location.
+	// @return the status of the first move which couldn't be walked, or
+	//		   WORLD_SUCCESS.
+	template<typename Visit>
+	WorldStatus Walk(const World& world, Visit visit) const {
+		std::string location = start;
+		visit(location);
+		return WalkMoves(world, 0, moves, &location, visit);
+	}
+
+	// Finds the location reached after a number of moves, walking from the
+	// closest checkpoint before it.
+	//
+	// @param world the world to walk through.
+	// @param moves_num number of moves, at most Size().
+	// @param location set to the name of the location, on success.
+	// @return the status of the first move which couldn't be walked, or
+	//		   WORLD_SUCCESS.
+	WorldStatus TryLocationAfter(const World& world, size_t moves_num,
+								 std::string* location) const;
+
+	// Lists every location on the path, as Walk.
+	//
+	// @param world the world to walk through.
+	// @param path set to the names of the locations, on success.
+	// @return as Walk.
+	WorldStatus TryDecodePath(const World& world,
+							  std::vector<std::string>* path) const;
+
+	// Counts the visits of every location on the path, including the start.
+	//
+	// @param world the world to walk through.
+	// @param visits set to the number of visits by location name, on
+	//		  success.
+	// @return as Walk.
+	WorldStatus TryCountVisits(
+		const World& world,
+		std::unordered_map<std::string, size_t>* visits) const;
+
+	// Returns the number of bytes the path takes, not counting the object.
+	size_t MemoryBytes() const;
+
+private:
+	static const size_t MOVES_PER_WORD = 32;
+
+	// A move which put the trainer at a location
+	struct JumpMove {
+		size_t move;
+		std::string destination;
+	};
+
+	// Returns the first jump at move or after it
+	std::vector<JumpMove>::const_iterator FirstJumpFrom(size_t move) const;
+
+	// Walks moves [first, last), from the location reached before first,
+	// calling visit with every location reached
+	template<typename Visit>
+	WorldStatus WalkMoves(const World& world, size_t first, size_t last,
+						  std::string* location, Visit& visit) const {
+		std::vector<JumpMove>::const_iterator jump = FirstJumpFrom(first);
+		for (size_t move = first; move < last; move++) {
+			std::string next;
+			if (jump != jumps.end() && jump->move == move) {
+				next = jump->destination;
+				++jump;
+			} else {
+				WorldStatus status =
+					world.TryNeighbor(*location, At(move), &next);
+				if (status != WORLD_SUCCESS) return status;
+			}
+			if ((move + 1) % CHECKPOINT_INTERVAL == 0) {
+				next = checkpoints[move / CHECKPOINT_INTERVAL];
+			}
+			location->swap(next);
+			visit(*location);
+		}
+		return WORLD_SUCCESS;
+	}
+
+	std::string start;
+	size_t moves;
+	std::vector<uint64_t> directions;
+	// The location reached after every CHECKPOINT_INTERVAL moves
+	std::vector<std::string> checkpoints;
+	// Every jump, by the order of their moves
+	std::vector<JumpMove> jumps;
+};
+
+}  // namespace pokemongo
+}  // namespace mtm
+
+#endif  // MOVEMENT_HISTORY_H
@@ -0,0 +1,125 @@
+#ifndef MPSC_RING_H
+#define MPSC_RING_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+namespace mtm {
+namespace pokemongo {
+
+// A bounded FIFO queue from any number of producer threads to a single
+// consumer thread, with no locks. Nobody ever waits for anybody else: a push
+// to a full ring and a pop from an empty ring fail instead.
+//
+// Every slot has a sequence number telling whose turn it is: a producer
+// claims a position by advancing tail with a compare-and-swap, writes the
+// slot and publishes it with a release store of the sequence; the consumer
+// frees it by another release store. Elements are popped by the order their
+// positions were claimed, so the position returned by TryPush is the order
+// the consumer sees. A producer which claimed a position but hasn't written
+// it yet holds back the elements after it, and the ring looks empty to the
+// consumer meanwhile.
+//
+// Requirements: T default c'tor and move assignment.
+template<typename T> class MpscRing {
+public:
+	// Constructs an empty ring.
+	//
+	// @param capacity the number of elements the ring can hold, rounded up
+	//		  to a power of two.
+	explicit MpscRing(size_t capacity) : slots(), mask(0), head(0), tail(0) {
+		size_t size = 1;
+		while (size < capacity) size *= 2;
+		slots.reset(new Slot[size]);
+		for (size_t i = 0; i < size; i++) {
+			slots[i].sequence.store(i, std::memory_order_relaxed);
+		}
+		mask = size - 1;
+	}
+
+	// Disable copy and assignment.
+	MpscRing(const MpscRing&) = delete;
+	MpscRing& operator=(const MpscRing&) = delete;
+
+	// Adds an element to the back of the ring. Can be called from any
+	// thread.
+	//
+	// @param value the element to add. Moved from only on success.
+	// @param position if not NULL, set to the position of the element among
+	//		  all elements ever pushed, starting at 0, on success.
+	// @return false if the ring is full.
+	bool TryPush(T&& value, size_t* position = NULL) {
+		size_t current_tail = tail.load(std::memory_order_relaxed);
+		Slot* slot;
+		while (true) {
+			slot = &slots[current_tail & mask];
+			std::ptrdiff_t lag = (std::ptrdiff_t)
+				(slot->sequence.load(std::memory_order_acquire) -
+				 current_tail);
+			if (lag < 0) return false;
+			if (lag > 0) {
+				// Another producer took the position
+				current_tail = tail.load(std::memory_order_relaxed);
+			} else if (tail.compare_exchange_weak(
+						   current_tail, current_tail + 1,
+						   std::memory_order_relaxed)) {
+				break;
+			}
+		}
+		slot->value = std::move(value);
+		slot->sequence.store(current_tail + 1, std::memory_order_release);
+		if (position != NULL) *position = current_tail;
+		return true;
+	}
+
+	// Takes the element at the front of the ring. Called by the consumer
+	// only.
+	//
+	// @param value set to the element, on success.
+	// @return false if the ring is empty, or its front element isn't
+	//		   written yet.
+	bool TryPop(T* value) {
+		size_t current_head = head.load(std::memory_order_relaxed);
+		Slot& slot = slots[current_head & mask];
+		if (slot.sequence.load(std::memory_order_acquire) !=
+			current_head + 1) {
+			return false;
+		}
+		*value = std::move(slot.value);
+		slot.sequence.store(current_head + mask + 1,
+							std::memory_order_release);
+		head.store(current_head + 1, std::memory_order_relaxed);
+		return true;
+	}
+
+	// Returns the number of elements the ring can hold.
+	size_t Capacity() const {
+		return mask + 1;
+	}
+
+private:
+	static const size_t CACHE_LINE_SIZE = 64;
+
+	struct Slot {
+		// The position the slot waits to be pushed at, or one after the
+		// position it holds, once written
+		std::atomic<size_t> sequence;
+		T value;
+	};
+
+	std::unique_ptr<Slot[]> slots;
+	size_t mask;
+	// Position of the next element to pop, written by the consumer
+	std::atomic<size_t> head;
+	char head_padding[CACHE_LINE_SIZE - sizeof(std::atomic<size_t>)];
+	// Position of the next element to push, claimed by the producers
+	std::atomic<size_t> tail;
+	char tail_padding[CACHE_LINE_SIZE - sizeof(std::atomic<size_t>)];
+};
+
+}  // namespace pokemongo
+}  // namespace mtm
+
+#endif  // MPSC_RING_H
@@ -4,50 +4,65 @@
 using namespace mtm::pokemongo;
 
 #define MAX_POKEMON_HP		100
-#define STRING_TYPES	{"NORMAL", "ROCK", "BUG", "FAIRY", "GROUND", \
-						"GRASS", "WATER", "ICE", "GHOST", "POISON", \
-						"ELECTRIC", "FIRE", "FLYING", "PSYCHIC"}
 
 
 Pokemon::Pokemon(const std::string & species,
 				 const std::set<PokemonType>& types, const double & cp,
 				 const int & level)
-	: species(species), types(types), cp(cp), level(level), hp(MAX_POKEMON_HP) {
+	: hit_power(cp * level), cp(cp), hp(MAX_POKEMON_HP), level(level),
+	  species(0), types(0), types_sum(0) {
 	if (cp <= 0 || level <= 0 || species.size() == 0) {
 		throw PokemonInvalidArgsException();
 	}
+	for (const PokemonType& type : types) {
+		if (type < NORMAL || type > PSYCHIC) {
+			throw PokemonInvalidArgsException();
+		}
+		this->types |= 1 << type;
+		types_sum += type;
+	}
+	this->species = SpeciesRegistry::Intern(species);
 }
 
 Pokemon::Pokemon(const std::string & species, const double & cp,
 				 const int & level)
-	: Pokemon(species, GetDefaultTypes(species), cp, level) {}
+	: hit_power(cp * level), cp(cp), hp(MAX_POKEMON_HP), level(level),
+	  species(0), types(0), types_sum(0) {
+	if (cp <= 0 || level <= 0 || species.size() == 0) {
+		throw PokemonInvalidArgsException();
+	}
+	this->species = SpeciesRegistry::Intern(species);
+	// Resolved once per species, not once per Pokemon
+	const SpeciesRegistry::Types& default_types =
+		SpeciesRegistry::DefaultTypes(this->species);
+	types = default_types.mask;
+	types_sum = default_types.sum;
+}
 
+// A copy is a fresh Pokemon of the same kind, so it has full HP
 Pokemon::Pokemon(const Pokemon & pokemon)
-	: Pokemon(pokemon.species, pokemon.types, pokemon.cp, pokemon.level) {}
+	: hit_power(pokemon.hit_power), cp(pokemon.cp), hp(MAX_POKEMON_HP),
+	  level(pokemon.level), species(pokemon.species), types(pokemon.types),
+	  types_sum(pokemon.types_sum) {}
 
 Pokemon & mtm::pokemongo::Pokemon::operator=(const Pokemon & pokemon) {
-	types = pokemon.types;
-	species = pokemon.species;
+	hit_power = pokemon.hit_power;
 	cp = pokemon.cp;
-	level = pokemon.level;
 	hp = pokemon.hp;
+	level = pokemon.level;
+	species = pokemon.species;
+	types = pokemon.types;
+	types_sum = pokemon.types_sum;
 	return *this;
 }
 
 double Pokemon::HitPower() const {
-	return cp * level;
+	return hit_power;
 }
 
 double Pokemon::comparePokemon(const Pokemon& rhs) const {
-	if (HitPower() != rhs.HitPower()) return HitPower() - rhs.HitPower();
-	int lhs_types_sum = 0, rhs_types_sum = 0;
-	for (const PokemonType& lhs_type : types) {
-		lhs_types_sum += lhs_type;
-	}
-	for (const PokemonType& rhs_type : rhs.types) {
-		rhs_types_sum += rhs_type;
-	}
-	return lhs_types_sum - rhs_types_sum;
+	if (hit_power != rhs.hit_power) return hit_power - rhs.hit_power;
+	return (int)types_sum - (int)rhs.types_sum;
 }
 
 bool Pokemon::operator==(const Pokemon& rhs) const {
@@ -74,7 +89,7 @@ int Pokemon::Level() const {
 }
 
 bool Pokemon::Hit(Pokemon & victim) {
-	victim.hp -= HitPower();
+	victim.hp -= hit_power;
 	if (victim.hp <= 0) {
 		victim.hp = 0;
 		return true;
@@ -89,15 +104,17 @@ void Pokemon::Heal() {
 void Pokemon::Train(const double & boost) {
 	if (boost <= 1) throw PokemonInvalidArgsException();
 	cp *= boost;
+	hit_power = cp * level;
 }
 
 std::ostream & mtm::pokemongo::operator<<(std::ostream & output,
 										  const Pokemon & pokemon) {
-	std::string string_types[] = STRING_TYPES;
-	output << pokemon.species << "(" << pokemon.level << "/" << pokemon.cp \
-		   << "/" << pokemon.hp << ")";
-	for (const PokemonType& type : pokemon.types) {
-		output << " " << string_types[type];
+	output << SpeciesRegistry::Name(pokemon.species) << "(" << pokemon.level
+		   << "/" << pokemon.cp << "/" << pokemon.hp << ")";
+	for (int type = NORMAL; type <= PSYCHIC; type++) {
+		if (pokemon.types & (1 << type)) {
+			output << " " << POKEMON_TYPE_NAMES[type];
+		}
 	}
 	output << std::endl;
 	return output;
@@ -1,13 +1,20 @@
 #ifndef POKEMON_H
 #define POKEMON_H
 
+#include <cstdint>
 #include <iostream>
 #include <string>
 #include <set>
 
+#include "species.h"
+
 namespace mtm {
 namespace pokemongo {
 
+class Checkpoint;
+class PokemonBatch;
+class ReportWriter;
+
 // Possible Pokemon types.
 typedef enum {
   NORMAL = 0,
@@ -41,7 +48,8 @@ class Pokemon {
   // @param cp the CP value of the Pokemon.
   // @param level the level of the Pokemon.
   // @throw PokemonInvalidArgsException if a non-positive level or CP value were
-  //        passed, or if species is an empty string.
+  //        passed, if species is an empty string, or if a type is not one of
+  //        the PokemonType values.
   Pokemon(const std::string& species,
           const std::set<PokemonType>& types,
           const double& cp,
@@ -61,11 +69,17 @@ class Pokemon {
   //
   // @param pokemon the pokemon to copy.
   Pokemon(const Pokemon& pokemon);
+
+  // Move constructor. Unlike a copy, keeps the HP of the moved Pokemon.
+  //
+  // @param pokemon the pokemon to move.
+  Pokemon(Pokemon&& pokemon) = default;
   
   // Assignment operator.
   //
   // @param pokemon assignee.
   Pokemon& operator=(const Pokemon& pokemon);
+  Pokemon& operator=(Pokemon&& pokemon) = default;
 
   // Comparison operators for Pokemons. Pokemons are compared as described in
   // the exercise sheet.
@@ -114,14 +128,25 @@ class Pokemon {
   void Train(const double& boost);
 
 private:
-	std::string species;
-	std::set<PokemonType> types;
+	// Comparison keys, kept up to date: cp * level, then the sum of the types
+	double hit_power;
 	double cp;
-	int level;
 	double hp;
+	int level;
+	SpeciesRegistry::SpeciesId species;
+	// Bit t is set iff the Pokemon is of type t
+	uint16_t types;
+	uint16_t types_sum;
 
 	double comparePokemon(const Pokemon& rhs) const;
 	double HitPower() const;
+
+	// Saves and restores the complete state of Pokemons
+	friend class Checkpoint;
+	// Evaluates the stats of many Pokemons in bulk
+	friend class PokemonBatch;
+	// Formats Pokemons in bulk
+	friend class ReportWriter;
 };
 
 std::ostream& operator<<(std::ostream& output, const Pokemon& pokemon);
@@ -0,0 +1,167 @@
+#include "pokemon_batch.h"
+
+#if defined(__SSE2__) && !defined(POKEMON_BATCH_NO_SIMD)
+#define POKEMON_BATCH_SSE2
+#include <emmintrin.h>
+#endif
+
+using namespace mtm::pokemongo;
+
+namespace {
+
+// The kernels. Each SSE2 kernel handles pairs of Pokemons and leaves the
+// odd one to the scalar loop, which is also the whole of the fallback.
+
+void HitPowerKernel(const double* cp, const int32_t* level, double* result,
+					size_t count) {
+	size_t i = 0;
+#ifdef POKEMON_BATCH_SSE2
+	for (; i + 2 <= count; i += 2) {
+		__m128d levels = _mm_cvtepi32_pd(_mm_loadl_epi64(
+			reinterpret_cast<const __m128i*>(level + i)));
+		_mm_storeu_pd(result + i, _mm_mul_pd(_mm_loadu_pd(cp + i), levels));
+	}
+#endif
+	for (; i < count; i++) {
+		result[i] = cp[i] * level[i];
+	}
+}
+
+void CompareKernel(const double* lhs_power, const int32_t* lhs_types,
+				   const double* rhs_power, const int32_t* rhs_types,
+				   int8_t* result, size_t count) {
+	size_t i = 0;
+#ifdef POKEMON_BATCH_SSE2
+	for (; i + 2 <= count; i += 2) {
+		__m128d lhs = _mm_loadu_pd(lhs_power + i);
+		__m128d rhs = _mm_loadu_pd(rhs_power + i);
+		// Int32 values convert to doubles exactly
+		__m128d lhs_sum = _mm_cvtepi32_pd(_mm_loadl_epi64(
+			reinterpret_cast<const __m128i*>(lhs_types + i)));
+		__m128d rhs_sum = _mm_cvtepi32_pd(_mm_loadl_epi64(
+			reinterpret_cast<const __m128i*>(rhs_types + i)));
+		int greater = _mm_movemask_pd(_mm_cmpgt_pd(lhs, rhs));
+		int less = _mm_movemask_pd(_mm_cmplt_pd(lhs, rhs));
+		int sum_greater = _mm_movemask_pd(_mm_cmpgt_pd(lhs_sum, rhs_sum));
+		int sum_less = _mm_movemask_pd(_mm_cmplt_pd(lhs_sum, rhs_sum));
+		// Types break ties of the hit power only
+		int tie = ~(greater | less);
+		greater |= tie & sum_greater;
+		less |= tie & sum_less;
+		result[i] = (int8_t)((greater & 1) - (less & 1));
+		result[i + 1] = (int8_t)(((greater >> 1) & 1) - ((less >> 1) & 1));
+	}
+#endif
+	for (; i < count; i++) {
+		if (lhs_power[i] != rhs_power[i]) {
+			result[i] = lhs_power[i] > rhs_power[i] ? 1 : -1;
+		} else {
+			result[i] = lhs_types[i] > rhs_types[i] ? 1 :
+				(lhs_types[i] < rhs_types[i] ? -1 : 0);
+		}
+	}
+}
+
+void HitKernel(const double* power, double* hp, uint8_t* died,
+			   size_t count) {
+	size_t i = 0;
+#ifdef POKEMON_BATCH_SSE2
+	const __m128d zero = _mm_setzero_pd();
+	for (; i + 2 <= count; i += 2) {
+		__m128d left = _mm_sub_pd(_mm_loadu_pd(hp + i),
+								  _mm_loadu_pd(power + i));
+		__m128d dead = _mm_cmple_pd(left, zero);
+		// Dead Pokemons are left with exactly +0, as Pokemon::Hit does
+		_mm_storeu_pd(hp + i, _mm_andnot_pd(dead, left));
+		int dead_mask = _mm_movemask_pd(dead);
+		died[i] = (uint8_t)(dead_mask & 1);
+		died[i + 1] = (uint8_t)((dead_mask >> 1) & 1);
+	}
+#endif
+	for (; i < count; i++) {
+		hp[i] -= power[i];
+		died[i] = hp[i] <= 0;
+		if (died[i]) hp[i] = 0;
+	}
+}
+
+}  // namespace
+
+PokemonBatch::PokemonBatch()
+	: cp(), level(), hp(), types_sum(), hit_power() {}
+
+PokemonBatch::PokemonBatch(const std::vector<Pokemon>& pokemons)
+	: PokemonBatch() {
+	Reserve(pokemons.size());
+	// Gathered one Pokemon at a time, and then multiplied in bulk
+	for (const Pokemon& pokemon : pokemons) {
+		cp.push_back(pokemon.cp);
+		level.push_back(pokemon.level);
+		hp.push_back(pokemon.hp);
+		types_sum.push_back(pokemon.types_sum);
+	}
+	ComputeHitPowers(0);
+}
+
+bool PokemonBatch::Vectorized() {
+#ifdef POKEMON_BATCH_SSE2
+	return true;
+#else
+	return false;
+#endif
+}
+
+size_t PokemonBatch::Size() const {
+	return cp.size();
+}
+
+void PokemonBatch::Reserve(size_t capacity) {
+	cp.reserve(capacity);
+	level.reserve(capacity);
+	hp.reserve(capacity);
+	types_sum.reserve(capacity);
+	hit_power.reserve(capacity);
+}
+
+void PokemonBatch::Add(const Pokemon & pokemon) {
+	cp.push_back(pokemon.cp);
+	level.push_back(pokemon.level);
+	hp.push_back(pokemon.hp);
+	types_sum.push_back(pokemon.types_sum);
+	ComputeHitPowers(Size() - 1);
+}
+
+double PokemonBatch::Cp(size_t i) const {
+	return cp[i];
+}
+
+int PokemonBatch::Level(size_t i) const {
+	return level[i];
+}
+
+double PokemonBatch::Hp(size_t i) const {
+	return hp[i];
+}
+
+int PokemonBatch::TypesSum(size_t i) const {
+	return types_sum[i];
+}
+
+double PokemonBatch::HitPower(size_t i) const {
+	return hit_power[i];
+}
+
+void PokemonBatch::Compare(const PokemonBatch & rhs, int8_t * results) const {
+	CompareKernel(hit_power.data(), types_sum.data(), rhs.hit_power.data(),
+				  rhs.types_sum.data(), results, Size());
+}
+
+void PokemonBatch::Hit(PokemonBatch & victims, uint8_t * died) const {
+	HitKernel(hit_power.data(), victims.hp.data(), died, Size());
+}
+
+void PokemonBatch::ComputeHitPowers(size_t first) {
+	hit_power.resize(Size());
+	HitPowerKernel(cp.data() + first, level.data() + first,
+				   hit_power.data() + first, Size() - first);
+}
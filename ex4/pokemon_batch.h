@@ -0,0 +1,85 @@
+#ifndef POKEMON_BATCH_H
+#define POKEMON_BATCH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "pokemon.h"
+
+namespace mtm {
+namespace pokemongo {
+
+// The battle stats of many Pokemons, kept as one array per stat, so that
+// whole batches of matchups are evaluated by vectorized kernels instead of
+// one Pokemon at a time.
+//
+// The kernels use SSE2 when the compiler targets it, and a scalar loop
+// otherwise or with -DPOKEMON_BATCH_NO_SIMD. Both give results which are
+// bit-identical to the Pokemon member functions, for Pokemons whose stats
+// are finite.
+class PokemonBatch {
+public:
+	// Constructs an empty batch.
+	PokemonBatch();
+
+	// Constructs a batch of the stats of the given Pokemons, in order.
+	//
+	// @param pokemons the Pokemons to take the stats of.
+	explicit PokemonBatch(const std::vector<Pokemon>& pokemons);
+
+	// Returns whether the kernels were compiled with SIMD instructions.
+	static bool Vectorized();
+
+	// Returns the number of Pokemons in the batch.
+	size_t Size() const;
+
+	// Makes room for at least the given number of Pokemons.
+	void Reserve(size_t capacity);
+
+	// Adds the stats of a Pokemon at the end of the batch.
+	//
+	// @param pokemon the Pokemon to add.
+	void Add(const Pokemon& pokemon);
+
+	// Returns the stats of the i'th Pokemon in the batch.
+	double Cp(size_t i) const;
+	int Level(size_t i) const;
+	double Hp(size_t i) const;
+	int TypesSum(size_t i) const;
+	double HitPower(size_t i) const;
+
+	// Compares every Pokemon of this batch with the Pokemon in the same
+	// position of another batch, as the Pokemon comparison operators do.
+	//
+	// @param rhs the batch to compare with. Must be of the same size.
+	// @param results filled with Size() results: 1 where this batch's
+	//		  Pokemon is stronger, -1 where it's weaker and 0 where they're
+	//		  equal.
+	void Compare(const PokemonBatch& rhs, int8_t* results) const;
+
+	// Hits every Pokemon of another batch with the Pokemon in the same
+	// position of this batch, as Pokemon::Hit does.
+	//
+	// @param victims the batch to hit. Must be of the same size, and may be
+	//		  this batch.
+	// @param died filled with Size() results: 1 where the victim died, and
+	//		  0 otherwise.
+	void Hit(PokemonBatch& victims, uint8_t* died) const;
+
+private:
+	// Computes the hit powers of the Pokemons from the first given one on
+	void ComputeHitPowers(size_t first);
+
+	std::vector<double> cp;
+	std::vector<int32_t> level;
+	std::vector<double> hp;
+	std::vector<int32_t> types_sum;
+	// cp * level of every Pokemon, as Pokemon keeps it
+	std::vector<double> hit_power;
+};
+
+}  // namespace pokemongo
+}  // namespace mtm
+
+#endif  // POKEMON_BATCH_H
@@ -1,70 +1,411 @@
 #include "pokemon_go.h"
 
+#include <sstream>
+#include <tuple>
+#include <utility>
+
+#include "journal.h"
+#include "report_writer.h"
+
 using namespace mtm::pokemongo;
 
-PokemonGo::PokemonGo(const World * world) : world(world) {}
+// Arrival counter of every location type
+static const MetricCounter ARRIVAL_COUNTERS[] = {
+	METRIC_GYM_ARRIVALS, METRIC_POKESTOP_ARRIVALS, METRIC_STARBUCKS_ARRIVALS,
+};
+
+PokemonGo::PokemonGo(const World * world)
+	: world(world), journal(NULL), record_movements(false) {
+	// The game owns its world, so it may place its locations. Locations
+	// added later are placed when they're connected.
+	const_cast<World*>(world)->DeriveCoordinates();
+}
 
 PokemonGo::~PokemonGo() {
 	delete world;
 }
 
+void PokemonGo::PlaceTrainer(Trainer & trainer, const std::string & location) {
+	trainer.current_location_name = location;
+	Location* arrived = (*world)[location];
+	METRICS_COUNT(ARRIVAL_COUNTERS[arrived->Type()]);
+	arrived->Arrive(trainer);
+}
+
+void PokemonGo::RelocateTrainer(Trainer & trainer,
+								const std::string & destination) {
+	(*world)[trainer.current_location_name]->Leave(trainer);
+	METRICS_COUNT(METRIC_MOVES);
+	PlaceTrainer(trainer, destination);
+}
+
+void PokemonGo::ThrowOnError(PokemonGoStatus status) {
+	switch (status) {
+	case POKEMONGO_INVALID_ARGS:
+		throw PokemonGoInvalidArgsException();
+	case POKEMONGO_TRAINER_NAME_ALREADY_USED:
+		throw PokemonGoTrainerNameAlreadyUsedExcpetion();
+	case POKEMONGO_LOCATION_NOT_FOUND:
+		throw PokemonGoLocationNotFoundException();
+	case POKEMONGO_TRAINER_NOT_FOUND:
+		throw PokemonGoTrainerNotFoundExcpetion();
+	case POKEMONGO_REACHED_DEAD_END:
+		throw PokemonGoReachedDeadEndException();
+	case POKEMONGO_INVALID_DIRECTION:
+		throw KGraphEdgeOutOfRange();
+	default:
+		return;
+	}
+}
+
+void PokemonGo::ThrowOnError(WorldChangeStatus status) {
+	switch (status) {
+	case WORLD_CHANGE_INVALID_LINE:
+		throw WorldInvalidInputLineException();
+	case WORLD_CHANGE_LOCATION_NAME_ALREADY_USED:
+		throw WorldLocationNameAlreadyUsed();
+	case WORLD_CHANGE_LOCATION_NOT_FOUND:
+		throw PokemonGoLocationNotFoundException();
+	case WORLD_CHANGE_INVALID_FALLBACK:
+		throw PokemonGoInvalidArgsException();
+	case WORLD_CHANGE_INVALID_DIRECTION:
+		throw KGraphEdgeOutOfRange();
+	case WORLD_CHANGE_EDGE_ALREADY_IN_USE:
+		throw KGraphEdgeAlreadyInUse();
+	case WORLD_CHANGE_ALREADY_CONNECTED:
+		throw KGraphNodesAlreadyConnected();
+	case WORLD_CHANGE_NOT_CONNECTED:
+		throw kGraphNodesAreNotConnected();
+	default:
+		return;
+	}
+}
+
+PokemonGoStatus PokemonGo::ApplyAddTrainer(const std::string & name,
+										   const Team & team,
+										   const std::string & location) {
+	// Trainer's constructor throws for an empty name
+	if (name.empty()) return POKEMONGO_INVALID_ARGS;
+	if (trainers.find(name) != trainers.end()) {
+		return POKEMONGO_TRAINER_NAME_ALREADY_USED;
+	}
+	if (!world->Contains(location)) return POKEMONGO_LOCATION_NOT_FOUND;
+	Trainer& trainer = trainers.emplace(std::piecewise_construct,
+		std::forward_as_tuple(name), std::forward_as_tuple(name, team)).
+		first->second;
+	leaderboard.Add(name, trainer);
+	events.RecordArrival(location, (*world)[location], name);
+	PlaceTrainer(trainer, location);
+	if (record_movements) StartMovementHistory(name, trainer, location);
+	return POKEMONGO_SUCCESS;
+}
+
+PokemonGoStatus PokemonGo::TryAddTrainer(const std::string & name,
+										 const Team & team,
+										 const std::string & location) {
+	METRICS_TIME_CALL(METRIC_CALL_ADD_TRAINER);
+	PokemonGoStatus status = ApplyAddTrainer(name, team, location);
+	if (journal != NULL) {
+		journal->RecordAddTrainer(name, team, location, status);
+	}
+	return status;
+}
+
 void PokemonGo::AddTrainer(const std::string & name, const Team & team,
 						   const std::string & location) {
-	try {
-		Trainer trainer(name, team);
-		if (trainers.find(name) != trainers.end()) {
-			throw PokemonGoTrainerNameAlreadyUsedExcpetion();
-		}
-		if (!world->Contains(location)) {
-			throw PokemonGoLocationNotFoundException();
-		}
-		trainers.insert({ name, trainer });
-		trainers.at(name).current_location_name = location;
-		(*world)[location]->Arrive(trainers.at(name));
+	ThrowOnError(TryAddTrainer(name, team, location));
+}
+
+PokemonGoStatus PokemonGo::ApplyMoveTrainer(const std::string & trainer_name,
+											const Direction & dir) {
+	std::unordered_map<std::string, Trainer>::iterator found =
+		trainers.find(trainer_name);
+	if (found == trainers.end()) return POKEMONGO_TRAINER_NOT_FOUND;
+	Trainer& trainer = found->second;
+	std::string destination;
+	switch (world->TryNeighbor(trainer.current_location_name, dir,
+							   &destination)) {
+	case WORLD_INVALID_DIRECTION:
+		return POKEMONGO_INVALID_DIRECTION;
+	case WORLD_REACHED_DEAD_END:
+		METRICS_COUNT(METRIC_DEAD_ENDS);
+		return POKEMONGO_REACHED_DEAD_END;
+	default:
+		break;
 	}
-	catch (TrainerInvalidArgsException) {
-		throw PokemonGoInvalidArgsException();
+	events.RecordDeparture(trainer.current_location_name,
+						   (*world)[trainer.current_location_name],
+						   trainer_name);
+	events.RecordArrival(destination, (*world)[destination], trainer_name);
+	RelocateTrainer(trainer, destination);
+	if (trainer.movement_history != NULL) {
+		trainer.movement_history->Append(dir, destination);
 	}
+	return POKEMONGO_SUCCESS;
+}
+
+PokemonGoStatus PokemonGo::TryMoveTrainer(const std::string & trainer_name,
+										  const Direction & dir) {
+	METRICS_TIME_CALL(METRIC_CALL_MOVE_TRAINER);
+	PokemonGoStatus status = ApplyMoveTrainer(trainer_name, dir);
+	if (journal != NULL) {
+		journal->RecordMoveTrainer(trainer_name, dir, status);
+	}
+	return status;
 }
 
 void PokemonGo::MoveTrainer(const std::string & trainer_name,
 							const Direction & dir) {
-	try {
-		Trainer& trainer = trainers.at(trainer_name);
-		World::const_iterator it = \
-			world->BeginAt(trainer.current_location_name);
-		it.Move(dir);
-		if (it == world->End()) throw PokemonGoReachedDeadEndException();
-		(*world)[trainer.current_location_name]->Leave(trainer);
-		trainer.current_location_name = (*it);
-		(*world)[*it]->Arrive(trainer);
-	}
-	catch (std::out_of_range) {
-		throw PokemonGoTrainerNotFoundExcpetion();
-	}
+	ThrowOnError(TryMoveTrainer(trainer_name, dir));
+}
+
+PokemonGoStatus PokemonGo::TryWhereIs(const std::string & trainer_name,
+									  std::string * location) const {
+	METRICS_TIME_CALL(METRIC_CALL_WHERE_IS);
+	std::unordered_map<std::string, Trainer>::const_iterator found =
+		trainers.find(trainer_name);
+	if (found == trainers.end()) return POKEMONGO_TRAINER_NOT_FOUND;
+	*location = found->second.current_location_name;
+	return POKEMONGO_SUCCESS;
 }
 
 std::string PokemonGo::WhereIs(const std::string & trainer_name) {
-	try {
-		return trainers.at(trainer_name).current_location_name;
+	std::string location;
+	ThrowOnError(TryWhereIs(trainer_name, &location));
+	return location;
+}
+
+PokemonGoStatus PokemonGo::TryGetTrainersIn(
+		const std::string & location, const std::vector<Trainer*>** trainers) {
+	METRICS_TIME_CALL(METRIC_CALL_GET_TRAINERS_IN);
+	Location* found = NULL;
+	if (world->TryGetLocation(location, &found) != WORLD_SUCCESS) {
+		return POKEMONGO_LOCATION_NOT_FOUND;
 	}
-	catch (std::out_of_range) {
-		throw PokemonGoTrainerNotFoundExcpetion();
+	*trainers = &found->GetTrainers();
+	return POKEMONGO_SUCCESS;
+}
+
+PokemonGoStatus PokemonGo::TryGetTrainersIn(
+		const std::string & location, const Team & team,
+		const std::vector<Trainer*>** trainers) {
+	METRICS_TIME_CALL(METRIC_CALL_GET_TRAINERS_IN);
+	Location* found = NULL;
+	if (world->TryGetLocation(location, &found) != WORLD_SUCCESS) {
+		return POKEMONGO_LOCATION_NOT_FOUND;
 	}
+	*trainers = &found->GetTrainers(team);
+	return POKEMONGO_SUCCESS;
+}
+
+PokemonGoStatus PokemonGo::TryCountIn(const std::string & location,
+									  const Team & team, size_t * count) {
+	METRICS_TIME_CALL(METRIC_CALL_COUNT_IN);
+	Location* found = NULL;
+	if (world->TryGetLocation(location, &found) != WORLD_SUCCESS) {
+		return POKEMONGO_LOCATION_NOT_FOUND;
+	}
+	*count = found->CountTrainers(team);
+	return POKEMONGO_SUCCESS;
 }
 
 const std::vector<Trainer*>& PokemonGo::GetTrainersIn(
 												const std::string & location) {
-	try {
-		World::const_iterator it = world->BeginAt(location);
-		return (*world)[*it]->GetTrainers();
+	const std::vector<Trainer*>* trainers_in_location = NULL;
+	ThrowOnError(TryGetTrainersIn(location, &trainers_in_location));
+	return *trainers_in_location;
+}
+
+const std::vector<Trainer*>& PokemonGo::GetTrainersIn(
+		const std::string & location, const Team & team) {
+	const std::vector<Trainer*>* trainers_in_location = NULL;
+	ThrowOnError(TryGetTrainersIn(location, team, &trainers_in_location));
+	return *trainers_in_location;
+}
+
+size_t PokemonGo::CountIn(const std::string & location, const Team & team) {
+	size_t count = 0;
+	ThrowOnError(TryCountIn(location, team, &count));
+	return count;
+}
+
+PokemonGoStatus PokemonGo::TryApply(const GameCommand & command) {
+	if (command.type == ADD_TRAINER) {
+		return TryAddTrainer(command.trainer_name, command.team,
+							 command.location);
 	}
-	catch (KGraphKeyNotFoundException) {
-		throw PokemonGoLocationNotFoundException();
+	return TryMoveTrainer(command.trainer_name, command.direction);
+}
+
+// Returns the world change status matching a failed edge change
+static WorldChangeStatus EdgeChangeStatus(mtm::KGraphStatus status) {
+	switch (status) {
+	case mtm::KGRAPH_KEY_NOT_FOUND:
+		return WORLD_CHANGE_LOCATION_NOT_FOUND;
+	case mtm::KGRAPH_EDGE_OUT_OF_RANGE:
+		return WORLD_CHANGE_INVALID_DIRECTION;
+	case mtm::KGRAPH_EDGE_ALREADY_IN_USE:
+		return WORLD_CHANGE_EDGE_ALREADY_IN_USE;
+	case mtm::KGRAPH_NODES_ALREADY_CONNECTED:
+		return WORLD_CHANGE_ALREADY_CONNECTED;
+	case mtm::KGRAPH_NODES_ARE_NOT_CONNECTED:
+		return WORLD_CHANGE_NOT_CONNECTED;
+	default:
+		return WORLD_CHANGE_SUCCESS;
 	}
 }
 
+void PokemonGo::PinRecordedMoves(const std::string & location,
+								 const std::string * other) {
+	if (!record_movements) return;
+	std::vector<MovementHistory::Edge> edges;
+	for (Direction dir = NORTH; dir <= WEST; dir++) {
+		std::string neighbor;
+		if (world->TryNeighbor(location, dir, &neighbor) != WORLD_SUCCESS ||
+			(other != NULL && neighbor != *other)) {
+			continue;
+		}
+		edges.push_back(MovementHistory::Edge(location, dir));
+		if (neighbor == location) continue;
+		for (Direction back = NORTH; back <= WEST; back++) {
+			std::string reached;
+			if (world->TryNeighbor(neighbor, back, &reached) == WORLD_SUCCESS &&
+				reached == location) {
+				edges.push_back(MovementHistory::Edge(neighbor, back));
+			}
+		}
+	}
+	if (edges.empty()) return;
+	std::unordered_map<std::string, MovementHistory>::iterator it;
+	for (it = movement_histories.begin(); it != movement_histories.end();
+		 it++) {
+		it->second.PinMoves(*world, edges);
+	}
+}
+
+WorldChangeStatus PokemonGo::RemoveLocation(const std::string & location,
+											const std::string & fallback) {
+	Location* removed = NULL;
+	Location* fallback_location = NULL;
+	if (world->TryGetLocation(location, &removed) != WORLD_SUCCESS ||
+		world->TryGetLocation(fallback, &fallback_location) != WORLD_SUCCESS) {
+		return WORLD_CHANGE_LOCATION_NOT_FOUND;
+	}
+	if (location == fallback) return WORLD_CHANGE_INVALID_FALLBACK;
+	PinRecordedMoves(location, NULL);
+	// Copied, since leaving changes the location's list
+	std::vector<Trainer*> leaving = removed->GetTrainers();
+	for (Trainer* trainer : leaving) {
+		const std::string& name = trainer->GetName();
+		events.RecordDeparture(location, removed, name);
+		events.RecordArrival(fallback, fallback_location, name);
+		removed->Leave(*trainer);
+		PlaceTrainer(*trainer, fallback);
+		if (trainer->movement_history != NULL) {
+			trainer->movement_history->Jump(fallback);
+		}
+	}
+	events.RecordRemoval(removed);
+	// The game owns its world, so it may change it
+	const_cast<World*>(world)->Remove(location);
+	return WORLD_CHANGE_SUCCESS;
+}
+
+WorldChangeStatus PokemonGo::ApplyWorldChange(const WorldChange & change) {
+	World& changed = *const_cast<World*>(world);
+	switch (change.type) {
+	case ADD_LOCATION: {
+		std::istringstream line(change.line);
+		try {
+			line >> changed;
+		} catch (WorldInvalidInputLineException) {
+			return WORLD_CHANGE_INVALID_LINE;
+		} catch (WorldLocationNameAlreadyUsed) {
+			return WORLD_CHANGE_LOCATION_NAME_ALREADY_USED;
+		}
+		return WORLD_CHANGE_SUCCESS;
+	}
+	case REMOVE_LOCATION:
+		return RemoveLocation(change.location, change.other);
+	case CONNECT_LOCATIONS:
+		return EdgeChangeStatus(changed.TryConnect(
+			change.location, change.other, change.direction,
+			change.other_direction));
+	default:
+		PinRecordedMoves(change.location, &change.other);
+		return EdgeChangeStatus(changed.TryDisconnect(change.location,
+													  change.other));
+	}
+}
+
+WorldChangeStatus PokemonGo::TryApplyWorldChange(const WorldChange & change) {
+	WorldChangeStatus status = ApplyWorldChange(change);
+	if (journal != NULL) journal->RecordWorldChange(change, status);
+	return status;
+}
+
+WorldChangeStatus PokemonGo::TryApplyWorldDiff(
+		const std::vector<WorldChange> & diff, size_t * applied) {
+	size_t applied_num = 0;
+	WorldChangeStatus status = WORLD_CHANGE_SUCCESS;
+	for (const WorldChange& change : diff) {
+		status = TryApplyWorldChange(change);
+		if (status != WORLD_CHANGE_SUCCESS) break;
+		applied_num++;
+	}
+	if (applied != NULL) *applied = applied_num;
+	return status;
+}
+
+void PokemonGo::ApplyWorldDiff(std::istream & input) {
+	ThrowOnError(TryApplyWorldDiff(ReadWorldDiff(input), NULL));
+}
+
+void PokemonGo::AttachJournal(Journal * journal) {
+	this->journal = journal;
+}
+
+void PokemonGo::Subscribe(Subscription * subscription) {
+	events.Add(subscription);
+}
+
+void PokemonGo::Unsubscribe(Subscription * subscription) {
+	events.Remove(subscription);
+}
+
+void PokemonGo::PublishEvents() {
+	events.Publish();
+}
+
+void PokemonGo::StartMovementHistory(const std::string & name,
+									 Trainer & trainer,
+									 const std::string & start) {
+	trainer.movement_history = &movement_histories.emplace(
+		name, MovementHistory(start)).first->second;
+}
+
+void PokemonGo::RecordMovements() {
+	if (record_movements) return;
+	record_movements = true;
+	std::unordered_map<std::string, Trainer>::iterator it;
+	for (it = trainers.begin(); it != trainers.end(); it++) {
+		StartMovementHistory(it->first, it->second,
+							 it->second.current_location_name);
+	}
+}
+
+PokemonGoStatus PokemonGo::TryGetMovementHistory(
+		const std::string & trainer_name,
+		const MovementHistory** history) const {
+	std::unordered_map<std::string, Trainer>::const_iterator found =
+		trainers.find(trainer_name);
+	if (found == trainers.end()) return POKEMONGO_TRAINER_NOT_FOUND;
+	*history = found->second.movement_history;
+	return POKEMONGO_SUCCESS;
+}
+
 int PokemonGo::GetScore(const Team & team) {
+	METRICS_TIME_CALL(METRIC_CALL_GET_SCORE);
 	int score = 0;
 	std::unordered_map<std::string, Trainer>::iterator it;
 	for (it = trainers.begin(); it != trainers.end(); it++) {
@@ -76,3 +417,41 @@ int PokemonGo::GetScore(const Team & team) {
 	return score;
 }
 
+MetricsSnapshot PokemonGo::Stats() const {
+	return Metrics::Snapshot();
+}
+
+MemorySnapshot PokemonGo::MemoryStats() const {
+	return MemoryAccounting::Snapshot();
+}
+
+void PokemonGo::DumpAll(int fd) const {
+	ReportWriter writer(fd);
+	for (const std::string& name : world->LocationNames()) {
+		Location* location = NULL;
+		world->TryGetLocation(name, &location);
+		writer.AddLocation(name, location->GetTrainers());
+	}
+	writer.Flush();
+}
+
+std::vector<LeaderboardEntry> PokemonGo::GetTopTrainers(size_t k) const {
+	return leaderboard.TopK(k);
+}
+
+std::vector<LeaderboardEntry> PokemonGo::GetTopTrainers(
+		size_t k, const Team & team) const {
+	return leaderboard.TopK(k, team);
+}
+
+size_t PokemonGo::GetRank(const std::string & trainer_name) const {
+	size_t rank = leaderboard.RankOf(trainer_name);
+	if (rank == 0) throw PokemonGoTrainerNotFoundExcpetion();
+	return rank;
+}
+
+size_t PokemonGo::GetTeamRank(const std::string & trainer_name) const {
+	size_t rank = leaderboard.TeamRankOf(trainer_name);
+	if (rank == 0) throw PokemonGoTrainerNotFoundExcpetion();
+	return rank;
+}
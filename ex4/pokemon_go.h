@@ -5,21 +5,107 @@
 #include <vector>
 #include <unordered_map>
 
+#include "command.h"
+#include "leaderboard.h"
+#include "memory_accounting.h"
+#include "metrics.h"
+#include "movement_history.h"
 #include "world.h"
+#include "world_diff.h"
 #include "trainer.h"
+#include "status.h"
+#include "subscription.h"
 
 namespace mtm {
 namespace pokemongo {
 
+class Checkpoint;
+class Journal;
+class TickExecutor;
+
 class PokemonGo {
 protected:
 	std::unordered_map<std::string, Trainer> trainers;
 	const World* world;
+	// Where applied commands are recorded, or NULL
+	Journal* journal;
+
+	// All of the trainers, by score. Declared after the trainers, so that
+	// it's destroyed first.
+	Leaderboard leaderboard;
+
+	// Arrivals, departures and leader changes for the subscriptions
+	EventHub events;
+
+	// Whether the moves of trainers are recorded, and the path of every
+	// trainer if they are
+	bool record_movements;
+	std::unordered_map<std::string, MovementHistory> movement_histories;
+
+	// Starts recording the path of a trainer.
+	//
+	// @param name the name of the trainer.
+	// @param trainer the trainer.
+	// @param start name of the location the path starts at.
+	void StartMovementHistory(const std::string& name, Trainer& trainer,
+							  const std::string& start);
+
+	// Puts a trainer which is in no location in the given location.
+	//
+	// @param trainer the trainer to place.
+	// @param location name of an existing location.
+	void PlaceTrainer(Trainer& trainer, const std::string& location);
+
+	// Moves a trainer from their current location to another location.
+	//
+	// @param trainer the trainer to move.
+	// @param destination name of an existing location.
+	void RelocateTrainer(Trainer& trainer, const std::string& destination);
+
+	// Apply the commands of TryAddTrainer and TryMoveTrainer, without
+	// recording them in the journal.
+	PokemonGoStatus ApplyAddTrainer(
+		const std::string& name, const Team& team, const std::string& location);
+	PokemonGoStatus ApplyMoveTrainer(
+		const std::string& trainer_name, const Direction& dir);
+
+	// Applies the change of TryApplyWorldChange, without recording it in the
+	// journal.
+	WorldChangeStatus ApplyWorldChange(const WorldChange& change);
+
+	// Pins the recorded moves over the edges between a location and its
+	// neighbors, before the edges are removed (see MovementHistory::PinMoves).
+	//
+	// @param location name of the location.
+	// @param other name of the only neighbor whose edges are pinned, or NULL
+	//		  to pin the edges to all of the neighbors.
+	void PinRecordedMoves(const std::string& location,
+						  const std::string* other);
+
+	// Removes a location from the world, moving its trainers to fallback.
+	//
+	// @param location name of the location to remove.
+	// @param fallback name of the location to move the trainers to.
+	// @return as TryApplyWorldChange.
+	WorldChangeStatus RemoveLocation(const std::string& location,
+									 const std::string& fallback);
+
+	// Throws the exception matching a failed status. Does nothing on success.
+	//
+	// @param status result of one of the Try functions.
+	static void ThrowOnError(PokemonGoStatus status);
+	static void ThrowOnError(WorldChangeStatus status);
+
+	// Applies commands straight on the game's trainers and locations
+	friend class TickExecutor;
+	// Saves and restores the complete state of the game
+	friend class Checkpoint;
 
  public:
   // Initilaizes a new game with the given world. This passes ownership of
   // world, meaning the constructed PokemonGo is responsible for deleting all
-  // memory allocated by world.
+  // memory allocated by world. Locations of the world which have no
+  // coordinates are placed (see World::DeriveCoordinates).
   //
   // @param world the world in which the game takes place.
   PokemonGo(const World* world);
@@ -73,11 +159,198 @@ protected:
   //        not exist.
   const std::vector<Trainer*>& GetTrainersIn(const std::string& location);
 
+  // Returns the trainers of a team that are found in the specified location,
+  // by their last arrival time, as GetTrainersIn. The list is kept by the
+  // location, so nothing is copied or filtered.
+  //
+  // @param location the name of the location.
+  // @param team the team of the trainers.
+  // @return the trainers of team found in the given location.
+  // @throw PokemonGoLocationNotFoundException if the specified location does
+  //        not exist.
+  const std::vector<Trainer*>& GetTrainersIn(const std::string& location,
+                                             const Team& team);
+
+  // Returns the number of trainers of a team in the specified location. Takes
+  // constant time in the number of trainers.
+  //
+  // @param location the name of the location.
+  // @param team the team of the trainers.
+  // @return the number of trainers of team in the location.
+  // @throw PokemonGoLocationNotFoundException if the specified location does
+  //        not exist.
+  size_t CountIn(const std::string& location, const Team& team);
+
+  // Non-throwing versions of the functions above, for callers where failures
+  // are routine. Each returns the status matching the exception the throwing
+  // version would throw, or POKEMONGO_SUCCESS. Outputs are set only on
+  // success.
+  //
+  // TryMoveTrainer returns POKEMONGO_INVALID_DIRECTION for a direction which
+  // is not one of the four directions.
+  PokemonGoStatus TryAddTrainer(
+      const std::string& name, const Team& team, const std::string& location);
+  PokemonGoStatus TryMoveTrainer(
+      const std::string& trainer_name, const Direction& dir);
+  PokemonGoStatus TryWhereIs(
+      const std::string& trainer_name, std::string* location) const;
+  PokemonGoStatus TryGetTrainersIn(const std::string& location,
+                                   const std::vector<Trainer*>** trainers);
+  PokemonGoStatus TryGetTrainersIn(const std::string& location,
+                                   const Team& team,
+                                   const std::vector<Trainer*>** trainers);
+  PokemonGoStatus TryCountIn(const std::string& location, const Team& team,
+                             size_t* count);
+
+  // Applies a game command, as TryAddTrainer or TryMoveTrainer.
+  //
+  // @param command the command to apply.
+  // @return the status of the matching Try function.
+  PokemonGoStatus TryApply(const GameCommand& command);
+
+  // Changes the world of the running game, without rebuilding it. Only the
+  // locations named by the change, and the trainers in a removed location,
+  // are touched. Must not be called while a TickExecutor runs a tick.
+  //
+  // Trainers in a removed location are moved to the fallback location by
+  // their arrival order, arriving there as if they moved to it, and their
+  // recorded paths jump to the fallback. Locations added have no
+  // coordinates until they're connected to a placed location (see
+  // World::TryConnect).
+  //
+  // When movements are recorded, removing a location or disconnecting two
+  // also walks every recorded path, pinning the moves over the removed
+  // edges, so that the paths still decode through the changed world (see
+  // MovementHistory::PinMoves).
+  //
+  // @param change the change to apply.
+  // @return WORLD_CHANGE_INVALID_LINE if an added location's line is
+  //         invalid, WORLD_CHANGE_LOCATION_NAME_ALREADY_USED if it's taken,
+  //         WORLD_CHANGE_LOCATION_NOT_FOUND if a named location doesn't
+  //         exist, WORLD_CHANGE_INVALID_FALLBACK if a location is removed
+  //         with itself as the fallback, the status matching KGraph's
+  //         exception if an edge can't be connected or disconnected, and
+  //         WORLD_CHANGE_SUCCESS otherwise.
+  WorldChangeStatus TryApplyWorldChange(const WorldChange& change);
+
+  // Applies the changes of a diff in order, stopping at the first one
+  // which fails. Changes applied before it are kept.
+  //
+  // @param diff the changes to apply.
+  // @param applied if not NULL, set to the number of changes applied.
+  // @return the status of the failed change, or WORLD_CHANGE_SUCCESS.
+  WorldChangeStatus TryApplyWorldDiff(const std::vector<WorldChange>& diff,
+                                      size_t* applied);
+
+  // Reads a world diff (see ReadWorldDiff) and applies it, as
+  // TryApplyWorldDiff. Nothing is applied if the diff can't be read.
+  //
+  // @param input the stream to read the diff from.
+  // @throw WorldInvalidInputLineException if a line can't be read or an
+  //        added location's line is invalid.
+  // @throw WorldLocationNameAlreadyUsed if an added location's name is
+  //        taken.
+  // @throw PokemonGoLocationNotFoundException if a named location doesn't
+  //        exist.
+  // @throw PokemonGoInvalidArgsException if a location is removed with
+  //        itself as the fallback.
+  // @throw a KGraph exception if an edge can't be connected or
+  //        disconnected.
+  void ApplyWorldDiff(std::istream& input);
+
+  // Records every command and world change applied from now on, and its
+  // result, in the given journal. The world is not recorded; whoever builds
+  // the world records its locations and edges before attaching the journal.
+  //
+  // @param journal the journal to record to, or NULL to stop recording. The
+  //        game doesn't take ownership of it.
+  void AttachJournal(Journal* journal);
+
+  // Delivers the game's events to a subscription from now on: arrivals,
+  // departures and gym leader changes, coalesced into a batch per tick. A
+  // tick ends whenever PublishEvents is called, which TickExecutor does at
+  // the end of every tick. Restoring a checkpoint makes no events.
+  //
+  // @param subscription the subscription. The game doesn't take ownership of
+  //        it, and it must be unsubscribed before it's destroyed.
+  void Subscribe(Subscription* subscription);
+
+  // Stops delivering events to a subscription. Events of the current tick
+  // are not delivered to it.
+  //
+  // @param subscription the subscription.
+  void Unsubscribe(Subscription* subscription);
+
+  // Ends the current tick: delivers the events since the last call to the
+  // subscriptions which want them. Never waits for subscribers.
+  void PublishEvents();
+
+  // Records the successful moves of every trainer from now on, each as a
+  // MovementHistory starting at the trainer's location when recording
+  // started or when it was added. A move costs 2 bits. Restoring a
+  // checkpoint doesn't restore the recording.
+  void RecordMovements();
+
+  // Returns the recorded path of a trainer.
+  //
+  // @param trainer_name the name of the trainer.
+  // @param history set to the path of the trainer, or to NULL if moves are
+  //        not recorded, on success.
+  // @return POKEMONGO_TRAINER_NOT_FOUND if there exists no trainer with the
+  //         given name in the game, POKEMONGO_SUCCESS otherwise.
+  PokemonGoStatus TryGetMovementHistory(const std::string& trainer_name,
+                                        const MovementHistory** history) const;
+
   // Returns the score of a given team in the game.
   //
   // @param team
   // @return the score of team.
   int GetScore(const Team& team);
+
+  // Returns the engine's metrics: event counters and API call latencies.
+  // Metrics are process wide, so they include every game in the process.
+  // Empty when built with POKEMONGO_NO_METRICS.
+  MetricsSnapshot Stats() const;
+
+  // Returns the memory held by the engine, by subsystem: live bytes, live
+  // objects and the most bytes held so far. Accounting is process wide, like
+  // the metrics, and also empty when built with POKEMONGO_NO_METRICS.
+  MemorySnapshot MemoryStats() const;
+
+  // Returns the trainers with the highest total scores, highest first.
+  // Trainers of equal score are ordered by name. Takes O(log n + k) time.
+  //
+  // @param k number of trainers to return, or less if there are fewer.
+  // @return the top trainers.
+  std::vector<LeaderboardEntry> GetTopTrainers(size_t k) const;
+
+  // Returns the trainers of a team with the highest total scores, as
+  // GetTopTrainers.
+  //
+  // @param k number of trainers to return, or less if there are fewer.
+  // @param team the team of the trainers.
+  // @return the top trainers of the team.
+  std::vector<LeaderboardEntry> GetTopTrainers(size_t k,
+                                               const Team& team) const;
+
+  // Returns the rank of a trainer by total score, where 1 is the best,
+  // among all trainers or among the trainers of its team. Takes O(log n)
+  // time.
+  //
+  // @param trainer_name the name of the trainer.
+  // @return the rank of the trainer.
+  // @throw PokemonGoTrainerNotFoundExcpetion in there exists no trainer with
+  //        the given name in the game.
+  size_t GetRank(const std::string& trainer_name) const;
+  size_t GetTeamRank(const std::string& trainer_name) const;
+
+  // Writes every location in the game, sorted by name, and the trainers in
+  // it by their arrival order, in the format of ReportWriter::AddLocation.
+  // The whole report is written at once.
+  //
+  // @param fd the file descriptor to write to.
+  // @throw ReportWriteFailedException if writing failed.
+  void DumpAll(int fd) const;
 };
 
 }  // namespace pokemongo
@@ -1,33 +1,45 @@
 #include "pokestop.h"
 
-using namespace mtm::pokemongo;
+#include "metrics.h"
 
-Pokestop::~Pokestop() {
-	std::vector<Item*>::iterator current_item;
-	// Destroy all items
-	for (current_item = items.begin(); current_item != items.end();
-		 current_item++) {
-		delete *current_item;
-	}
-}
+using namespace mtm::pokemongo;
 
-void Pokestop::Arrive(Trainer& trainer) {
+LocationStatus Pokestop::TryArrive(Trainer& trainer) {
 	// Call the parent's arrive function
-	this->Location::Arrive(trainer);
+	LocationStatus status = this->Location::TryArrive(trainer);
+	if (status != LOCATION_SUCCESS) return status;
 
-	std::vector<Item*>::iterator current_item;
 	// Find the first item the new trainer can take and give it to them
-	for (current_item = items.begin(); current_item != items.end();
-		 current_item++) {
-		if (trainer.AddItem(*current_item)) {
-			items.erase(current_item);
-			break;
-		}
+	long position = levels.FindFirst(trainer.Level());
+	if (position == FirstFitIndex::NOT_FOUND) return LOCATION_SUCCESS;
+	trainer.AddItem(items[position]);
+	METRICS_COUNT(METRIC_ITEMS_HANDED_OUT);
+	levels.Remove(position);
+	if (levels.Size() == 0) {
+		// Start over, instead of keeping the given items around
+		items.clear();
+		levels.Clear();
 	}
+	return LOCATION_SUCCESS;
 }
 
 void Pokestop::AddItem(Item* item) {
 	if (NULL == item) throw PokestopInvalidItemException();
 
+	AddItem(item->Value());
+	delete item;
+}
+
+void Pokestop::AddItem(const ItemValue & item) {
 	items.push_back(item);
+	levels.Add(item.Level());
+}
+
+std::vector<ItemValue> Pokestop::ItemsLeft() const {
+	std::vector<ItemValue> left;
+	left.reserve(levels.Size());
+	for (size_t position = 0; position < items.size(); position++) {
+		if (levels.Contains(position)) left.push_back(items[position]);
+	}
+	return left;
 }
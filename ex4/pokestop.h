@@ -1,6 +1,7 @@
 #ifndef POKESTOP_H
 #define POKESTOP_H
 #include "location.h"
+#include "first_fit_index.h"
 #include "item.h"
 #include "trainer.h"
 
@@ -10,18 +11,34 @@ class Pokestop: public Location {
 public:
 	// Constructs an empty Pokestop
 	Pokestop() : Location() {};
-	// Destructor. Destroys all items in the Pokestop as well.
-	~Pokestop();
+	~Pokestop() {}
+	LocationType Type() const override {
+		return LOCATION_POKESTOP;
+	}
 	// Adds a trainer to the Pokestop, and gives them the first item
-	// they can carry from the items list
-	// @throws LocationTrainerAlreadyInLocationException if trainer is already
+	// they can carry from the items list. Takes logarithmic time in the
+	// number of items.
+	// @return LOCATION_TRAINER_ALREADY_IN_LOCATION if trainer is already
 	//         in the Pokestop.
-	void Arrive(Trainer& trainer) override;
-	// Adds an item to the pokestop.
+	LocationStatus TryArrive(Trainer& trainer) override;
+	// Adds an item to the pokestop. The pokestop keeps the item's value
+	// and destroys the item object.
 	// @throws PokestopInvalidItemException if null arg is passed
 	void AddItem(Item* item);
+	void AddItem(const ItemValue& item);
 private:
-	std::vector<Item*> items;
+	// All items added, in the order they were added. Items given away stay
+	// in place, and are only removed from the index.
+	std::vector<ItemValue, CountingAllocator<ItemValue, MEMORY_ITEMS> > items;
+
+	// Levels of the items left, by their position in items
+	FirstFitIndex levels;
+
+	// Returns the items left, in the order they were added
+	std::vector<ItemValue> ItemsLeft() const;
+
+	// Saves and restores the items left
+	friend class Checkpoint;
 };
 } // pokemongo
 } // mtm
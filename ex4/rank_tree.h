@@ -0,0 +1,207 @@
+#ifndef RANK_TREE_H
+#define RANK_TREE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace mtm {
+namespace pokemongo {
+
+// An ordered set which also answers order statistics: the rank of a key,
+// and the first k keys. Implemented as a treap whose nodes count the size
+// of their subtree, so inserting, erasing and ranking take expected
+// O(log n) time, and listing the first k keys takes O(log n + k).
+//
+// Node priorities come from a fixed seed, so the shape of the tree, and
+// with it the running time, is the same on every run.
+//
+// Requirements: Key copy c'tor, Compare is a strict weak order.
+template<typename Key, typename Compare = std::less<Key> >
+class RankTree {
+public:
+	// Constructs an empty tree.
+	RankTree() : root(NULL), random_state(0x9e3779b97f4a7c15ULL) {}
+
+	~RankTree() {
+		Delete(root);
+	}
+
+	// Disable copy and assignment.
+	RankTree(const RankTree&) = delete;
+	RankTree& operator=(const RankTree&) = delete;
+
+	// Returns the number of keys in the tree.
+	size_t Size() const {
+		return SizeOf(root);
+	}
+
+	// Adds a key which is not in the tree yet.
+	//
+	// @param key the key to add.
+	void Insert(const Key& key) {
+		Node* left = NULL;
+		Node* right = NULL;
+		Split(root, key, &left, &right);
+		root = Merge(Merge(left, new Node(key, NextPriority())), right);
+	}
+
+	// Removes a key from the tree.
+	//
+	// @param key the key to remove.
+	// @return false if the key wasn't in the tree.
+	bool Erase(const Key& key) {
+		Node** link = &root;
+		while (*link != NULL) {
+			Node* node = *link;
+			if (less(key, node->key)) {
+				link = &node->left;
+			} else if (less(node->key, key)) {
+				link = &node->right;
+			} else {
+				*link = Merge(node->left, node->right);
+				delete node;
+				// The sizes on the path down are one too big now
+				FixSizes(&root, key);
+				return true;
+			}
+		}
+		return false;
+	}
+
+	// Returns the number of keys before a key, which may be in the tree or
+	// not.
+	//
+	// @param key the key to rank.
+	// @return the number of keys in the tree which are smaller than key.
+	size_t Rank(const Key& key) const {
+		size_t rank = 0;
+		for (const Node* node = root; node != NULL;) {
+			if (less(node->key, key)) {
+				rank += SizeOf(node->left) + 1;
+				node = node->right;
+			} else {
+				node = node->left;
+			}
+		}
+		return rank;
+	}
+
+	// Returns the first keys in the tree, in order.
+	//
+	// @param k the number of keys to return. All of the keys are returned
+	//		  if there are fewer.
+	std::vector<Key> First(size_t k) const {
+		std::vector<Key> keys;
+		keys.reserve(k < Size() ? k : Size());
+		// In-order walk with an explicit stack, stopping after k keys
+		std::vector<const Node*> path;
+		const Node* node = root;
+		while (keys.size() < k && (node != NULL || !path.empty())) {
+			if (node != NULL) {
+				path.push_back(node);
+				node = node->left;
+			} else {
+				node = path.back();
+				path.pop_back();
+				keys.push_back(node->key);
+				node = node->right;
+			}
+		}
+		return keys;
+	}
+
+private:
+	struct Node {
+		Key key;
+		uint64_t priority;
+		size_t size;
+		Node* left;
+		Node* right;
+
+		Node(const Key& key, uint64_t priority)
+			: key(key), priority(priority), size(1), left(NULL),
+			  right(NULL) {}
+	};
+
+	static size_t SizeOf(const Node* node) {
+		return node == NULL ? 0 : node->size;
+	}
+
+	static void Update(Node* node) {
+		node->size = SizeOf(node->left) + SizeOf(node->right) + 1;
+	}
+
+	static void Delete(Node* node) {
+		if (node == NULL) return;
+		Delete(node->left);
+		Delete(node->right);
+		delete node;
+	}
+
+	// Xorshift64, enough to keep the treap balanced
+	uint64_t NextPriority() {
+		random_state ^= random_state << 13;
+		random_state ^= random_state >> 7;
+		random_state ^= random_state << 17;
+		return random_state;
+	}
+
+	// Splits a subtree to the keys smaller than key, and the rest
+	void Split(Node* node, const Key& key, Node** left, Node** right) {
+		if (node == NULL) {
+			*left = NULL;
+			*right = NULL;
+		} else if (less(node->key, key)) {
+			Split(node->right, key, &node->right, right);
+			*left = node;
+			Update(node);
+		} else {
+			Split(node->left, key, left, &node->left);
+			*right = node;
+			Update(node);
+		}
+	}
+
+	// Merges two subtrees, where all keys of left are smaller
+	Node* Merge(Node* left, Node* right) {
+		if (left == NULL) return right;
+		if (right == NULL) return left;
+		if (left->priority > right->priority) {
+			left->right = Merge(left->right, right);
+			Update(left);
+			return left;
+		}
+		right->left = Merge(left, right->left);
+		Update(right);
+		return right;
+	}
+
+	// Recounts the sizes on the path from a subtree's root towards a key
+	void FixSizes(Node** link, const Key& key) {
+		std::vector<Node*> path;
+		for (Node* node = *link; node != NULL;) {
+			path.push_back(node);
+			if (less(key, node->key)) {
+				node = node->left;
+			} else if (less(node->key, key)) {
+				node = node->right;
+			} else {
+				break;
+			}
+		}
+		for (size_t i = path.size(); i > 0; i--) {
+			Update(path[i - 1]);
+		}
+	}
+
+	Node* root;
+	uint64_t random_state;
+	Compare less;
+};
+
+}  // namespace pokemongo
+}  // namespace mtm
+
+#endif  // RANK_TREE_H
@@ -0,0 +1,114 @@
+#include "report_writer.h"
+
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <unistd.h>
+
+#include "exceptions.h"
+#include "species.h"
+
+// Integers below this are printed in full by the default precision of 6
+#define MAX_PLAIN_DOUBLE	1e6
+
+using namespace mtm::pokemongo;
+
+ReportWriter::ReportWriter(int fd) : fd(fd), buffer() {}
+
+void ReportWriter::Add(const Pokemon & pokemon) {
+	buffer += SpeciesRegistry::Name(pokemon.species);
+	buffer += '(';
+	AppendInt(pokemon.level);
+	buffer += '/';
+	AppendDouble(pokemon.cp);
+	buffer += '/';
+	AppendDouble(pokemon.hp);
+	buffer += ')';
+	for (int type = NORMAL; type <= PSYCHIC; type++) {
+		if (pokemon.types & (1 << type)) {
+			buffer += ' ';
+			buffer += POKEMON_TYPE_NAMES[type];
+		}
+	}
+	buffer += '\n';
+}
+
+void ReportWriter::Add(const Trainer & trainer) {
+	buffer += trainer.name;
+	buffer += " (";
+	AppendInt(trainer.level);
+	buffer += ") ";
+	buffer += TEAM_NAMES[trainer.team];
+	buffer += '\n';
+	for (size_t i = 0; i < trainer.pokemons.size(); i++) {
+		if (!trainer.killed[i]) Add(trainer.pokemons[i]);
+	}
+}
+
+void ReportWriter::AddLocation(const std::string & location,
+							   const std::vector<Trainer*>& trainers) {
+	buffer += location;
+	buffer += ": ";
+	AppendInt((long long)trainers.size());
+	buffer += '\n';
+	for (const Trainer* trainer : trainers) {
+		Add(*trainer);
+	}
+}
+
+size_t ReportWriter::Pending() const {
+	return buffer.size();
+}
+
+const std::string & ReportWriter::Text() const {
+	return buffer;
+}
+
+void ReportWriter::Flush() {
+	const char* data = buffer.data();
+	size_t left = buffer.size();
+	bool failed = false;
+	// A single write, unless the kernel takes less than all of it
+	while (left > 0) {
+		ssize_t written = write(fd, data, left);
+		if (written < 0) {
+			if (errno == EINTR) continue;
+			failed = true;
+			break;
+		}
+		data += written;
+		left -= (size_t)written;
+	}
+	// clear() keeps the capacity for the next report
+	buffer.clear();
+	if (failed) throw ReportWriteFailedException();
+}
+
+void ReportWriter::AppendInt(long long value) {
+	char digits[24];
+	int length = 0;
+	unsigned long long magnitude = value < 0 ?
+		0ULL - (unsigned long long)value : (unsigned long long)value;
+	do {
+		digits[length++] = (char)('0' + magnitude % 10);
+		magnitude /= 10;
+	} while (magnitude > 0);
+	if (value < 0) buffer += '-';
+	while (length > 0) {
+		buffer += digits[--length];
+	}
+}
+
+void ReportWriter::AppendDouble(double value) {
+	// Whole numbers are the common case (HP, most CPs), and print as
+	// integers. Negative zero prints as "-0", so it's left to snprintf.
+	if (std::fabs(value) < MAX_PLAIN_DOUBLE && value == std::floor(value) &&
+		!(value == 0 && std::signbit(value))) {
+		AppendInt((long long)value);
+		return;
+	}
+	// The default ostream format is %g with a precision of 6
+	char formatted[32];
+	int length = std::snprintf(formatted, sizeof(formatted), "%g", value);
+	buffer.append(formatted, (size_t)length);
+}
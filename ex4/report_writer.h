@@ -0,0 +1,80 @@
+#ifndef REPORT_WRITER_H
+#define REPORT_WRITER_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "pokemon.h"
+#include "trainer.h"
+
+namespace mtm {
+namespace pokemongo {
+
+// Formats trainers and Pokemons into a single buffer, and writes the buffer
+// to a file descriptor in one large write. The text is byte-identical to
+// the output operators of Trainer and Pokemon, which flush the stream after
+// every line.
+//
+// The buffer keeps its memory between flushes, so a writer which is reused
+// for many reports stops allocating.
+class ReportWriter {
+public:
+	// Constructs a writer with an empty buffer.
+	//
+	// @param fd the file descriptor to write to. The writer doesn't own it.
+	explicit ReportWriter(int fd);
+
+	// Disable copy and assignment.
+	ReportWriter(const ReportWriter&) = delete;
+	ReportWriter& operator=(const ReportWriter&) = delete;
+
+	// Formats a Pokemon into the buffer, as operator<< prints it.
+	//
+	// @param pokemon the Pokemon to format.
+	void Add(const Pokemon& pokemon);
+
+	// Formats a trainer and its Pokemons into the buffer, as operator<<
+	// prints them.
+	//
+	// @param trainer the trainer to format.
+	void Add(const Trainer& trainer);
+
+	// Formats the population of a location into the buffer:
+	//
+	//     "<location>: <number of trainers>\n
+	//      <trainer1>
+	//      <trainer2>
+	//      ..."
+	//
+	// @param location the name of the location.
+	// @param trainers the trainers in the location, in the order to print.
+	void AddLocation(const std::string& location,
+					 const std::vector<Trainer*>& trainers);
+
+	// Returns the number of bytes waiting in the buffer.
+	size_t Pending() const;
+
+	// Returns the text waiting in the buffer.
+	const std::string& Text() const;
+
+	// Writes the buffer and empties it. Unflushed text is dropped when the
+	// writer is destroyed.
+	//
+	// @throw ReportWriteFailedException if the write failed. The buffer is
+	//		  emptied anyway.
+	void Flush();
+
+private:
+	void AppendInt(long long value);
+	// Formats a double as an ostream with the default flags does
+	void AppendDouble(double value);
+
+	int fd;
+	std::string buffer;
+};
+
+}  // namespace pokemongo
+}  // namespace mtm
+
+#endif  // REPORT_WRITER_H
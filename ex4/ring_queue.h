@@ -0,0 +1,118 @@
+#ifndef RING_QUEUE_H
+#define RING_QUEUE_H
+
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace mtm {
+namespace pokemongo {
+
+// A FIFO queue in a single contiguous ring buffer. Pushing to the back and
+// popping from the front are O(1), and the buffer only grows, by doubling,
+// so a queue which stays about the same size stops allocating.
+//
+// Requirements: T default c'tor, copy c'tor and assignment.
+template<typename T, typename Allocator = std::allocator<T> > class RingQueue {
+public:
+	// Constructs an empty queue, with no buffer.
+	RingQueue() : buffer(), head(0), count(0) {}
+
+	RingQueue(const RingQueue& queue) = default;
+	RingQueue& operator=(const RingQueue& queue) = default;
+
+	// Takes the buffer of the moved queue, leaving it empty.
+	RingQueue(RingQueue&& queue)
+		: buffer(std::move(queue.buffer)), head(queue.head),
+		  count(queue.count) {
+		queue.Clear();
+	}
+	RingQueue& operator=(RingQueue&& queue) {
+		if (this == &queue) return *this;
+		buffer = std::move(queue.buffer);
+		head = queue.head;
+		count = queue.count;
+		queue.Clear();
+		return *this;
+	}
+
+	// Returns the number of elements in the queue.
+	size_t Size() const {
+		return count;
+	}
+
+	bool Empty() const {
+		return count == 0;
+	}
+
+	// Returns the i'th element from the front of the queue.
+	//
+	// @param i index from the front, smaller than Size().
+	const T& operator[](size_t i) const {
+		return buffer[(head + i) % buffer.size()];
+	}
+
+	// Returns the element at the front of the queue. The queue must not be
+	// empty.
+	T& Front() {
+		return buffer[head];
+	}
+	const T& Front() const {
+		return buffer[head];
+	}
+
+	// Adds an element to the back of the queue.
+	//
+	// @param value the element to add.
+	void PushBack(const T& value) {
+		if (count == buffer.size()) Grow();
+		buffer[(head + count) % buffer.size()] = value;
+		count++;
+	}
+
+	// Removes the element at the front of the queue. The queue must not be
+	// empty.
+	void PopFront() {
+		head = (head + 1) % buffer.size();
+		count--;
+		if (count == 0) head = 0;
+	}
+
+	// Removes all elements and frees the buffer.
+	void Clear() {
+		std::vector<T, Allocator>().swap(buffer);
+		head = 0;
+		count = 0;
+	}
+
+	// Makes room for at least the given number of elements.
+	//
+	// @param capacity number of elements to make room for.
+	void Reserve(size_t capacity) {
+		if (capacity <= buffer.size()) return;
+		std::vector<T, Allocator> grown(capacity);
+		for (size_t i = 0; i < count; i++) {
+			grown[i] = (*this)[i];
+		}
+		buffer.swap(grown);
+		head = 0;
+	}
+
+private:
+	void Grow() {
+		Reserve(buffer.empty() ? INITIAL_CAPACITY : buffer.size() * 2);
+	}
+
+	static const size_t INITIAL_CAPACITY = 4;
+
+	std::vector<T, Allocator> buffer;
+	// Index of the front element in the buffer
+	size_t head;
+	size_t count;
+};
+
+}  // namespace pokemongo
+}  // namespace mtm
+
+#endif  // RING_QUEUE_H
@@ -0,0 +1,172 @@
+#include "spatial_index.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <utility>
+
+using namespace mtm::pokemongo;
+
+const int SpatialIndex::CELL_SIZE;
+
+namespace {
+
+long long Distance(const GridPoint& a, const GridPoint& b) {
+	return std::llabs((long long)a.x - b.x) + std::llabs((long long)a.y - b.y);
+}
+
+}  // namespace
+
+SpatialIndex::SpatialIndex() : layers(), positions() {}
+
+void SpatialIndex::Insert(const std::string & name, LocationType type,
+						  const GridPoint & point) {
+	Remove(name);
+	Layer& layer = layers[type];
+	int cell_x = CellOf(point.x);
+	int cell_y = CellOf(point.y);
+	if (layer.size == 0) {
+		layer.min_cell_x = layer.max_cell_x = cell_x;
+		layer.min_cell_y = layer.max_cell_y = cell_y;
+	} else {
+		layer.min_cell_x = std::min(layer.min_cell_x, cell_x);
+		layer.max_cell_x = std::max(layer.max_cell_x, cell_x);
+		layer.min_cell_y = std::min(layer.min_cell_y, cell_y);
+		layer.max_cell_y = std::max(layer.max_cell_y, cell_y);
+	}
+	Entry entry = {name, point};
+	layer.cells[CellKey(cell_x, cell_y)].push_back(entry);
+	layer.size++;
+	positions[name] = std::make_pair(type, point);
+}
+
+bool SpatialIndex::Remove(const std::string & name) {
+	std::unordered_map<std::string, std::pair<LocationType, GridPoint> >::
+		iterator position = positions.find(name);
+	if (position == positions.end()) return false;
+	Layer& layer = layers[position->second.first];
+	const GridPoint& point = position->second.second;
+	long long key = CellKey(CellOf(point.x), CellOf(point.y));
+	std::vector<Entry>& cell = layer.cells[key];
+	for (size_t i = 0; i < cell.size(); i++) {
+		if (cell[i].name == name) {
+			// The order within a cell doesn't matter
+			std::swap(cell[i], cell.back());
+			cell.pop_back();
+			break;
+		}
+	}
+	if (cell.empty()) layer.cells.erase(key);
+	layer.size--;
+	positions.erase(position);
+	return true;
+}
+
+bool SpatialIndex::Find(const std::string & name, GridPoint * point) const {
+	std::unordered_map<std::string, std::pair<LocationType, GridPoint> >::
+		const_iterator position = positions.find(name);
+	if (position == positions.end()) return false;
+	*point = position->second.second;
+	return true;
+}
+
+bool SpatialIndex::Nearest(LocationType type, const GridPoint & point,
+						   std::string * nearest) const {
+	const Layer& layer = layers[type];
+	if (layer.size == 0) return false;
+	int center_x = CellOf(point.x);
+	int center_y = CellOf(point.y);
+	int last_ring = std::max(
+		std::max(center_x - layer.min_cell_x, layer.max_cell_x - center_x),
+		std::max(center_y - layer.min_cell_y, layer.max_cell_y - center_y));
+	const Entry* best = NULL;
+	long long best_distance = 0;
+	for (int ring = 0; ring <= last_ring; ring++) {
+		VisitRing(layer, center_x, center_y, ring, [&](const Entry& entry) {
+			long long distance = Distance(point, entry.point);
+			if (best == NULL || distance < best_distance ||
+				(distance == best_distance && entry.name < best->name)) {
+				best = &entry;
+				best_distance = distance;
+			}
+		});
+		// Every location beyond this ring is more than ring cells away
+		if (best != NULL && best_distance <= (long long)ring * CELL_SIZE) {
+			break;
+		}
+	}
+	*nearest = best->name;
+	return true;
+}
+
+std::vector<std::string> SpatialIndex::Within(LocationType type,
+											  const GridPoint & point,
+											  int radius) const {
+	const Layer& layer = layers[type];
+	std::vector<std::pair<long long, std::string> > found;
+	if (layer.size > 0 && radius >= 0) {
+		int first_x = std::max(CellOf(point.x - radius), layer.min_cell_x);
+		int last_x = std::min(CellOf(point.x + radius), layer.max_cell_x);
+		int first_y = std::max(CellOf(point.y - radius), layer.min_cell_y);
+		int last_y = std::min(CellOf(point.y + radius), layer.max_cell_y);
+		for (int cell_x = first_x; cell_x <= last_x; cell_x++) {
+			for (int cell_y = first_y; cell_y <= last_y; cell_y++) {
+				std::unordered_map<long long, std::vector<Entry> >::
+					const_iterator cell = layer.cells.find(
+						CellKey(cell_x, cell_y));
+				if (cell == layer.cells.end()) continue;
+				for (const Entry& entry : cell->second) {
+					long long distance = Distance(point, entry.point);
+					if (distance <= radius) {
+						found.push_back(std::make_pair(distance, entry.name));
+					}
+				}
+			}
+		}
+	}
+	std::sort(found.begin(), found.end());
+	std::vector<std::string> names;
+	names.reserve(found.size());
+	for (const std::pair<long long, std::string>& location : found) {
+		names.push_back(location.second);
+	}
+	return names;
+}
+
+size_t SpatialIndex::Size() const {
+	return positions.size();
+}
+
+template<typename Visit>
+void SpatialIndex::VisitRing(const Layer & layer, int center_x, int center_y,
+							 int ring, Visit visit) const {
+	for (int cell_x = center_x - ring; cell_x <= center_x + ring; cell_x++) {
+		if (cell_x < layer.min_cell_x || cell_x > layer.max_cell_x) continue;
+		// Only the top and bottom rows of the ring, unless at its sides
+		bool side = cell_x == center_x - ring || cell_x == center_x + ring;
+		int step = side || ring == 0 ? 1 : 2 * ring;
+		for (int cell_y = center_y - ring; cell_y <= center_y + ring;
+			 cell_y += step) {
+			if (cell_y < layer.min_cell_y || cell_y > layer.max_cell_y) {
+				continue;
+			}
+			std::unordered_map<long long, std::vector<Entry> >::
+				const_iterator cell = layer.cells.find(
+					CellKey(cell_x, cell_y));
+			if (cell == layer.cells.end()) continue;
+			for (const Entry& entry : cell->second) {
+				visit(entry);
+			}
+		}
+	}
+}
+
+int SpatialIndex::CellOf(int coordinate) {
+	// Rounds down, also for negative coordinates
+	return coordinate >= 0 ? coordinate / CELL_SIZE :
+		-((-(coordinate + 1)) / CELL_SIZE) - 1;
+}
+
+long long SpatialIndex::CellKey(int cell_x, int cell_y) {
+	return (long long)(((unsigned long long)(unsigned int)cell_x << 32) |
+					   (unsigned int)cell_y);
+}
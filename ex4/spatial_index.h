@@ -0,0 +1,112 @@
+#ifndef SPATIAL_INDEX_H
+#define SPATIAL_INDEX_H
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "location.h"
+
+namespace mtm {
+namespace pokemongo {
+
+// A point on the world's grid. x grows to the EAST and y to the NORTH.
+struct GridPoint {
+	int x;
+	int y;
+};
+
+// Named locations on a grid, bucketed by location type and by square cells
+// of CELL_SIZE x CELL_SIZE points. Distances are in grid steps (Manhattan
+// distance).
+//
+// A query only scans the cells around its point, spreading out ring by ring
+// until no closer location can be found, so its time depends on the
+// locations near the point rather than on the size of the world.
+class SpatialIndex {
+public:
+	// Width and height of a bucket, in grid steps
+	static const int CELL_SIZE = 8;
+
+	// Constructs an empty index.
+	SpatialIndex();
+
+	// Adds a location to the index, or moves it if it's already there.
+	//
+	// @param name the name of the location.
+	// @param type the kind of the location.
+	// @param point the position of the location.
+	void Insert(const std::string& name, LocationType type,
+				const GridPoint& point);
+
+	// Removes a location from the index.
+	//
+	// @param name the name of the location.
+	// @return false if the location wasn't in the index.
+	bool Remove(const std::string& name);
+
+	// Finds the position of a location.
+	//
+	// @param name the name of the location.
+	// @param point set to the position of the location, if it's indexed.
+	// @return false if the location isn't in the index.
+	bool Find(const std::string& name, GridPoint* point) const;
+
+	// Finds the location of a given type which is closest to a point.
+	// Locations at equal distance are ordered by name.
+	//
+	// @param type the kind of location to find.
+	// @param point the point to measure distances from.
+	// @param nearest set to the name of the closest location, if any.
+	// @return false if there are no locations of the type.
+	bool Nearest(LocationType type, const GridPoint& point,
+				 std::string* nearest) const;
+
+	// Finds the locations of a given type within a distance of a point.
+	//
+	// @param type the kind of locations to find.
+	// @param point the point to measure distances from.
+	// @param radius the largest distance to include.
+	// @return the names of the locations, closest first and then by name.
+	std::vector<std::string> Within(LocationType type, const GridPoint& point,
+									int radius) const;
+
+	// Returns the number of locations in the index.
+	size_t Size() const;
+
+private:
+	struct Entry {
+		std::string name;
+		GridPoint point;
+	};
+
+	// The locations of one type, by cell
+	struct Layer {
+		std::unordered_map<long long, std::vector<Entry> > cells;
+		size_t size;
+		// Bounds of the cells ever used, so searches know when to stop
+		int min_cell_x;
+		int max_cell_x;
+		int min_cell_y;
+		int max_cell_y;
+	};
+
+	// Calls visit on every entry in the cells at Chebyshev distance ring
+	// from a center cell
+	template<typename Visit>
+	void VisitRing(const Layer& layer, int center_x, int center_y, int ring,
+				   Visit visit) const;
+
+	static int CellOf(int coordinate);
+	static long long CellKey(int cell_x, int cell_y);
+
+	Layer layers[LOCATION_STARBUCKS + 1];
+	// Type and position of every indexed location
+	std::unordered_map<std::string, std::pair<LocationType, GridPoint> >
+		positions;
+};
+
+}  // namespace pokemongo
+}  // namespace mtm
+
+#endif  // SPATIAL_INDEX_H
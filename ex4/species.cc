@@ -0,0 +1,118 @@
+#include "species.h"
+
+#include <atomic>
+#include <mutex>
+#include <new>
+#include <set>
+#include <unordered_map>
+
+#include "pokemon.h"
+
+using namespace mtm::pokemongo;
+
+const char* const mtm::pokemongo::POKEMON_TYPE_NAMES[] = {
+	"NORMAL", "ROCK", "BUG", "FAIRY", "GROUND", "GRASS", "WATER", "ICE",
+	"GHOST", "POISON", "ELECTRIC", "FIRE", "FLYING", "PSYCHIC",
+};
+
+namespace {
+
+struct Species {
+	std::string name;
+	bool types_resolved;
+	SpeciesRegistry::Types default_types;
+
+	explicit Species(const std::string& name)
+		: name(name), types_resolved(false), default_types() {}
+};
+
+// Entries in the first block of species. Every next block is twice as big,
+// so BLOCKS_NUM blocks hold more than any SpeciesId.
+const size_t FIRST_BLOCK_SIZE = 64;
+const size_t BLOCKS_NUM = 27;
+
+struct Registry {
+	std::mutex mutex;
+	// Species by id, in blocks. Blocks are never moved or freed and the
+	// table of blocks never grows, so an entry can be read without the lock
+	// while others are added.
+	Species* blocks[BLOCKS_NUM];
+	// Number of species, stored once a new entry is complete
+	std::atomic<size_t> size;
+	std::unordered_map<std::string, SpeciesRegistry::SpeciesId> ids;
+
+	Registry() : blocks(), size(0) {}
+};
+
+Registry& GetRegistry() {
+	// Never destroyed, since Pokemons may be printed by static destructors
+	static Registry* registry = new Registry();
+	return *registry;
+}
+
+// Finds where the entry of a species is kept.
+//
+// @param id the id of the species.
+// @param block set to the index of the entry's block.
+// @param offset set to the index of the entry in its block.
+void Locate(SpeciesRegistry::SpeciesId id, size_t* block, size_t* offset) {
+	size_t first = 0;
+	*block = 0;
+	while (id >= first + (FIRST_BLOCK_SIZE << *block)) {
+		first += FIRST_BLOCK_SIZE << *block;
+		(*block)++;
+	}
+	*offset = id - first;
+}
+
+}  // namespace
+
+SpeciesRegistry::SpeciesId SpeciesRegistry::Intern(
+	const std::string & species) {
+	Registry& registry = GetRegistry();
+	std::lock_guard<std::mutex> lock(registry.mutex);
+	std::unordered_map<std::string, SpeciesId>::iterator found =
+		registry.ids.find(species);
+	if (found != registry.ids.end()) return found->second;
+	SpeciesId id = (SpeciesId)registry.size.load(std::memory_order_relaxed);
+	size_t block, offset;
+	Locate(id, &block, &offset);
+	if (offset == 0) {
+		registry.blocks[block] = static_cast<Species*>(
+			::operator new((FIRST_BLOCK_SIZE << block) * sizeof(Species)));
+	}
+	new (&registry.blocks[block][offset]) Species(species);
+	registry.ids[species] = id;
+	registry.size.store(id + 1, std::memory_order_release);
+	return id;
+}
+
+const std::string & SpeciesRegistry::Name(SpeciesId id) {
+	// Printing takes no lock: an entry never changes once added, and the
+	// id was handed out by Intern after its entry was complete
+	Registry& registry = GetRegistry();
+	size_t block, offset;
+	Locate(id, &block, &offset);
+	return registry.blocks[block][offset].name;
+}
+
+const SpeciesRegistry::Types & SpeciesRegistry::DefaultTypes(SpeciesId id) {
+	Registry& registry = GetRegistry();
+	std::lock_guard<std::mutex> lock(registry.mutex);
+	size_t block, offset;
+	Locate(id, &block, &offset);
+	Species& species = registry.blocks[block][offset];
+	if (!species.types_resolved) {
+		for (PokemonType type : Pokemon::GetDefaultTypes(species.name)) {
+			if (type < NORMAL || type > PSYCHIC) continue;
+			species.default_types.mask |= 1 << type;
+			species.default_types.sum += type;
+		}
+		species.types_resolved = true;
+	}
+	return species.default_types;
+}
+
+size_t SpeciesRegistry::Size() {
+	return GetRegistry().size.load(std::memory_order_acquire);
+}
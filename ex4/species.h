@@ -0,0 +1,60 @@
+#ifndef SPECIES_H
+#define SPECIES_H
+
+#include <cstdint>
+#include <string>
+
+namespace mtm {
+namespace pokemongo {
+
+// Interned species names. Every species name gets a small id the first time
+// it's seen, so Pokemons store 4 bytes instead of a string. The default
+// types of a species are looked up once and cached with its name. Ids are
+// never released, and entries are never moved, so ids and references stay
+// valid for the lifetime of the process.
+//
+// All functions are thread safe. Name and Size take no lock, so printing
+// Pokemons never waits for new species to be interned.
+class SpeciesRegistry {
+public:
+	typedef uint32_t SpeciesId;
+
+	// A set of Pokemon types: bit t is set iff type t is in the set
+	struct Types {
+		uint16_t mask;
+		// Sum of the types' values
+		uint16_t sum;
+	};
+
+	// Returns the id of a species, giving it a new id if needed.
+	//
+	// @param species the name of the species.
+	// @return the id of the species.
+	static SpeciesId Intern(const std::string& species);
+
+	// Returns the name of a species.
+	//
+	// @param id an id returned by Intern.
+	// @return the name of the species.
+	static const std::string& Name(SpeciesId id);
+
+	// Returns the default types of a species, as given by
+	// Pokemon::GetDefaultTypes. The types are looked up on the first call
+	// for the species only.
+	//
+	// @param id an id returned by Intern.
+	// @return the default types of the species.
+	static const Types& DefaultTypes(SpeciesId id);
+
+	// Returns the number of species interned so far.
+	static size_t Size();
+};
+
+// Names of the Pokemon types, as Pokemons are printed, indexed by the
+// PokemonType values
+extern const char* const POKEMON_TYPE_NAMES[];
+
+}  // namespace pokemongo
+}  // namespace mtm
+
+#endif  // SPECIES_H
@@ -0,0 +1,85 @@
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace mtm {
+namespace pokemongo {
+
+// A bounded FIFO queue between a single producer thread and a single
+// consumer thread, with no locks. Neither side ever waits for the other: a
+// push to a full ring and a pop from an empty ring fail instead.
+//
+// The producer only writes tail and the consumer only writes head, and each
+// publishes its slot with a release store that the other side reads with an
+// acquire load. The two indices are kept on separate cache lines.
+//
+// Requirements: T default c'tor and move assignment.
+template<typename T> class SpscRing {
+public:
+	// Constructs an empty ring.
+	//
+	// @param capacity the number of elements the ring can hold, rounded up
+	//		  to a power of two.
+	explicit SpscRing(size_t capacity) : slots(), mask(0), head(0), tail(0) {
+		size_t size = 1;
+		while (size < capacity) size *= 2;
+		slots.resize(size);
+		mask = size - 1;
+	}
+
+	// Disable copy and assignment.
+	SpscRing(const SpscRing&) = delete;
+	SpscRing& operator=(const SpscRing&) = delete;
+
+	// Adds an element to the back of the ring. Called by the producer only.
+	//
+	// @param value the element to add. Moved from only on success.
+	// @return false if the ring is full.
+	bool TryPush(T&& value) {
+		size_t current_tail = tail.load(std::memory_order_relaxed);
+		size_t current_head = head.load(std::memory_order_acquire);
+		if (current_tail - current_head == slots.size()) return false;
+		slots[current_tail & mask] = std::move(value);
+		tail.store(current_tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	// Takes the element at the front of the ring. Called by the consumer
+	// only.
+	//
+	// @param value set to the element, on success.
+	// @return false if the ring is empty.
+	bool TryPop(T* value) {
+		size_t current_head = head.load(std::memory_order_relaxed);
+		if (current_head == tail.load(std::memory_order_acquire)) return false;
+		*value = std::move(slots[current_head & mask]);
+		head.store(current_head + 1, std::memory_order_release);
+		return true;
+	}
+
+	// Returns the number of elements the ring can hold.
+	size_t Capacity() const {
+		return slots.size();
+	}
+
+private:
+	static const size_t CACHE_LINE_SIZE = 64;
+
+	std::vector<T> slots;
+	size_t mask;
+	// Index of the next element to pop, written by the consumer
+	std::atomic<size_t> head;
+	char head_padding[CACHE_LINE_SIZE - sizeof(std::atomic<size_t>)];
+	// Index of the next element to push, written by the producer
+	std::atomic<size_t> tail;
+	char tail_padding[CACHE_LINE_SIZE - sizeof(std::atomic<size_t>)];
+};
+
+}  // namespace pokemongo
+}  // namespace mtm
+
+#endif  // SPSC_RING_H
@@ -1,22 +1,30 @@
 #include "starbucks.h"
 
+#include <iterator>
+#include <utility>
+
+#include "metrics.h"
+
 using namespace mtm::pokemongo;
 
-Starbucks::Starbucks(const std::vector<Pokemon> pokemons) 
-	: pokemons(pokemons) {}
+Starbucks::Starbucks(std::vector<Pokemon> pokemons)
+	: pokemons(std::make_move_iterator(pokemons.begin()),
+			   std::make_move_iterator(pokemons.end())) {}
 
-void Starbucks::Arrive(Trainer & trainer) {
-	Location::Arrive(trainer);
+LocationStatus Starbucks::TryArrive(Trainer & trainer) {
+	LocationStatus status = Location::TryArrive(trainer);
+	if (status != LOCATION_SUCCESS) return status;
 	if (!pokemons.empty()) {
-		if (trainer.TryToCatch(pokemons.front())) {
+		if (trainer.TryToCatch(std::move(pokemons.front()))) {
 			//  catch succeeded - remove pokemon from list
-			pokemons.erase(pokemons.begin());
+			METRICS_COUNT(METRIC_POKEMONS_HANDED_OUT);
+			pokemons.pop_front();
 		}
 	}
+	return LOCATION_SUCCESS;
 }
 
-void Starbucks::Leave(Trainer & trainer) {
-	Location::Leave(trainer);
-	
+LocationStatus Starbucks::TryLeave(Trainer & trainer) {
 	// Do Nothing
+	return Location::TryLeave(trainer);
 }
@@ -1,4 +1,7 @@
 #pragma once
+#include <deque>
+#include <vector>
+
 #include "location.h"
 #include "exceptions.h"
 #include "trainer.h"
@@ -8,34 +11,45 @@ namespace mtm {
 namespace pokemongo {
 
 class Starbucks : public Location {
-	std::vector<Pokemon> pokemons;
+	// Pokemons left, in the order they are handed out
+	std::deque<Pokemon, CountingAllocator<Pokemon, MEMORY_POKEMONS> >
+		pokemons;
+
+	// Saves and restores the Pokemons left
+	friend class Checkpoint;
 public:
 	// Constructs a new Starbucks coffee shop 
 	// with pokemons and no coffee!
 	//
-	// @param pokemons the list of pokemons in the shop
-	Starbucks(const std::vector<Pokemon> pokemons);
+	// @param pokemons the list of pokemons in the shop. Pass an rvalue to
+	//		  move the pokemons in instead of copying them.
+	Starbucks(std::vector<Pokemon> pokemons);
 
 	~Starbucks() {}
 
+	LocationType Type() const override {
+		return LOCATION_STARBUCKS;
+	}
+
 	// make copy and assignment operator as compiler's default
 	Starbucks(const Starbucks& starbucks) = default;
 	Starbucks& operator=(const Starbucks& starbucks) = default;
 
 	// Handle a new trainer arriving to Starbucks,
-	// Buying coffee and try to catch the first pokemon he sees!
+	// Buying coffee and try to catch the first pokemon he sees! A caught
+	// pokemon is moved to the trainer.
 	//
 	// @param trainer the trainer arriving.
-	// @throw LocationTrainerAlreadyInLocationException 
+	// @return LOCATION_TRAINER_ALREADY_IN_LOCATION
 	//			if trainer is already in the location.
-	void Arrive(Trainer& trainer) override;
+	LocationStatus TryArrive(Trainer& trainer) override;
 
 	// Handle an old trainer leaving the starbucks for a new adventure
 	//
 	// @param trainer the trainer leaving.
-	// @throw LocationTrainerNotFoundException if trainer is not
-	//		  in the location.
-	void Leave(Trainer& trainer) override;
+	// @return LOCATION_TRAINER_NOT_FOUND if trainer is not
+	//		   in the location.
+	LocationStatus TryLeave(Trainer& trainer) override;
 };
 } // pokemongo
 } // mtm
@@ -0,0 +1,69 @@
+#ifndef STATUS_H
+#define STATUS_H
+
+// Results of the non-throwing (Try*) functions. Every failure matches the
+// exception thrown by the throwing version of the same function.
+
+namespace mtm {
+
+	typedef enum {
+		KGRAPH_SUCCESS,
+		KGRAPH_KEY_NOT_FOUND,
+		KGRAPH_KEY_ALREADY_EXISTS,
+		KGRAPH_ITERATOR_REACHED_END,
+		KGRAPH_EDGE_OUT_OF_RANGE,
+		KGRAPH_EDGE_ALREADY_IN_USE,
+		KGRAPH_NODES_ALREADY_CONNECTED,
+		KGRAPH_NODES_ARE_NOT_CONNECTED,
+	} KGraphStatus;
+
+namespace pokemongo {
+
+	typedef enum {
+		LOCATION_SUCCESS,
+		LOCATION_TRAINER_NOT_FOUND,
+		LOCATION_TRAINER_ALREADY_IN_LOCATION,
+	} LocationStatus;
+
+	typedef enum {
+		WORLD_SUCCESS,
+		WORLD_LOCATION_NOT_FOUND,
+		WORLD_INVALID_DIRECTION,
+		WORLD_REACHED_DEAD_END,
+		WORLD_NO_COORDINATES,
+		WORLD_NO_MATCHING_LOCATION,
+	} WorldStatus;
+
+	typedef enum {
+		POKEMONGO_SUCCESS,
+		POKEMONGO_INVALID_ARGS,
+		POKEMONGO_TRAINER_NAME_ALREADY_USED,
+		POKEMONGO_LOCATION_NOT_FOUND,
+		POKEMONGO_TRAINER_NOT_FOUND,
+		POKEMONGO_REACHED_DEAD_END,
+		// Thrown as KGraphEdgeOutOfRange by the throwing functions
+		POKEMONGO_INVALID_DIRECTION,
+		// A command whose tick threw before applying it. Never journaled.
+		POKEMONGO_TICK_FAILED,
+	} PokemonGoStatus;
+
+	typedef enum {
+		WORLD_CHANGE_SUCCESS,
+		// Thrown as WorldInvalidInputLineException
+		WORLD_CHANGE_INVALID_LINE,
+		// Thrown as WorldLocationNameAlreadyUsed
+		WORLD_CHANGE_LOCATION_NAME_ALREADY_USED,
+		// Thrown as PokemonGoLocationNotFoundException
+		WORLD_CHANGE_LOCATION_NOT_FOUND,
+		// Thrown as PokemonGoInvalidArgsException
+		WORLD_CHANGE_INVALID_FALLBACK,
+		// Thrown as the matching KGraph exceptions
+		WORLD_CHANGE_INVALID_DIRECTION,
+		WORLD_CHANGE_EDGE_ALREADY_IN_USE,
+		WORLD_CHANGE_ALREADY_CONNECTED,
+		WORLD_CHANGE_NOT_CONNECTED,
+	} WorldChangeStatus;
+}  //  namespace pokemongo
+}  //  namespace mtm
+
+#endif  // STATUS_H
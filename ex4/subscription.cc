@@ -0,0 +1,136 @@
+#include "subscription.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "gym.h"
+
+using namespace mtm::pokemongo;
+
+Subscription::Subscription(int event_types,
+						   const std::vector<std::string> & locations,
+						   size_t capacity)
+	: event_types(event_types), locations(locations.begin(), locations.end()),
+	  batches(capacity), dropped(0) {}
+
+bool Subscription::TryPoll(EventBatch * batch) {
+	return batches.TryPop(batch);
+}
+
+unsigned long Subscription::Dropped() const {
+	return dropped.load(std::memory_order_relaxed);
+}
+
+bool Subscription::Wants(const GameEvent & event) const {
+	if ((event_types & event.type) == 0) return false;
+	return locations.empty() ||
+		locations.find(event.location) != locations.end();
+}
+
+EventHub::EventHub() : subscriptions(), next_tick(0) {}
+
+void EventHub::Add(Subscription * subscription) {
+	subscriptions.push_back(subscription);
+}
+
+bool EventHub::Remove(Subscription * subscription) {
+	std::vector<Subscription*>::iterator position = std::find(
+		subscriptions.begin(), subscriptions.end(), subscription);
+	if (position == subscriptions.end()) return false;
+	subscriptions.erase(position);
+	return true;
+}
+
+void EventHub::RecordArrival(const std::string & location_name,
+							 const Location * location,
+							 const std::string & trainer) {
+	Record(location_name, location, trainer, 1);
+}
+
+void EventHub::RecordDeparture(const std::string & location_name,
+							   const Location * location,
+							   const std::string & trainer) {
+	Record(location_name, location, trainer, -1);
+}
+
+void EventHub::Record(const std::string & location_name,
+					  const Location * location, const std::string & trainer,
+					  int presence) {
+	if (subscriptions.empty()) return;
+	std::pair<std::unordered_map<const Location*, size_t>::iterator, bool>
+		touched_index = touched_indices.insert(
+			std::make_pair(location, touched.size()));
+	if (touched_index.second) {
+		TouchedLocation changed = {location_name, location,
+								   LeaderOf(location)};
+		touched.push_back(changed);
+	}
+	size_t location_index = touched_index.first->second;
+	std::pair<std::unordered_map<PresenceKey, size_t,
+								 PresenceKeyHash>::iterator, bool>
+		presence_index = presence_indices.insert(std::make_pair(
+			PresenceKey(location_index, trainer), presences.size()));
+	if (presence_index.second) {
+		Presence change = {location_index, trainer, 0};
+		presences.push_back(change);
+	}
+	presences[presence_index.first->second].change += presence;
+}
+
+size_t EventHub::PresenceKeyHash::operator()(const PresenceKey & key) const {
+	return std::hash<std::string>()(key.second) * 31 + key.first;
+}
+
+void EventHub::RecordRemoval(const Location * location) {
+	std::unordered_map<const Location*, size_t>::iterator found =
+		touched_indices.find(location);
+	if (found == touched_indices.end()) return;
+	touched[found->second].location = NULL;
+	// A location allocated later at the same address is another location
+	touched_indices.erase(found);
+}
+
+void EventHub::Publish() {
+	unsigned long tick = next_tick++;
+	if (touched.empty()) return;
+	std::vector<GameEvent> events;
+	for (const Presence& presence : presences) {
+		if (presence.change == 0) continue;
+		GameEvent event = {presence.change > 0 ? EVENT_ARRIVAL :
+						   EVENT_DEPARTURE,
+						   touched[presence.location].name, presence.trainer};
+		events.push_back(event);
+	}
+	for (const TouchedLocation& changed : touched) {
+		if (changed.location == NULL ||
+			changed.location->Type() != LOCATION_GYM) {
+			continue;
+		}
+		std::string leader = LeaderOf(changed.location);
+		if (leader == changed.leader) continue;
+		GameEvent event = {EVENT_LEADER_CHANGE, changed.name, leader};
+		events.push_back(event);
+	}
+	touched.clear();
+	touched_indices.clear();
+	presences.clear();
+	presence_indices.clear();
+
+	for (Subscription* subscription : subscriptions) {
+		EventBatch batch;
+		batch.tick = tick;
+		for (const GameEvent& event : events) {
+			if (subscription->Wants(event)) batch.events.push_back(event);
+		}
+		if (batch.events.empty()) continue;
+		if (!subscription->batches.TryPush(std::move(batch))) {
+			subscription->dropped.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+}
+
+std::string EventHub::LeaderOf(const Location * location) {
+	if (location->Type() != LOCATION_GYM) return "";
+	const Trainer* leader = static_cast<const Gym*>(location)->GetLeader();
+	return leader == NULL ? "" : leader->GetName();
+}
@@ -0,0 +1,193 @@
+#ifndef SUBSCRIPTION_H
+#define SUBSCRIPTION_H
+
+#include <atomic>
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "location.h"
+#include "spsc_ring.h"
+
+namespace mtm {
+namespace pokemongo {
+
+// Kinds of game events, as bits so that a subscription can pick several.
+typedef enum {
+	EVENT_ARRIVAL = 1,
+	EVENT_DEPARTURE = 2,
+	EVENT_LEADER_CHANGE = 4,
+	EVENT_ALL = EVENT_ARRIVAL | EVENT_DEPARTURE | EVENT_LEADER_CHANGE,
+} GameEventType;
+
+// A change in a location.
+struct GameEvent {
+	GameEventType type;
+	std::string location;
+	// The trainer which arrived or left, or the new leader of the gym, which
+	// is empty if the gym was left with no leader
+	std::string trainer;
+};
+
+// The events of one tick which match a subscription.
+struct EventBatch {
+	// Number of the tick, counting every tick published by the game
+	unsigned long tick;
+	std::vector<GameEvent> events;
+};
+
+// Receives batches of game events, filtered by event type and location.
+//
+// The game pushes a batch at the end of every tick which had matching
+// events, and a single consumer thread polls them, with no locks between
+// the two. The game never waits for the consumer: if the subscription
+// already holds as many batches as it can, the new batch is dropped and
+// counted.
+class Subscription {
+public:
+	// Constructs a new subscription.
+	//
+	// @param event_types the GameEventType values to receive, or'ed together.
+	// @param locations names of the locations to receive events of, or empty
+	//		  for all locations.
+	// @param capacity number of batches which can wait to be polled.
+	Subscription(int event_types, const std::vector<std::string>& locations,
+				 size_t capacity);
+
+	// Disable copy and assignment.
+	Subscription(const Subscription&) = delete;
+	Subscription& operator=(const Subscription&) = delete;
+
+	// Takes the oldest batch which wasn't polled yet. Called by the consumer
+	// thread only.
+	//
+	// @param batch set to the batch, if there is one.
+	// @return false if there are no batches waiting.
+	bool TryPoll(EventBatch* batch);
+
+	// Returns the number of batches dropped since the subscription was made.
+	// Can be called from any thread.
+	unsigned long Dropped() const;
+
+private:
+	// Checks whether an event passes the filter of the subscription
+	bool Wants(const GameEvent& event) const;
+
+	const int event_types;
+	const std::unordered_set<std::string> locations;
+	SpscRing<EventBatch> batches;
+	std::atomic<unsigned long> dropped;
+
+	// Filters and delivers the batches
+	friend class EventHub;
+};
+
+// Collects the arrivals and departures of a game during a tick, and delivers
+// them to its subscriptions when the tick ends.
+//
+// Events are coalesced per tick: a trainer which arrives at a location and
+// leaves it (or leaves and comes back) in the same tick is not reported, and
+// a gym whose leader changed is reported once, with its leader at the end of
+// the tick, if the leader differs from the one it had when the tick started.
+// A batch lists the arrivals and departures by the order they first
+// happened in, and then the leader changes.
+//
+// All functions are called by the game thread. Recording does nothing while
+// there are no subscriptions.
+class EventHub {
+public:
+	EventHub();
+
+	// Disable copy and assignment.
+	EventHub(const EventHub&) = delete;
+	EventHub& operator=(const EventHub&) = delete;
+
+	// Starts delivering events to a subscription.
+	//
+	// @param subscription the subscription. Must outlive the hub, or be
+	//		  removed first.
+	void Add(Subscription* subscription);
+
+	// Stops delivering events to a subscription.
+	//
+	// @param subscription the subscription.
+	// @return false if the subscription wasn't added.
+	bool Remove(Subscription* subscription);
+
+	// Records a trainer arriving at or leaving a location. Must be called
+	// before the location changes, so that its leader can be compared at the
+	// end of the tick.
+	//
+	// @param location_name the name of the location.
+	// @param location the location.
+	// @param trainer the name of the trainer.
+	void RecordArrival(const std::string& location_name,
+					   const Location* location, const std::string& trainer);
+	void RecordDeparture(const std::string& location_name,
+						 const Location* location, const std::string& trainer);
+
+	// Records a location removed from the world, after the departures of
+	// its trainers. Its leader is not compared at the end of the tick.
+	//
+	// @param location the location, before it's deleted.
+	void RecordRemoval(const Location* location);
+
+	// Ends the tick: coalesces the events recorded since the last call, and
+	// pushes every subscription the ones which match it.
+	void Publish();
+
+private:
+	// A location which changed during the tick
+	struct TouchedLocation {
+		std::string name;
+		// NULL once the location is removed
+		const Location* location;
+		// The name of the leader before the tick, if it's a gym
+		std::string leader;
+	};
+
+	// A trainer's arrival (+1) or departure (-1) at a touched location, or
+	// both (0)
+	struct Presence {
+		size_t location;
+		std::string trainer;
+		int change;
+	};
+
+	// Identifies a change of presence: the index of the touched location
+	// and the name of the trainer
+	typedef std::pair<size_t, std::string> PresenceKey;
+
+	struct PresenceKeyHash {
+		size_t operator()(const PresenceKey& key) const;
+	};
+
+	// Adds a trainer's change of presence in a location to the tick
+	void Record(const std::string& location_name, const Location* location,
+				const std::string& trainer, int presence);
+
+	// Returns the name of the leader of a location, or "" if it's not a gym
+	// or has no leader
+	static std::string LeaderOf(const Location* location);
+
+	std::vector<Subscription*> subscriptions;
+	unsigned long next_tick;
+
+	// Locations changed during the tick, by the order they were first
+	// changed, and the index of each
+	std::vector<TouchedLocation> touched;
+	std::unordered_map<const Location*, size_t> touched_indices;
+	// Changes of presence during the tick, by the order they first
+	// happened, and the index of each by location index and trainer name
+	std::vector<Presence> presences;
+	std::unordered_map<PresenceKey, size_t, PresenceKeyHash>
+		presence_indices;
+};
+
+}  // namespace pokemongo
+}  // namespace mtm
+
+#endif  // SUBSCRIPTION_H
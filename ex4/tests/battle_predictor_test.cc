@@ -0,0 +1,110 @@
+#include "../battle_predictor.h"
+
+#include <set>
+
+#include "../exceptions.h"
+#include "test_utils.h"
+
+using namespace mtm::pokemongo;
+
+bool testBattlePredictorCache() {
+	std::set<PokemonType> types;
+	types.insert(NORMAL);
+	Trainer ash = Trainer("ash", RED);
+	Trainer gary = Trainer("gary", YELLOW);
+	ash.TryToCatch(Pokemon("pikachu", types, 3, 1));
+	gary.TryToCatch(Pokemon("pikachu", types, 5, 1));
+	BattlePredictor predictor;
+
+	// the second prediction comes from the cache
+	ASSERT_FALSE(predictor.Predict(ash, gary).first_wins);
+	ASSERT_FALSE(predictor.Predict(ash, gary).first_wins);
+	ASSERT_EQUAL(predictor.Hits(), (size_t)1);
+	ASSERT_EQUAL(predictor.Misses(), (size_t)1);
+
+	// the order of the trainers matters
+	ASSERT_TRUE(predictor.Predict(gary, ash).first_wins);
+	ASSERT_EQUAL(predictor.Misses(), (size_t)2);
+
+	// a change to a trainer invalidates its predictions
+	ASSERT_TRUE(ash.AddItem(new Candy(1)));
+	ASSERT_TRUE(ash.AddItem(new Candy(1)));
+	ash.TryToCatch(Pokemon("pikachu", types, 4.8, 1));
+	BattlePrediction prediction = predictor.Predict(ash, gary);
+	ASSERT_EQUAL(predictor.Misses(), (size_t)3);
+	ASSERT_TRUE(prediction.uses_item[0]);
+	ASSERT_TRUE(prediction.first_wins);
+
+	// so does a battle
+	TrainersBattle(ash, gary);
+	predictor.Predict(ash, gary);
+	ASSERT_EQUAL(predictor.Misses(), (size_t)4);
+	ASSERT_EQUAL(predictor.Hits(), (size_t)1);
+
+	// a copy is a different trainer
+	Trainer copy = ash;
+	predictor.Predict(copy, gary);
+	ASSERT_EQUAL(predictor.Misses(), (size_t)5);
+
+	// failed predictions aren't cached
+	Trainer brock = Trainer("brock", RED);
+	Trainer misty = Trainer("misty", RED);
+	ASSERT_THROW(TrainerInvalidArgsException, predictor.Predict(brock, misty));
+	ASSERT_THROW(TrainerInvalidArgsException, predictor.Predict(brock, misty));
+	ASSERT_EQUAL(predictor.Size(), (size_t)5);
+	return true;
+}
+
+bool testBattlePredictorAfterHits() {
+	std::set<PokemonType> types;
+	types.insert(NORMAL);
+	Trainer ash = Trainer("ash", RED);
+	Trainer gary = Trainer("gary", YELLOW);
+	ash.TryToCatch(Pokemon("pikachu", types, 40, 1));
+	gary.TryToCatch(Pokemon("pikachu", types, 40, 1));
+	BattlePredictor predictor;
+
+	// a tie hurts both pokemons, so the third battle kills them
+	for (int i = 0; i < 3; i++) {
+		BattlePrediction prediction = predictor.Predict(ash, gary);
+		BattlePrediction fresh = PredictBattle(ash, gary);
+		ASSERT_EQUAL(prediction.loses_pokemon[0], fresh.loses_pokemon[0]);
+		ASSERT_EQUAL(prediction.loses_pokemon[1], fresh.loses_pokemon[1]);
+		ASSERT_EQUAL(prediction.loses_pokemon[0], i == 2);
+		TrainersBattle(ash, gary);
+	}
+	ASSERT_EQUAL(predictor.Hits(), (size_t)0);
+
+	// so does a loss the losing pokemon survives
+	Trainer misty = Trainer("misty", RED);
+	Trainer brock = Trainer("brock", YELLOW);
+	Trainer may = Trainer("may", YELLOW);
+	misty.TryToCatch(Pokemon("pikachu", types, 40, 1));
+	brock.TryToCatch(Pokemon("pikachu", types, 50, 1));
+	may.TryToCatch(Pokemon("pikachu", types, 60, 1));
+	ASSERT_FALSE(predictor.Predict(misty, brock).loses_pokemon[0]);
+	ASSERT_EQUAL(TrainersBattle(misty, may), &may);
+	ASSERT_TRUE(predictor.Predict(misty, brock).loses_pokemon[0]);
+	ASSERT_TRUE(PredictBattle(misty, brock).loses_pokemon[0]);
+	ASSERT_EQUAL(predictor.Hits(), (size_t)0);
+	return true;
+}
+
+bool testBattlePredictorCapacity() {
+	Trainer ash = Trainer("ash", RED);
+	Trainer gary = Trainer("gary", YELLOW);
+	BattlePredictor predictor(2);
+	predictor.Predict(ash, gary);
+	predictor.Predict(gary, ash);
+	ASSERT_EQUAL(predictor.Size(), (size_t)2);
+
+	// a full cache is emptied before adding
+	ASSERT_TRUE(ash.AddItem(new Candy(1)));
+	predictor.Predict(ash, gary);
+	ASSERT_EQUAL(predictor.Size(), (size_t)1);
+	predictor.Predict(ash, gary);
+	ASSERT_EQUAL(predictor.Hits(), (size_t)1);
+	predictor.Clear();
+	ASSERT_EQUAL(predictor.Size(), (size_t)0);
+	return true;
+}
@@ -0,0 +1,133 @@
+#include "../checkpoint.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "test_utils.h"
+#include "../exceptions.h"
+#include "../pokemon_go.h"
+
+using namespace mtm::pokemongo;
+using namespace std;
+
+static const char* CHECKPOINT_PATH = "checkpoint_test.checkpoint";
+
+static const char* LOCATION_NAMES[] = {
+	"taub", "mikhlol", "shani", "dorms", "ulman", "aroma",
+};
+
+static World* CreateCampusWorld() {
+	World* world = CreateWorld({
+		"GYM taub",
+		"POKESTOP mikhlol POTION 10 CANDY 2 CANDY 13 POTION 1 CANDY 1",
+		"STARBUCKS shani pikachu 2.5 3 squirtle 1 2 charmander 3.45 4"
+			" mew 7 1 bulbasaur 1.5 1",
+		"GYM dorms",
+		"POKESTOP ulman CANDY 1 CANDY 1 POTION 1",
+		"STARBUCKS aroma pikachu 5 1 pidgey 1 1 psyduck 2 2",
+	});
+	world->Connect("taub", "mikhlol", EAST, WEST);
+	world->Connect("mikhlol", "shani", EAST, WEST);
+	world->Connect("shani", "dorms", SOUTH, NORTH);
+	world->Connect("dorms", "ulman", WEST, EAST);
+	world->Connect("ulman", "aroma", WEST, EAST);
+	world->Connect("aroma", "taub", NORTH, SOUTH);
+	world->Connect("dorms", SOUTH);
+	return world;
+}
+
+// Walks a few trainers around the loop, so every location changes
+static void Play(PokemonGo& game, int rounds) {
+	const char* names[] = { "ash", "misty", "brock", "gary", "may" };
+	const Direction route[] = { EAST, EAST, SOUTH, WEST, WEST, NORTH };
+	for (int round = 0; round < rounds; round++) {
+		for (int i = 0; i < 5; i++) {
+			string where = game.WhereIs(names[i]);
+			for (int step = 0; step < 6; step++) {
+				if (where == LOCATION_NAMES[step]) {
+					game.MoveTrainer(names[i], route[step]);
+					break;
+				}
+			}
+		}
+	}
+}
+
+static PokemonGo* CreateGame() {
+	PokemonGo* game = new PokemonGo(CreateCampusWorld());
+	game->AddTrainer("ash", YELLOW, "taub");
+	game->AddTrainer("misty", RED, "shani");
+	game->AddTrainer("brock", BLUE, "aroma");
+	game->AddTrainer("gary", RED, "mikhlol");
+	game->AddTrainer("may", YELLOW, "ulman");
+	Play(*game, 4);
+	return game;
+}
+
+static string DumpCampusGame(PokemonGo& game) {
+	return DumpGame(game, vector<string>(begin(LOCATION_NAMES),
+										 end(LOCATION_NAMES)));
+}
+
+bool testCheckpointRestore() {
+	PokemonGo* game = CreateGame();
+	Checkpoint checkpoint;
+	checkpoint.Save(*game, CHECKPOINT_PATH);
+	// The game may go on while the checkpoint is written
+	string saved_state = DumpCampusGame(*game);
+	Play(*game, 1);
+	checkpoint.Wait();
+
+	PokemonGo* restored = Checkpoint::Restore(CHECKPOINT_PATH);
+	ASSERT_EQUAL(DumpCampusGame(*restored), saved_state);
+	ASSERT_EQUAL(restored->WhereIs("ash"), "ulman");
+
+	// The restored game goes on exactly as the original did
+	PokemonGo* original = CreateGame();
+	Play(*original, 7);
+	Play(*restored, 7);
+	ASSERT_EQUAL(DumpCampusGame(*restored), DumpCampusGame(*original));
+	ASSERT_EQUAL(restored->TryMoveTrainer("ash", WEST),
+				 POKEMONGO_REACHED_DEAD_END);
+
+	delete original;
+	delete restored;
+	delete game;
+	std::remove(CHECKPOINT_PATH);
+	return true;
+}
+
+bool testCheckpointSelfLoopAndEmptyGame() {
+	PokemonGo empty(CreateCampusWorld());
+	string state;
+	Checkpoint::Capture(empty, state);
+	PokemonGo* restored = Checkpoint::Decode(state);
+	ASSERT_TRUE(restored->GetTrainersIn("taub").empty());
+	restored->AddTrainer("ash", RED, "dorms");
+	restored->MoveTrainer("ash", SOUTH);
+	ASSERT_EQUAL(restored->WhereIs("ash"), "dorms");
+	restored->MoveTrainer("ash", NORTH);
+	ASSERT_EQUAL(restored->WhereIs("ash"), "shani");
+	delete restored;
+	return true;
+}
+
+bool testCheckpointCorrupted() {
+	PokemonGo* game = CreateGame();
+	string state;
+	Checkpoint::Capture(*game, state);
+	delete game;
+
+	ASSERT_THROW(CheckpointCorruptedException,
+				 Checkpoint::Decode(state.substr(0, state.size() - 1)));
+	ASSERT_THROW(CheckpointCorruptedException,
+				 Checkpoint::Decode(state + "x"));
+	ASSERT_THROW(CheckpointCorruptedException,
+				 Checkpoint::Decode("GYM taub"));
+	ASSERT_THROW(CheckpointOpenFailedException,
+				 Checkpoint::Restore("no_such_checkpoint"));
+	return true;
+}
@@ -0,0 +1,265 @@
+#include "../command_ingestion.h"
+
+#include <atomic>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../journal.h"
+#include "../pokemon_go.h"
+#include "../tick_executor.h"
+#include "test_utils.h"
+
+using namespace mtm::pokemongo;
+
+static const char* JOURNAL_PATH = "command_ingestion_test.journal";
+
+bool testMpscRing() {
+	MpscRing<int> ring(3);
+	ASSERT_EQUAL(ring.Capacity(), (size_t)4);
+	int value = 0;
+	ASSERT_FALSE(ring.TryPop(&value));
+	for (int i = 0; i < 4; i++) {
+		int pushed = i;
+		size_t position = 0;
+		ASSERT_TRUE(ring.TryPush(std::move(pushed), &position));
+		ASSERT_EQUAL(position, (size_t)i);
+	}
+	int extra = 4;
+	ASSERT_FALSE(ring.TryPush(std::move(extra)));
+	ASSERT_TRUE(ring.TryPop(&value));
+	ASSERT_EQUAL(value, 0);
+	ASSERT_TRUE(ring.TryPush(std::move(extra)));
+
+	// the consumer sees the values of every producer in the order it pushed
+	// them, and the positions order all of them
+	MpscRing<std::pair<int, int> > shared(64);
+	const int PRODUCERS_NUM = 4;
+	const int VALUES_NUM = 20000;
+	std::vector<std::vector<size_t> > positions(PRODUCERS_NUM);
+	std::vector<std::thread> producers;
+	for (int producer = 0; producer < PRODUCERS_NUM; producer++) {
+		producers.push_back(std::thread([&shared, &positions, producer] {
+			for (int i = 0; i < VALUES_NUM; i++) {
+				std::pair<int, int> pushed(producer, i);
+				size_t position = 0;
+				while (!shared.TryPush(std::move(pushed), &position)) {}
+				positions[producer].push_back(position);
+			}
+		}));
+	}
+	std::vector<int> next(PRODUCERS_NUM, 0);
+	bool in_order = true;
+	for (int popped = 0; popped < PRODUCERS_NUM * VALUES_NUM; ) {
+		std::pair<int, int> pair;
+		if (!shared.TryPop(&pair)) continue;
+		if (pair.second != next[pair.first]++) in_order = false;
+		popped++;
+	}
+	for (std::thread& producer : producers) {
+		producer.join();
+	}
+	ASSERT_TRUE(in_order);
+	std::vector<bool> seen(PRODUCERS_NUM * VALUES_NUM, false);
+	for (const std::vector<size_t>& producer_positions : positions) {
+		for (size_t i = 0; i < producer_positions.size(); i++) {
+			ASSERT_TRUE(i == 0 ||
+						producer_positions[i] > producer_positions[i - 1]);
+			ASSERT_FALSE(seen[producer_positions[i]]);
+			seen[producer_positions[i]] = true;
+		}
+	}
+	return true;
+}
+
+// Builds the small world, recording its locations and edges in journal
+static World* CreateSmallWorld(Journal& journal) {
+	journal.RecordLocation("GYM a");
+	journal.RecordLocation("GYM b");
+	journal.RecordLocation("POKESTOP c CANDY 1");
+	journal.RecordConnect("a", "b", EAST, WEST);
+	journal.RecordConnect("b", "c", NORTH, SOUTH);
+	return CreateSmallWorld();
+}
+
+bool testCommandIngestion() {
+	PokemonGo game(CreateSmallWorld());
+	TickExecutor executor(game, 2);
+	CommandIngestion ingestion(executor, 4, 16);
+	CommandProducer first(ingestion, 2);
+	CommandProducer second(ingestion, 4);
+	unsigned long long sequence_number = 0;
+	ASSERT_EQUAL(ingestion.Drain(), (size_t)0);
+
+	ASSERT_TRUE(first.TrySubmit(GameCommand::AddTrainer("ash", RED, "a"),
+								&sequence_number));
+	ASSERT_EQUAL(sequence_number, 0ULL);
+	ASSERT_TRUE(second.TrySubmit(GameCommand::AddTrainer("ash", RED, "b"),
+								 &sequence_number));
+	ASSERT_EQUAL(sequence_number, 1ULL);
+	ASSERT_TRUE(first.TrySubmit(GameCommand::MoveTrainer("ash", EAST),
+								&sequence_number));
+	// too many commands in flight
+	ASSERT_FALSE(first.TrySubmit(GameCommand::MoveTrainer("ash", EAST),
+								 NULL));
+	ASSERT_EQUAL(first.InFlight(), (size_t)2);
+	ASSERT_TRUE(second.TrySubmit(GameCommand::MoveTrainer("ash", NORTH),
+								 NULL));
+	// the queue is full
+	ASSERT_FALSE(second.TrySubmit(GameCommand::MoveTrainer("ash", NORTH),
+								  NULL));
+	CommandCompletion completion;
+	ASSERT_FALSE(first.TryPollCompletion(&completion));
+
+	ASSERT_EQUAL(ingestion.Drain(), (size_t)4);
+	ASSERT_EQUAL(ingestion.Applied(), 4ULL);
+	ASSERT_EQUAL(game.WhereIs("ash"), std::string("c"));
+	ASSERT_TRUE(first.TryPollCompletion(&completion));
+	ASSERT_EQUAL(completion.sequence_number, 0ULL);
+	ASSERT_EQUAL(completion.status, POKEMONGO_SUCCESS);
+	ASSERT_TRUE(first.TryPollCompletion(&completion));
+	ASSERT_EQUAL(completion.sequence_number, 2ULL);
+	ASSERT_EQUAL(completion.status, POKEMONGO_SUCCESS);
+	ASSERT_FALSE(first.TryPollCompletion(&completion));
+	ASSERT_EQUAL(first.InFlight(), (size_t)0);
+	ASSERT_TRUE(second.TryPollCompletion(&completion));
+	ASSERT_EQUAL(completion.sequence_number, 1ULL);
+	ASSERT_EQUAL(completion.status, POKEMONGO_TRAINER_NAME_ALREADY_USED);
+	ASSERT_TRUE(second.TryPollCompletion(&completion));
+	ASSERT_EQUAL(completion.sequence_number, 3ULL);
+	ASSERT_EQUAL(completion.status, POKEMONGO_SUCCESS);
+
+	// commands the engine submitted itself run first, and keep their results
+	executor.Submit(GameCommand::MoveTrainer("misty", SOUTH));
+	ASSERT_TRUE(second.TrySubmit(GameCommand::MoveTrainer("ash", SOUTH),
+								 NULL));
+	ASSERT_EQUAL(ingestion.Drain(), (size_t)1);
+	ASSERT_TRUE(second.TryPollCompletion(&completion));
+	ASSERT_EQUAL(completion.sequence_number, 4ULL);
+	ASSERT_EQUAL(completion.status, POKEMONGO_SUCCESS);
+	ASSERT_EQUAL(game.WhereIs("ash"), std::string("b"));
+	return true;
+}
+
+// A location which throws when a trainer arrives
+class TrapLocation : public Location {
+public:
+	LocationType Type() const override {
+		return LOCATION_GYM;
+	}
+
+	LocationStatus TryArrive(Trainer&) override {
+		throw std::runtime_error("trapped");
+	}
+};
+
+bool testCommandIngestionFailedTick() {
+	World* world = CreateSmallWorld();
+	Location*& trap = (*world)["c"];
+	delete trap;
+	trap = new TrapLocation();
+	PokemonGo game(world);
+	TickExecutor executor(game, 2);
+	CommandIngestion ingestion(executor, 4, 16);
+	CommandProducer producer(ingestion, 4);
+	ASSERT_TRUE(producer.TrySubmit(GameCommand::AddTrainer("ash", RED, "a"),
+								   NULL));
+	ASSERT_TRUE(producer.TrySubmit(GameCommand::AddTrainer("gary", RED, "c"),
+								   NULL));
+	ASSERT_THROW(std::runtime_error, ingestion.Drain());
+
+	// every command of the failed tick completes, and none is run again
+	CommandCompletion completion;
+	for (unsigned long long i = 0; i < 2; i++) {
+		ASSERT_TRUE(producer.TryPollCompletion(&completion));
+		ASSERT_EQUAL(completion.sequence_number, i);
+		ASSERT_EQUAL(completion.status, POKEMONGO_TICK_FAILED);
+	}
+	ASSERT_EQUAL(producer.InFlight(), (size_t)0);
+	ASSERT_EQUAL(ingestion.Applied(), 2ULL);
+	ASSERT_TRUE(producer.TrySubmit(GameCommand::AddTrainer("brock", RED, "b"),
+								   NULL));
+	ASSERT_EQUAL(ingestion.Drain(), (size_t)1);
+	ASSERT_TRUE(producer.TryPollCompletion(&completion));
+	ASSERT_EQUAL(completion.sequence_number, 2ULL);
+	ASSERT_EQUAL(completion.status, POKEMONGO_SUCCESS);
+	return true;
+}
+
+bool testCommandIngestionThreads() {
+	const int PRODUCERS_NUM = 4;
+	const int MOVES_NUM = 2000;
+	const Direction directions[] = {EAST, NORTH, SOUTH, WEST, WEST};
+	std::vector<std::vector<CommandCompletion> > completions(PRODUCERS_NUM);
+	std::vector<std::string> trainer_locations;
+	{
+		Journal journal(JOURNAL_PATH);
+		PokemonGo game(CreateSmallWorld(journal));
+		game.AttachJournal(&journal);
+		TickExecutor executor(game, 2);
+		CommandIngestion ingestion(executor, 64, 32);
+		std::atomic<int> finished(0);
+		std::vector<std::thread> producers;
+		for (int producer = 0; producer < PRODUCERS_NUM; producer++) {
+			producers.push_back(std::thread([&, producer] {
+				CommandProducer submitter(ingestion, 8);
+				std::string name = "trainer" + std::to_string(producer);
+				std::vector<CommandCompletion>& results =
+					completions[producer];
+				int submitted = 0;
+				while ((int)results.size() < MOVES_NUM + 1) {
+					CommandCompletion completion;
+					while (submitter.TryPollCompletion(&completion)) {
+						results.push_back(completion);
+					}
+					if (submitted == MOVES_NUM + 1) continue;
+					GameCommand command = submitted == 0 ?
+						GameCommand::AddTrainer(name, (Team)(producer % 3),
+												"b") :
+						GameCommand::MoveTrainer(name,
+												 directions[submitted % 5]);
+					if (submitter.TrySubmit(command, NULL)) submitted++;
+				}
+				finished++;
+			}));
+		}
+		while (finished < PRODUCERS_NUM) {
+			ingestion.Drain();
+		}
+		for (std::thread& producer : producers) {
+			producer.join();
+		}
+		ASSERT_EQUAL(ingestion.Applied(),
+					 (unsigned long long)PRODUCERS_NUM * (MOVES_NUM + 1));
+		for (int producer = 0; producer < PRODUCERS_NUM; producer++) {
+			trainer_locations.push_back(
+				game.WhereIs("trainer" + std::to_string(producer)));
+		}
+		game.AttachJournal(NULL);
+	}
+	for (const std::vector<CommandCompletion>& results : completions) {
+		ASSERT_EQUAL(results.size(), (size_t)MOVES_NUM + 1);
+		ASSERT_EQUAL(results[0].status, POKEMONGO_SUCCESS);
+		for (size_t i = 1; i < results.size(); i++) {
+			ASSERT_TRUE(results[i].sequence_number >
+						results[i - 1].sequence_number);
+		}
+	}
+
+	// the journal has the order the commands were applied in
+	JournalReader reader(JOURNAL_PATH);
+	JournalReplayStats stats;
+	PokemonGo* replayed = ReplayJournal(reader, &stats);
+	ASSERT_EQUAL(stats.commands,
+				 (unsigned long long)PRODUCERS_NUM * (MOVES_NUM + 1));
+	ASSERT_EQUAL(stats.mismatches, 0ULL);
+	for (int producer = 0; producer < PRODUCERS_NUM; producer++) {
+		ASSERT_EQUAL(replayed->WhereIs("trainer" + std::to_string(producer)),
+					 trainer_locations[producer]);
+	}
+	delete replayed;
+	std::remove(JOURNAL_PATH);
+	return true;
+}
@@ -0,0 +1,64 @@
+#include "../first_fit_index.h"
+
+#include <random>
+#include <vector>
+
+#include "test_utils.h"
+
+using namespace mtm::pokemongo;
+
+bool testFirstFitIndexFind() {
+	FirstFitIndex index;
+	ASSERT_EQUAL(index.FindFirst(100), FirstFitIndex::NOT_FOUND);
+	ASSERT_EQUAL(index.Add(5), (size_t)0);
+	ASSERT_EQUAL(index.Add(2), (size_t)1);
+	ASSERT_EQUAL(index.Add(7), (size_t)2);
+	ASSERT_EQUAL(index.Add(2), (size_t)3);
+	ASSERT_EQUAL(index.FindFirst(1), FirstFitIndex::NOT_FOUND);
+	ASSERT_EQUAL(index.FindFirst(2), 1);
+	ASSERT_EQUAL(index.FindFirst(10), 0);
+	index.Remove(1);
+	ASSERT_FALSE(index.Contains(1));
+	ASSERT_TRUE(index.Contains(3));
+	ASSERT_EQUAL(index.FindFirst(2), 3);
+	index.Remove(0);
+	ASSERT_EQUAL(index.FindFirst(10), 2);
+	ASSERT_EQUAL(index.Size(), (size_t)2);
+	index.Clear();
+	ASSERT_EQUAL(index.Size(), (size_t)0);
+	ASSERT_EQUAL(index.Add(1), (size_t)0);
+	return true;
+}
+
+// Finds the first value not above limit by scanning, like Pokestops used to
+static long ScanFirst(const std::vector<int>& values,
+					  const std::vector<bool>& removed, int limit) {
+	for (size_t i = 0; i < values.size(); i++) {
+		if (!removed[i] && values[i] <= limit) return (long)i;
+	}
+	return FirstFitIndex::NOT_FOUND;
+}
+
+bool testFirstFitIndexMatchesScan() {
+	std::mt19937 random(3);
+	FirstFitIndex index;
+	std::vector<int> values;
+	std::vector<bool> removed;
+	for (int step = 0; step < 20000; step++) {
+		if (random() % 3 == 0) {
+			int value = random() % 50;
+			ASSERT_EQUAL(index.Add(value), values.size());
+			values.push_back(value);
+			removed.push_back(false);
+			continue;
+		}
+		int limit = random() % 50;
+		long expected = ScanFirst(values, removed, limit);
+		ASSERT_EQUAL(index.FindFirst(limit), expected);
+		if (expected != FirstFitIndex::NOT_FOUND) {
+			index.Remove(expected);
+			removed[expected] = true;
+		}
+	}
+	return true;
+}
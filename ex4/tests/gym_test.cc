@@ -2,8 +2,10 @@
 #include "../trainer.h"
 #include "../gym.h"
 #include "../exceptions.h"
+#include <random>
 #include <string>
 #include <set>
+#include <vector>
 
 using namespace mtm::pokemongo;
 
@@ -99,3 +101,136 @@ bool testGymLeave() {
 
 	return true;
 }
+
+bool testGymSuccession() {
+	std::set<PokemonType> types;
+	types.insert(NORMAL);
+	Pokemon weak("magikarp", types, 1, 1);
+	Pokemon strong("pikachu", types, 10, 1);
+	Trainer first("ash", BLUE);
+	Trainer strong_1("misty", BLUE);
+	Trainer strong_2("brock", BLUE);
+	Trainer last("may", BLUE);
+	first.TryToCatch(weak);
+	strong_1.TryToCatch(strong);
+	strong_2.TryToCatch(strong);
+	Gym gym;
+	ASSERT_NO_THROW(gym.Arrive(first));
+	ASSERT_NO_THROW(gym.Arrive(strong_1));
+	ASSERT_NO_THROW(gym.Arrive(last));
+	ASSERT_NO_THROW(gym.Arrive(strong_2));
+	ASSERT_TRUE(first.is_leader);
+
+	// the strongest of the team takes over, the earliest arrival on ties
+	ASSERT_NO_THROW(gym.Leave(first));
+	ASSERT_TRUE(strong_1.is_leader);
+	ASSERT_NO_THROW(gym.Leave(strong_1));
+	ASSERT_TRUE(strong_2.is_leader);
+
+	// a trainer who comes back is a later arrival
+	ASSERT_NO_THROW(gym.Arrive(strong_1));
+	ASSERT_NO_THROW(gym.Leave(strong_2));
+	ASSERT_TRUE(strong_1.is_leader);
+	ASSERT_FALSE(strong_2.is_leader);
+	ASSERT_NO_THROW(gym.Leave(strong_1));
+	ASSERT_TRUE(last.is_leader);
+
+	return true;
+}
+
+bool testGymSuccessionAfterCatch() {
+	std::set<PokemonType> types;
+	types.insert(NORMAL);
+	Trainer blue_1("ash", BLUE);
+	Trainer blue_2("misty", BLUE);
+	Trainer blue_3("brock", BLUE);
+	Gym gym;
+	ASSERT_NO_THROW(gym.Arrive(blue_1));
+	ASSERT_NO_THROW(gym.Arrive(blue_2));
+	ASSERT_NO_THROW(gym.Arrive(blue_3));
+
+	// a trainer who gets stronger in the gym is a stronger candidate
+	Trainer* brock = gym.GetTrainers()[2];
+	ASSERT_TRUE(brock->TryToCatch(Pokemon("pikachu", types, 10, 1)));
+	ASSERT_NO_THROW(gym.Leave(blue_1));
+	ASSERT_TRUE(blue_3.is_leader);
+	ASSERT_FALSE(blue_2.is_leader);
+
+	// and one who gets weaker is a weaker one
+	ASSERT_TRUE(blue_2.TryToCatch(Pokemon("pikachu", types, 5, 1)));
+	blue_3.KillStrongestPokemon();
+	ASSERT_NO_THROW(gym.Leave(blue_3));
+	ASSERT_TRUE(blue_2.is_leader);
+	return true;
+}
+
+// Finds the strongest trainer of a team in the gym, the way the exercise
+// sheet describes it
+static Trainer* StrongestOfTeam(Gym& gym, Team team, Trainer* except) {
+	Trainer* strongest = NULL;
+	for (Trainer* trainer : gym.GetTrainers()) {
+		if (trainer == except || trainer->GetTeam() != team) continue;
+		if (strongest == NULL || *trainer > *strongest) strongest = trainer;
+	}
+	return strongest;
+}
+
+bool testGymSuccessionAfterBattles() {
+	std::mt19937 random(7);
+	std::vector<Trainer> trainers;
+	for (int i = 0; i < 40; i++) {
+		trainers.push_back(Trainer("trainer_" + std::to_string(i),
+								   (Team)(i % 3)));
+	}
+	for (Trainer& trainer : trainers) {
+		for (int i = random() % 4; i > 0; i--) {
+			Pokemon pokemon("pikachu", 1 + random() % 150, 1);
+			trainer.TryToCatch(pokemon);
+		}
+		if (random() % 2) trainer.AddItem(new Candy(1));
+	}
+	Gym gym;
+	std::vector<bool> inside(trainers.size(), false);
+	for (int step = 0; step < 2000; step++) {
+		size_t index = random() % trainers.size();
+		Trainer& trainer = trainers[index];
+		if (!inside[index]) {
+			ASSERT_NO_THROW(gym.Arrive(trainer));
+			inside[index] = true;
+			continue;
+		}
+		Trainer* successor = NULL;
+		if (trainer.is_leader) {
+			successor = StrongestOfTeam(gym, trainer.GetTeam(), &trainer);
+		}
+		ASSERT_NO_THROW(gym.Leave(trainer));
+		inside[index] = false;
+		if (successor != NULL) ASSERT_TRUE(successor->is_leader);
+	}
+	return true;
+}
+
+bool testGymTournament() {
+	std::set<PokemonType> types;
+	types.insert(NORMAL);
+	Trainer ash("ash", BLUE);
+	Trainer gary("gary", RED);
+	ash.TryToCatch(Pokemon("pikachu", types, 10, 1));
+	gary.TryToCatch(Pokemon("pikachu", types, 20, 1));
+	Gym gym;
+	gym.Arrive(gary);
+	gym.Arrive(ash);
+	int level = gary.Level();
+	ThreadPool pool(2);
+	TournamentResults results = gym.RunTournament(TOURNAMENT_ROUND_ROBIN,
+												  pool);
+
+	// entrants are in arrival order, and the gym didn't change
+	ASSERT_EQUAL(results.entrants[0], &gary);
+	ASSERT_EQUAL(results.matches.size(), (size_t)1);
+	ASSERT_EQUAL(results.matches[0].winner, 0);
+	ASSERT_EQUAL(results.standings[0].trainer, (size_t)0);
+	ASSERT_EQUAL(gary.Level(), level);
+	ASSERT_TRUE(gary.is_leader);
+	return true;
+}
@@ -1,6 +1,9 @@
 #include "../item.h"
+#include "../ring_queue.h"
 #include "test_utils.h"
 
+#include <utility>
+
 static const double INIT_CP = 4.5;
 static const int INIT_HP = 4;
 
@@ -29,3 +32,41 @@ bool testPotion() {
 	ASSERT_NO_THROW(potion.Use(pokemon));
 	return true;
 }
+
+bool testItemValue() {
+	ASSERT_THROW(ItemInvalidArgException, ItemValue(ITEM_CANDY, -1));
+	ASSERT_TRUE(sizeof(ItemValue) <= 8);
+
+	// Values use items the same way the item classes do
+	Pokemon pokemon("pikachu", INIT_CP, INIT_HP);
+	Pokemon same_pokemon("pikachu", INIT_CP, INIT_HP);
+	Candy candy(4);
+	ItemValue candy_value = candy.Value();
+	ASSERT_EQUAL(candy_value.Kind(), ITEM_CANDY);
+	ASSERT_EQUAL(candy_value.Level(), 4);
+	candy.Use(pokemon);
+	candy_value.Use(same_pokemon);
+	ASSERT_TRUE(pokemon == same_pokemon);
+	ASSERT_EQUAL(Potion(2).Value().Kind(), ITEM_POTION);
+
+	// Items stay in order as the queue wraps around and grows
+	RingQueue<ItemValue> items;
+	int next_in = 0, next_out = 0;
+	for (int round = 0; round < 50; round++) {
+		for (int i = 0; i < round % 7 + 1; i++) {
+			items.PushBack(ItemValue(ITEM_POTION, next_in++));
+		}
+		for (int i = 0; i < round % 5 + 1 && !items.Empty(); i++) {
+			ASSERT_EQUAL(items.Front().Level(), next_out++);
+			items.PopFront();
+		}
+		ASSERT_EQUAL(items.Size(), (size_t)(next_in - next_out));
+		for (size_t i = 0; i < items.Size(); i++) {
+			ASSERT_EQUAL(items[i].Level(), next_out + (int)i);
+		}
+	}
+	RingQueue<ItemValue> moved = std::move(items);
+	ASSERT_TRUE(items.Empty());
+	ASSERT_EQUAL(moved.Size(), (size_t)(next_in - next_out));
+	return true;
+}
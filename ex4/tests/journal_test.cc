@@ -0,0 +1,170 @@
+#include "../journal.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+
+#include "test_utils.h"
+#include "../exceptions.h"
+#include "../pokemon_go.h"
+
+using namespace mtm::pokemongo;
+using namespace std;
+
+static const char* JOURNAL_PATH = "journal_test.journal";
+
+static const char* WORLD_LINES[] = {
+	"GYM taub",
+	"GYM dorms",
+	"POKESTOP mikhlol POTION 10 CANDY 20 CANDY 13",
+	"STARBUCKS shani pikachu 2.5 3 squirtle 1 2 charmander 3.45 4",
+};
+
+// Builds a small world, recording it in the journal
+static World* CreateRecordedWorld(Journal& journal) {
+	World* world = new World();
+	for (const char* line : WORLD_LINES) {
+		istringstream line_stream(line);
+		line_stream >> *world;
+		journal.RecordLocation(line);
+	}
+	world->Connect("taub", "mikhlol", EAST, WEST);
+	journal.RecordConnect("taub", "mikhlol", EAST, WEST);
+	world->Connect("mikhlol", "shani", NORTH, SOUTH);
+	journal.RecordConnect("mikhlol", "shani", NORTH, SOUTH);
+	world->Connect("shani", "dorms", EAST, WEST);
+	journal.RecordConnect("shani", "dorms", EAST, WEST);
+	world->Connect("dorms", SOUTH);
+	journal.RecordConnect("dorms", "dorms", SOUTH, 0);
+	return world;
+}
+
+static string ReadFile(const char* path) {
+	ifstream input(path, ios::binary);
+	return string(istreambuf_iterator<char>(input),
+				  istreambuf_iterator<char>());
+}
+
+static void WriteFile(const char* path, const string& data) {
+	ofstream output(path, ios::binary | ios::trunc);
+	output << data;
+}
+
+bool testJournalRoundTrip() {
+	{
+		Journal journal(JOURNAL_PATH);
+		journal.RecordLocation("GYM taub");
+		journal.RecordConnect("taub", "dorms", EAST, WEST);
+		journal.RecordAddTrainer("ash", RED, "taub", POKEMONGO_SUCCESS);
+		journal.RecordMoveTrainer("ash", -1, POKEMONGO_INVALID_DIRECTION);
+		journal.RecordCommand(GameCommand::MoveTrainer("gary", SOUTH),
+							  POKEMONGO_TRAINER_NOT_FOUND);
+		ASSERT_EQUAL(journal.RecordsNum(), 5);
+		journal.Flush();
+	}
+
+	JournalReader reader(JOURNAL_PATH);
+	JournalRecord record;
+	ASSERT_TRUE(reader.Next(&record));
+	ASSERT_EQUAL(record.type, JOURNAL_LOCATION);
+	ASSERT_EQUAL(record.sequence_number, 0);
+	ASSERT_EQUAL(record.line, "GYM taub");
+
+	ASSERT_TRUE(reader.Next(&record));
+	ASSERT_EQUAL(record.type, JOURNAL_CONNECT);
+	ASSERT_EQUAL(record.sequence_number, 1);
+	ASSERT_EQUAL(record.from, "taub");
+	ASSERT_EQUAL(record.to, "dorms");
+	ASSERT_EQUAL(record.from_direction, EAST);
+	ASSERT_EQUAL(record.to_direction, WEST);
+
+	ASSERT_TRUE(reader.Next(&record));
+	ASSERT_EQUAL(record.type, JOURNAL_COMMAND);
+	ASSERT_EQUAL(record.command.type, ADD_TRAINER);
+	ASSERT_EQUAL(record.command.trainer_name, "ash");
+	ASSERT_EQUAL(record.command.team, RED);
+	ASSERT_EQUAL(record.command.location, "taub");
+	ASSERT_EQUAL(record.status, POKEMONGO_SUCCESS);
+
+	ASSERT_TRUE(reader.Next(&record));
+	ASSERT_EQUAL(record.command.type, MOVE_TRAINER);
+	ASSERT_EQUAL(record.command.direction, -1);
+	ASSERT_EQUAL(record.status, POKEMONGO_INVALID_DIRECTION);
+
+	ASSERT_TRUE(reader.Next(&record));
+	ASSERT_EQUAL(record.sequence_number, 4);
+	ASSERT_EQUAL(record.command.trainer_name, "gary");
+	ASSERT_EQUAL(record.command.direction, SOUTH);
+	ASSERT_EQUAL(record.status, POKEMONGO_TRAINER_NOT_FOUND);
+
+	ASSERT_FALSE(reader.Next(&record));
+	ASSERT_FALSE(reader.Truncated());
+	std::remove(JOURNAL_PATH);
+	return true;
+}
+
+bool testJournalReplay() {
+	Journal* journal = new Journal(JOURNAL_PATH);
+	PokemonGo game(CreateRecordedWorld(*journal));
+	game.AttachJournal(journal);
+	game.AddTrainer("ash", YELLOW, "taub");
+	game.AddTrainer("misty", RED, "shani");
+	ASSERT_THROW(PokemonGoTrainerNameAlreadyUsedExcpetion,
+				 game.AddTrainer("ash", BLUE, "dorms"));
+	game.MoveTrainer("ash", EAST);
+	game.MoveTrainer("ash", NORTH);
+	game.MoveTrainer("misty", EAST);
+	game.MoveTrainer("misty", SOUTH);
+	ASSERT_EQUAL(game.TryMoveTrainer("misty", NORTH),
+				 POKEMONGO_REACHED_DEAD_END);
+	ASSERT_EQUAL(game.TryApply(GameCommand::AddTrainer("brock", BLUE,
+													   "dorms")),
+				 POKEMONGO_SUCCESS);
+	int scores[] = { game.GetScore(BLUE), game.GetScore(YELLOW),
+					 game.GetScore(RED) };
+	game.AttachJournal(NULL);
+	// Not recorded
+	game.MoveTrainer("ash", EAST);
+	delete journal;
+
+	JournalReader reader(JOURNAL_PATH);
+	JournalReplayStats stats;
+	PokemonGo* replayed = ReplayJournal(reader, &stats);
+	ASSERT_EQUAL(stats.records, 17);
+	ASSERT_EQUAL(stats.commands, 9);
+	ASSERT_EQUAL(stats.mismatches, 0);
+	ASSERT_EQUAL(replayed->WhereIs("ash"), "shani");
+	ASSERT_EQUAL(replayed->WhereIs("misty"), "dorms");
+	ASSERT_EQUAL(replayed->GetTrainersIn("dorms").size(), 2);
+	ASSERT_EQUAL(replayed->GetScore(BLUE), scores[BLUE]);
+	ASSERT_EQUAL(replayed->GetScore(YELLOW), scores[YELLOW]);
+	ASSERT_EQUAL(replayed->GetScore(RED), scores[RED]);
+	delete replayed;
+	std::remove(JOURNAL_PATH);
+	return true;
+}
+
+bool testJournalCorrupted() {
+	{
+		Journal journal(JOURNAL_PATH);
+		journal.RecordLocation("GYM taub");
+		journal.RecordAddTrainer("ash", RED, "taub", POKEMONGO_SUCCESS);
+	}
+	string data = ReadFile(JOURNAL_PATH);
+
+	// A crash in the middle of a record loses only that record
+	WriteFile(JOURNAL_PATH, data.substr(0, data.size() - 3));
+	JournalReader reader(JOURNAL_PATH);
+	JournalRecord record;
+	ASSERT_TRUE(reader.Next(&record));
+	ASSERT_FALSE(reader.Next(&record));
+	ASSERT_TRUE(reader.Truncated());
+
+	WriteFile(JOURNAL_PATH, "GYM taub\n");
+	ASSERT_THROW(JournalCorruptedException, JournalReader(JOURNAL_PATH));
+	std::remove(JOURNAL_PATH);
+	ASSERT_THROW(JournalOpenFailedException, JournalReader(JOURNAL_PATH));
+	return true;
+}
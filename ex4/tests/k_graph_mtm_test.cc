@@ -175,6 +175,48 @@ bool testKGraphDisconnect() {
 	return true;
 }
 
+bool testKGraphTryFunctions() {
+	CREATE_GRAPH();
+	string neighbor;
+	string value;
+
+	// insert and remove
+	ASSERT_EQUAL(graph.TryInsert("cpp", "again"), KGRAPH_KEY_ALREADY_EXISTS);
+	ASSERT_EQUAL(graph.TryInsert("rust", "new"), KGRAPH_SUCCESS);
+	ASSERT_EQUAL(graph.TryGet("rust", &value), KGRAPH_SUCCESS);
+	ASSERT_EQUAL(value, "new");
+	ASSERT_EQUAL(graph.TryRemove("rust"), KGRAPH_SUCCESS);
+	ASSERT_EQUAL(graph.TryRemove("rust"), KGRAPH_KEY_NOT_FOUND);
+	ASSERT_EQUAL(graph.TryGet("rust", &value), KGRAPH_KEY_NOT_FOUND);
+
+	// move
+	ASSERT_EQUAL(graph.TryMove("c", 1, &neighbor), KGRAPH_KEY_NOT_FOUND);
+	ASSERT_EQUAL(graph.TryMove("cpp", 10, &neighbor),
+				 KGRAPH_EDGE_OUT_OF_RANGE);
+	ASSERT_EQUAL(graph.TryMove("cpp", 3, &neighbor),
+				 KGRAPH_ITERATOR_REACHED_END);
+	ASSERT_EQUAL(graph.TryMove("cpp", 1, &neighbor), KGRAPH_SUCCESS);
+	ASSERT_EQUAL(neighbor, "is");
+
+	// connect and disconnect
+	ASSERT_EQUAL(graph.TryConnect("cpp", "is", 2, 2),
+				 KGRAPH_NODES_ALREADY_CONNECTED);
+	ASSERT_EQUAL(graph.TryConnect("d language", "is", 3, 0),
+				 KGRAPH_EDGE_ALREADY_IN_USE);
+	ASSERT_EQUAL(graph.TryConnect("d language", "is", 3, 5),
+				 KGRAPH_EDGE_OUT_OF_RANGE);
+	ASSERT_EQUAL(graph.TryConnect("d language", 2), KGRAPH_SUCCESS);
+	ASSERT_EQUAL(graph.TryConnect("d language", 3),
+				 KGRAPH_NODES_ALREADY_CONNECTED);
+	ASSERT_EQUAL(graph.TryDisconnect("d language", "is"),
+				 KGRAPH_NODES_ARE_NOT_CONNECTED);
+	ASSERT_EQUAL(graph.TryDisconnect("cpp", "is"), KGRAPH_SUCCESS);
+	ASSERT_EQUAL(graph.TryMove("cpp", 1, &neighbor),
+				 KGRAPH_ITERATOR_REACHED_END);
+
+	return true;
+}
+
 bool testIteratorMove() {
 	CREATE_GRAPH();
 	KGraph<string, string, 5>::iterator it = graph.BeginAt("cpp");
@@ -283,3 +325,18 @@ bool testKGraphCopyCtor() {
 
 	return true;
 }
+
+bool testKGraphMemory() {
+	using mtm::pokemongo::MemoryAccounting;
+	using mtm::pokemongo::MEMORY_GRAPH_NODES;
+	long long before =
+		MemoryAccounting::Snapshot().categories[MEMORY_GRAPH_NODES].bytes;
+	{
+		CREATE_GRAPH();
+		ASSERT_TRUE(MemoryAccounting::Snapshot().
+					categories[MEMORY_GRAPH_NODES].bytes > before);
+	}
+	ASSERT_EQUAL(MemoryAccounting::Snapshot().
+				 categories[MEMORY_GRAPH_NODES].bytes, before);
+	return true;
+}
@@ -0,0 +1,147 @@
+#include "../leaderboard.h"
+
+#include <algorithm>
+#include <random>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../pokemon_go.h"
+#include "test_utils.h"
+
+using namespace mtm::pokemongo;
+
+bool testRankTree() {
+	std::mt19937 random(43);
+	RankTree<int> tree;
+	std::set<int> expected;
+	for (int i = 0; i < 3000; i++) {
+		int key = random() % 500;
+		if (random() % 3 == 0) {
+			ASSERT_EQUAL(tree.Erase(key), expected.erase(key) == 1);
+		} else if (expected.insert(key).second) {
+			tree.Insert(key);
+		}
+		ASSERT_EQUAL(tree.Size(), expected.size());
+		int probe = random() % 500;
+		ASSERT_EQUAL(tree.Rank(probe), (size_t)std::distance(
+			expected.begin(), expected.lower_bound(probe)));
+	}
+	std::vector<int> first = tree.First(10);
+	ASSERT_TRUE(std::equal(first.begin(), first.end(), expected.begin()));
+	ASSERT_EQUAL(tree.First(100000).size(), expected.size());
+	return true;
+}
+
+bool testLeaderboardUpdates() {
+	std::set<PokemonType> types;
+	types.insert(NORMAL);
+	Trainer ash("ash", YELLOW);
+	Trainer gary("gary", RED);
+	Trainer misty("misty", YELLOW);
+	ash.TryToCatch(Pokemon("pikachu", types, 10, 1));
+	Leaderboard board;
+	board.Add("ash", ash);
+	board.Add("gary", gary);
+	board.Add("misty", misty);
+
+	// equal scores are ordered by name
+	ASSERT_EQUAL(board.RankOf("ash"), (size_t)1);
+	ASSERT_EQUAL(board.RankOf("misty"), (size_t)3);
+	ASSERT_EQUAL(board.RankOf("brock"), (size_t)0);
+
+	// battles and leadership move trainers
+	TrainersBattle(gary, ash);
+	ASSERT_EQUAL(board.RankOf("ash"), (size_t)1);
+	ASSERT_EQUAL(board.RankOf("gary"), (size_t)3);
+	misty.SetLeader(true);
+	std::vector<LeaderboardEntry> top = board.TopK(2);
+	ASSERT_EQUAL(top.size(), (size_t)2);
+	ASSERT_EQUAL(top[0].name, "misty");
+	ASSERT_EQUAL(top[0].score, 11);
+	ASSERT_EQUAL(top[1].name, "ash");
+	ASSERT_EQUAL(top[1].score, ash.TotalScore());
+
+	// team boards
+	ASSERT_EQUAL(board.TeamRankOf("gary"), (size_t)1);
+	ASSERT_EQUAL(board.TeamRankOf("ash"), (size_t)2);
+	ASSERT_EQUAL(board.TopK(5, YELLOW).size(), (size_t)2);
+	ASSERT_EQUAL(board.TopK(5, BLUE).size(), (size_t)0);
+
+	// copies aren't on the board
+	Trainer copy = misty;
+	copy.SetLeader(false);
+	ASSERT_EQUAL(board.TopK(1)[0].name, "misty");
+
+	ASSERT_TRUE(board.Remove("misty"));
+	ASSERT_FALSE(board.Remove("misty"));
+	misty.SetLeader(false);
+	ASSERT_EQUAL(board.Size(), (size_t)2);
+	ASSERT_EQUAL(board.RankOf("ash"), (size_t)1);
+	return true;
+}
+
+// Returns the name of a trainer, as it prints it
+static std::string NameOf(const Trainer& trainer) {
+	std::ostringstream output;
+	output << trainer;
+	return output.str().substr(0, output.str().find(" ("));
+}
+
+bool testLeaderboardInGame() {
+	World* world = new World();
+	const char* lines[] = {"GYM haifa", "GYM ashdod",
+						   "STARBUCKS eilat pikachu 3.5 1 squirtle 4 2",
+						   "POKESTOP tel_aviv CANDY 1 POTION 1"};
+	for (const char* line : lines) {
+		std::istringstream line_stream(line);
+		line_stream >> *world;
+	}
+	world->Connect("haifa", "ashdod", NORTH, SOUTH);
+	world->Connect("ashdod", "eilat", NORTH, SOUTH);
+	world->Connect("eilat", "tel_aviv", NORTH, SOUTH);
+	PokemonGo game(world);
+	std::mt19937 random(430);
+	const Team teams[] = {BLUE, YELLOW, RED};
+	const char* locations[] = {"haifa", "ashdod", "eilat", "tel_aviv"};
+	std::vector<std::string> names;
+	for (int i = 0; i < 30; i++) {
+		names.push_back("trainer" + std::to_string(i));
+		game.AddTrainer(names.back(), teams[random() % 3],
+						locations[random() % 4]);
+	}
+	for (int i = 0; i < 300; i++) {
+		const std::string& name = names[random() % names.size()];
+		game.TryMoveTrainer(name, random() % 2 ? NORTH : SOUTH);
+	}
+
+	// compare with sorting all trainers from scratch
+	std::vector<LeaderboardEntry> expected;
+	for (const char* location : locations) {
+		for (Trainer* trainer : game.GetTrainersIn(location)) {
+			LeaderboardEntry entry = {NameOf(*trainer), trainer->GetTeam(),
+									  trainer->TotalScore()};
+			expected.push_back(entry);
+		}
+	}
+	std::sort(expected.begin(), expected.end(),
+			  [](const LeaderboardEntry& lhs, const LeaderboardEntry& rhs) {
+		if (lhs.score != rhs.score) return lhs.score > rhs.score;
+		return lhs.name < rhs.name;
+	});
+	std::vector<LeaderboardEntry> top = game.GetTopTrainers(names.size());
+	ASSERT_EQUAL(top.size(), expected.size());
+	for (size_t i = 0; i < top.size(); i++) {
+		ASSERT_EQUAL(top[i].name, expected[i].name);
+		ASSERT_EQUAL(top[i].score, expected[i].score);
+		ASSERT_EQUAL(game.GetRank(top[i].name), i + 1);
+	}
+	std::vector<LeaderboardEntry> red = game.GetTopTrainers(3, RED);
+	for (size_t i = 0; i < red.size(); i++) {
+		ASSERT_EQUAL(red[i].team, RED);
+		ASSERT_EQUAL(game.GetTeamRank(red[i].name), i + 1);
+	}
+	ASSERT_THROW(PokemonGoTrainerNotFoundExcpetion, game.GetRank("nobody"));
+	return true;
+}
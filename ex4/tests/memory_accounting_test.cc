@@ -0,0 +1,134 @@
+#include "../memory_accounting.h"
+
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "test_utils.h"
+#include "../pokemon_go.h"
+
+using namespace mtm::pokemongo;
+
+// Returns how much a category grew between two snapshots
+static MemoryUsage Grew(const MemorySnapshot& before,
+						const MemorySnapshot& after,
+						MemoryCategory category) {
+	MemoryUsage grew = {
+		after.categories[category].bytes - before.categories[category].bytes,
+		after.categories[category].objects -
+			before.categories[category].objects,
+		after.categories[category].peak_bytes -
+			before.categories[category].peak_bytes,
+	};
+	return grew;
+}
+
+bool testCountingAllocator() {
+	MemorySnapshot before = MemoryAccounting::Snapshot();
+	{
+		std::vector<int, CountingAllocator<int, MEMORY_ITEMS> > values;
+		values.reserve(100);
+		MemorySnapshot during = MemoryAccounting::Snapshot();
+		ASSERT_EQUAL(Grew(before, during, MEMORY_ITEMS).bytes,
+					 (long long)(100 * sizeof(int)));
+		ASSERT_EQUAL(Grew(before, during, MEMORY_ITEMS).objects, 1LL);
+		ASSERT_TRUE(during.categories[MEMORY_ITEMS].peak_bytes >=
+					during.categories[MEMORY_ITEMS].bytes);
+
+		// trainers are counted wherever they are
+		Trainer ash("ash", YELLOW);
+		Trainer copy = ash;
+		Trainer moved = std::move(copy);
+		during = MemoryAccounting::Snapshot();
+		ASSERT_EQUAL(Grew(before, during, MEMORY_TRAINERS).objects, 3LL);
+		ASSERT_EQUAL(Grew(before, during, MEMORY_TRAINERS).bytes,
+					 (long long)(3 * sizeof(Trainer)));
+	}
+	MemorySnapshot after = MemoryAccounting::Snapshot();
+	for (int category = 0; category < MEMORY_CATEGORIES_NUM; category++) {
+		ASSERT_EQUAL(Grew(before, after, (MemoryCategory)category).bytes, 0LL);
+		ASSERT_EQUAL(Grew(before, after, (MemoryCategory)category).objects,
+					 0LL);
+	}
+	return true;
+}
+
+bool testMemoryAcrossThreads() {
+	typedef std::vector<int, CountingAllocator<int, MEMORY_ITEMS> > Values;
+	MemorySnapshot before = MemoryAccounting::Snapshot();
+	const int THREADS_NUM = 4;
+	std::vector<Values> kept(THREADS_NUM);
+	std::vector<std::thread> threads;
+	for (int i = 0; i < THREADS_NUM; i++) {
+		threads.push_back(std::thread([&kept, i] {
+			for (int round = 0; round < 1000; round++) {
+				Values values(100 + round % 7);
+			}
+			kept[i].reserve(10000);
+		}));
+	}
+	for (std::thread& thread : threads) {
+		thread.join();
+	}
+
+	// the counts of exited threads are kept, and can be given back by others
+	MemorySnapshot during = MemoryAccounting::Snapshot();
+	ASSERT_EQUAL(Grew(before, during, MEMORY_ITEMS).bytes,
+				 (long long)(THREADS_NUM * 10000 * sizeof(int)));
+	ASSERT_EQUAL(Grew(before, during, MEMORY_ITEMS).objects,
+				 (long long)THREADS_NUM);
+	ASSERT_TRUE(during.categories[MEMORY_ITEMS].peak_bytes >=
+				during.categories[MEMORY_ITEMS].bytes);
+	kept.clear();
+	MemorySnapshot after = MemoryAccounting::Snapshot();
+	ASSERT_EQUAL(Grew(before, after, MEMORY_ITEMS).bytes, 0LL);
+	ASSERT_EQUAL(Grew(before, after, MEMORY_ITEMS).objects, 0LL);
+	return true;
+}
+
+bool testMemoryInGame() {
+	MemorySnapshot before = MemoryAccounting::Snapshot();
+	{
+		World* world = new World();
+		const char* lines[] = {"STARBUCKS shani pikachu 2.5 1 squirtle 3 2",
+							   "POKESTOP mikhlol CANDY 1 POTION 5",
+							   "GYM taub"};
+		for (const char* line : lines) {
+			std::istringstream line_stream(line);
+			line_stream >> *world;
+		}
+		world->Connect("shani", "mikhlol", EAST, WEST);
+		world->Connect("mikhlol", "taub", EAST, WEST);
+		PokemonGo game(world);
+		MemorySnapshot built = game.MemoryStats();
+		ASSERT_EQUAL(Grew(before, built, MEMORY_LOCATIONS).objects, 3LL);
+		ASSERT_EQUAL(Grew(before, built, MEMORY_GRAPH_NODES).objects, 3LL);
+		ASSERT_TRUE(Grew(before, built, MEMORY_POKEMONS).bytes > 0);
+		ASSERT_TRUE(Grew(before, built, MEMORY_ITEMS).bytes > 0);
+
+		game.AddTrainer("ash", YELLOW, "shani");
+		game.AddTrainer("gary", RED, "mikhlol");
+		game.MoveTrainer("gary", WEST);
+		MemorySnapshot played = game.MemoryStats();
+		ASSERT_EQUAL(Grew(built, played, MEMORY_TRAINERS).objects, 2LL);
+		// the first Pokemon moved from the shop to ash
+		ASSERT_TRUE(Grew(built, played, MEMORY_POKEMONS).objects > 0);
+
+		std::ostringstream dump;
+		played.WriteText(dump);
+		ASSERT_TRUE(dump.str().find("\ntrainers ") != std::string::npos);
+		ASSERT_TRUE(dump.str().find("\ntotal ") != std::string::npos);
+		MemoryUsage total = played.Total();
+		ASSERT_TRUE(total.bytes >= played.categories[MEMORY_TRAINERS].bytes +
+					played.categories[MEMORY_LOCATIONS].bytes);
+	}
+	// deleting the game gives everything back
+	MemorySnapshot after = MemoryAccounting::Snapshot();
+	for (int category = 0; category < MEMORY_CATEGORIES_NUM; category++) {
+		ASSERT_EQUAL(Grew(before, after, (MemoryCategory)category).bytes, 0LL);
+		ASSERT_EQUAL(Grew(before, after, (MemoryCategory)category).objects,
+					 0LL);
+	}
+	return true;
+}
@@ -0,0 +1,135 @@
+#include "../metrics.h"
+
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "test_utils.h"
+#include "../pokemon_go.h"
+
+using namespace mtm::pokemongo;
+using namespace std;
+
+static World* CreateCampusWorld() {
+	World* world = CreateWorld({
+		"STARBUCKS shani pikachu 2.5 1",
+		"POKESTOP mikhlol CANDY 1 POTION 5",
+		"GYM taub",
+	});
+	world->Connect("shani", "mikhlol", EAST, WEST);
+	world->Connect("mikhlol", "taub", EAST, WEST);
+	return world;
+}
+
+// Returns how much a counter grew between two snapshots
+static unsigned long long Grew(const MetricsSnapshot& before,
+							   const MetricsSnapshot& after,
+							   MetricCounter counter) {
+	return after.counters[counter] - before.counters[counter];
+}
+
+static unsigned long long Calls(const MetricsSnapshot& before,
+								const MetricsSnapshot& after,
+								MetricCall call) {
+	return after.calls[call].count - before.calls[call].count;
+}
+
+bool testMetricsCountEvents() {
+	PokemonGo game(CreateCampusWorld());
+	MetricsSnapshot before = game.Stats();
+
+	game.AddTrainer("ash", YELLOW, "shani");
+	game.MoveTrainer("ash", EAST);
+	game.MoveTrainer("ash", EAST);
+	game.AddTrainer("misty", RED, "taub");
+	// ash leaves the gym, misty takes over
+	game.MoveTrainer("ash", WEST);
+	ASSERT_EQUAL(game.TryMoveTrainer("ash", NORTH),
+				 POKEMONGO_REACHED_DEAD_END);
+	game.WhereIs("ash");
+	game.GetTrainersIn("taub");
+	game.GetScore(RED);
+
+	MetricsSnapshot after = game.Stats();
+	ASSERT_EQUAL(Grew(before, after, METRIC_MOVES), 3);
+	ASSERT_EQUAL(Grew(before, after, METRIC_DEAD_ENDS), 1);
+	ASSERT_EQUAL(Grew(before, after, METRIC_STARBUCKS_ARRIVALS), 1);
+	ASSERT_EQUAL(Grew(before, after, METRIC_POKESTOP_ARRIVALS), 2);
+	ASSERT_EQUAL(Grew(before, after, METRIC_GYM_ARRIVALS), 2);
+	ASSERT_EQUAL(Grew(before, after, METRIC_BATTLES), 1);
+	ASSERT_EQUAL(Grew(before, after, METRIC_LEADER_CHANGES), 2);
+	ASSERT_EQUAL(Grew(before, after, METRIC_ITEMS_HANDED_OUT), 1);
+	ASSERT_EQUAL(Grew(before, after, METRIC_POKEMONS_HANDED_OUT), 1);
+
+	ASSERT_EQUAL(Calls(before, after, METRIC_CALL_ADD_TRAINER), 2);
+	ASSERT_EQUAL(Calls(before, after, METRIC_CALL_MOVE_TRAINER), 4);
+	ASSERT_EQUAL(Calls(before, after, METRIC_CALL_WHERE_IS), 1);
+	ASSERT_EQUAL(Calls(before, after, METRIC_CALL_GET_TRAINERS_IN), 1);
+	ASSERT_EQUAL(Calls(before, after, METRIC_CALL_GET_SCORE), 1);
+	return true;
+}
+
+bool testMetricsMergeThreads() {
+	MetricsSnapshot before = Metrics::Snapshot();
+	vector<thread> threads;
+	for (int i = 0; i < 4; i++) {
+		threads.push_back(thread([] {
+			for (int j = 0; j < 1000; j++) {
+				Metrics::Count(METRIC_BATTLES);
+				Metrics::RecordLatency(METRIC_CALL_GET_SCORE, j);
+			}
+		}));
+	}
+	for (thread& current : threads) {
+		current.join();
+	}
+	// Exited threads' metrics are kept
+	MetricsSnapshot after = Metrics::Snapshot();
+	ASSERT_EQUAL(Grew(before, after, METRIC_BATTLES), 4000);
+	ASSERT_EQUAL(Calls(before, after, METRIC_CALL_GET_SCORE), 4000);
+	return true;
+}
+
+bool testMetricsHistogram() {
+	for (unsigned long long value = 0; value < 100000; value += 7) {
+		int bucket = LatencyHistogram::Bucket(value);
+		ASSERT_TRUE(bucket < LATENCY_BUCKETS_NUM);
+		ASSERT_TRUE(LatencyHistogram::BucketUpperBound(bucket) >= value);
+		ASSERT_TRUE(LatencyHistogram::BucketUpperBound(bucket) <=
+					value + value / 4);
+	}
+	ASSERT_TRUE(LatencyHistogram::Bucket(~0ULL) < LATENCY_BUCKETS_NUM);
+
+	LatencyHistogram histogram = {};
+	for (unsigned long long value = 1; value <= 1000; value++) {
+		histogram.buckets[LatencyHistogram::Bucket(value)]++;
+		histogram.count++;
+	}
+	ASSERT_TRUE(histogram.Percentile(0.5) >= 500);
+	ASSERT_TRUE(histogram.Percentile(0.5) < 640);
+	ASSERT_TRUE(histogram.Percentile(0.999) >= 999);
+	ASSERT_TRUE(histogram.Percentile(1) >= 1000);
+	return true;
+}
+
+bool testMetricsDump() {
+	MetricsSnapshot snapshot = {};
+	snapshot.counters[METRIC_MOVES] = 12;
+	snapshot.calls[METRIC_CALL_WHERE_IS].buckets[3] = 2;
+	snapshot.calls[METRIC_CALL_WHERE_IS].count = 2;
+	snapshot.calls[METRIC_CALL_WHERE_IS].total_nanoseconds = 6;
+
+	ostringstream text;
+	snapshot.WriteText(text);
+	ASSERT_TRUE(text.str().find("moves 12\n") != string::npos);
+	ASSERT_TRUE(text.str().find("WhereIs") != string::npos);
+
+	ostringstream json;
+	snapshot.WriteJson(json);
+	ASSERT_EQUAL(json.str().substr(0, 21), "{\"counters\":{\"moves\":");
+	ASSERT_TRUE(json.str().find("\"WhereIs\":{\"count\":2,\"mean\":3,"
+								"\"p50\":3,\"p99\":3,\"p999\":3}") !=
+				string::npos);
+	return true;
+}
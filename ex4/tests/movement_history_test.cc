@@ -0,0 +1,179 @@
+#include "../movement_history.h"
+
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../pokemon_go.h"
+#include "../tick_executor.h"
+#include "test_utils.h"
+
+using namespace mtm::pokemongo;
+
+static const int GRID_SIZE = 3;
+
+static std::string LocationName(int row, int column) {
+	return "p_" + std::to_string(row) + "_" + std::to_string(column);
+}
+
+// Builds a grid of empty Pokestops whose edges wrap around, so every
+// direction leads somewhere
+static World* CreateTorusWorld() {
+	std::vector<std::string> lines;
+	for (int row = 0; row < GRID_SIZE; row++) {
+		for (int column = 0; column < GRID_SIZE; column++) {
+			lines.push_back("POKESTOP " + LocationName(row, column));
+		}
+	}
+	World* world = CreateWorld(lines);
+	for (int row = 0; row < GRID_SIZE; row++) {
+		for (int column = 0; column < GRID_SIZE; column++) {
+			world->Connect(LocationName(row, column),
+						   LocationName(row, (column + 1) % GRID_SIZE),
+						   EAST, WEST);
+			world->Connect(LocationName(row, column),
+						   LocationName((row + 1) % GRID_SIZE, column),
+						   NORTH, SOUTH);
+		}
+	}
+	return world;
+}
+
+bool testMovementHistoryDecode() {
+	World* world = CreateTorusWorld();
+	std::mt19937 random(48);
+	const int MOVES_NUM = 1000;
+	MovementHistory history(LocationName(0, 0));
+	std::vector<std::string> expected(1, LocationName(0, 0));
+	std::unordered_map<std::string, size_t> expected_visits;
+	expected_visits[expected[0]]++;
+	for (int i = 0; i < MOVES_NUM; i++) {
+		Direction dir = random() % 4;
+		std::string next;
+		ASSERT_EQUAL(world->TryNeighbor(expected.back(), dir, &next),
+					 WORLD_SUCCESS);
+		history.Append(dir, next);
+		ASSERT_EQUAL(history.At(i), dir);
+		expected.push_back(next);
+		expected_visits[next]++;
+	}
+	ASSERT_EQUAL(history.Size(), (size_t)MOVES_NUM);
+	// 2 bits a move, and a name every CHECKPOINT_INTERVAL moves
+	ASSERT_TRUE(history.MemoryBytes() < MOVES_NUM);
+
+	std::vector<std::string> path;
+	ASSERT_EQUAL(history.TryDecodePath(*world, &path), WORLD_SUCCESS);
+	ASSERT_TRUE(path == expected);
+	std::unordered_map<std::string, size_t> visits;
+	ASSERT_EQUAL(history.TryCountVisits(*world, &visits), WORLD_SUCCESS);
+	ASSERT_TRUE(visits == expected_visits);
+	for (int moves_num : {0, 1, 255, 256, 257, 512, 999, 1000}) {
+		std::string location;
+		ASSERT_EQUAL(history.TryLocationAfter(*world, moves_num, &location),
+					 WORLD_SUCCESS);
+		ASSERT_EQUAL(location, expected[moves_num]);
+	}
+
+	// a world missing an edge of the path can't be walked
+	World* line_world = CreateWorld({"POKESTOP " + LocationName(0, 0)});
+	ASSERT_EQUAL(history.TryDecodePath(*line_world, &path),
+				 WORLD_REACHED_DEAD_END);
+	ASSERT_TRUE(path == expected);
+	delete line_world;
+	delete world;
+	return true;
+}
+
+bool testMovementHistoryJumps() {
+	World* world = CreateTorusWorld();
+	MovementHistory history(LocationName(0, 0));
+	std::vector<std::string> expected(1, LocationName(0, 0));
+	// a jump can be the first move, and a checkpoint move
+	for (size_t i = 0; i < MovementHistory::CHECKPOINT_INTERVAL + 2; i++) {
+		std::string next;
+		if (i % 85 == 0) {
+			next = LocationName(i % GRID_SIZE, (i + 1) % GRID_SIZE);
+			history.Jump(next);
+		} else {
+			ASSERT_EQUAL(world->TryNeighbor(expected.back(), EAST, &next),
+						 WORLD_SUCCESS);
+			history.Append(EAST, next);
+		}
+		ASSERT_EQUAL(history.IsJump(i), i % 85 == 0);
+		expected.push_back(next);
+	}
+	ASSERT_EQUAL(history.Size(), MovementHistory::CHECKPOINT_INTERVAL + 2);
+
+	// jumps are walked without the world
+	std::vector<std::string> path;
+	ASSERT_EQUAL(history.TryDecodePath(*world, &path), WORLD_SUCCESS);
+	ASSERT_TRUE(path == expected);
+	std::unordered_map<std::string, size_t> expected_visits;
+	for (size_t moves_num = 0; moves_num <= history.Size(); moves_num++) {
+		std::string reached;
+		ASSERT_EQUAL(history.TryLocationAfter(*world, moves_num, &reached),
+					 WORLD_SUCCESS);
+		ASSERT_EQUAL(reached, expected[moves_num]);
+		expected_visits[reached]++;
+	}
+	std::unordered_map<std::string, size_t> visits;
+	ASSERT_EQUAL(history.TryCountVisits(*world, &visits), WORLD_SUCCESS);
+	ASSERT_TRUE(visits == expected_visits);
+	delete world;
+	return true;
+}
+
+bool testMovementHistoryInGame() {
+	PokemonGo game(CreateTorusWorld());
+	PokemonGo ticked_game(CreateTorusWorld());
+	const MovementHistory* history = NULL;
+	game.AddTrainer("ash", YELLOW, LocationName(1, 1));
+	ASSERT_EQUAL(game.TryGetMovementHistory("ash", &history),
+				 POKEMONGO_SUCCESS);
+	ASSERT_TRUE(history == NULL);
+	ASSERT_EQUAL(game.TryGetMovementHistory("gary", &history),
+				 POKEMONGO_TRAINER_NOT_FOUND);
+	game.MoveTrainer("ash", EAST);
+
+	// recording starts where the trainer is
+	game.RecordMovements();
+	ticked_game.RecordMovements();
+	TickExecutor executor(ticked_game, 4);
+	executor.Submit(GameCommand::AddTrainer("ash", YELLOW,
+											LocationName(1, 2)));
+	executor.RunTick();
+	std::mt19937 random(480);
+	for (int i = 0; i < 600; i++) {
+		GameCommand command = GameCommand::MoveTrainer(
+			"ash", random() % 5 == 0 ? -1 : random() % 4);
+		game.TryApply(command);
+		executor.Submit(command);
+		if (i % 50 == 49) executor.RunTick();
+	}
+	executor.RunTick();
+
+	ASSERT_EQUAL(game.TryGetMovementHistory("ash", &history),
+				 POKEMONGO_SUCCESS);
+	ASSERT_TRUE(history != NULL);
+	ASSERT_EQUAL(history->Start(), LocationName(1, 2));
+	// moves in an invalid direction are not recorded
+	ASSERT_TRUE(history->Size() < 600);
+	ASSERT_TRUE(history->Size() > 400);
+	World* world = CreateTorusWorld();
+	std::string location;
+	ASSERT_EQUAL(history->TryLocationAfter(*world, history->Size(),
+										   &location), WORLD_SUCCESS);
+	ASSERT_EQUAL(location, game.WhereIs("ash"));
+	delete world;
+
+	// the executor records the same path
+	const MovementHistory* ticked_history = NULL;
+	ASSERT_EQUAL(ticked_game.TryGetMovementHistory("ash", &ticked_history),
+				 POKEMONGO_SUCCESS);
+	ASSERT_EQUAL(ticked_history->Size(), history->Size());
+	for (size_t move = 0; move < history->Size(); move++) {
+		ASSERT_EQUAL(ticked_history->At(move), history->At(move));
+	}
+	return true;
+}
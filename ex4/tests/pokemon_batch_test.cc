@@ -0,0 +1,83 @@
+#include "../pokemon_batch.h"
+
+#include <cstring>
+#include <random>
+#include <set>
+#include <vector>
+
+#include "test_utils.h"
+
+using namespace mtm::pokemongo;
+
+// Makes random pokemons, with few distinct stats so that ties are common
+static std::vector<Pokemon> RandomPokemons(std::mt19937& random,
+										   size_t count) {
+	std::vector<Pokemon> pokemons;
+	for (size_t i = 0; i < count; i++) {
+		std::set<PokemonType> types;
+		for (int type = random() % 3; type > 0; type--) {
+			types.insert((PokemonType)(random() % (PSYCHIC + 1)));
+		}
+		Pokemon pokemon("pikachu", types, 0.5 + random() % 6 * 1.7,
+						random() % 4 + 1);
+		if (random() % 3 == 0) pokemon.Train(1.1 + random() % 3 * 0.3);
+		pokemons.push_back(pokemon);
+	}
+	return pokemons;
+}
+
+bool testPokemonBatchCompare() {
+	std::mt19937 random(41);
+	// Odd sizes leave a Pokemon to the scalar loop
+	const size_t sizes[] = {0, 1, 2, 7, 1000};
+	for (size_t size : sizes) {
+		std::vector<Pokemon> lhs = RandomPokemons(random, size);
+		std::vector<Pokemon> rhs = RandomPokemons(random, size);
+		PokemonBatch lhs_batch(lhs);
+		PokemonBatch rhs_batch;
+		for (const Pokemon& pokemon : rhs) {
+			rhs_batch.Add(pokemon);
+		}
+		ASSERT_EQUAL(lhs_batch.Size(), size);
+		std::vector<int8_t> results(size + 1);
+		lhs_batch.Compare(rhs_batch, results.data());
+		for (size_t i = 0; i < size; i++) {
+			int expected = lhs[i] > rhs[i] ? 1 : (lhs[i] < rhs[i] ? -1 : 0);
+			ASSERT_EQUAL((int)results[i], expected);
+			ASSERT_EQUAL(lhs_batch.Level(i), lhs[i].Level());
+		}
+	}
+	return true;
+}
+
+bool testPokemonBatchHit() {
+	std::mt19937 random(410);
+	const size_t sizes[] = {1, 2, 9, 1000};
+	for (size_t size : sizes) {
+		std::vector<Pokemon> attackers = RandomPokemons(random, size);
+		std::vector<Pokemon> victims = RandomPokemons(random, size);
+		PokemonBatch attacker_batch(attackers);
+		PokemonBatch victim_batch(victims);
+		std::vector<uint8_t> died(size);
+		// Hit a few times, so that some of the victims die
+		for (int round = 0; round < 4; round++) {
+			attacker_batch.Hit(victim_batch, died.data());
+			for (size_t i = 0; i < size; i++) {
+				ASSERT_EQUAL(died[i] == 1, attackers[i].Hit(victims[i]));
+			}
+		}
+		// The HP left must be the same, to the bit
+		PokemonBatch expected;
+		for (size_t i = 0; i < size; i++) {
+			expected.Add(victims[i]);
+			double hp = victim_batch.Hp(i);
+			double expected_hp = expected.Hp(i);
+			ASSERT_EQUAL(memcmp(&hp, &expected_hp, sizeof(hp)), 0);
+			double power = attacker_batch.HitPower(i);
+			double expected_power = attackers[i].Level() *
+				attacker_batch.Cp(i);
+			ASSERT_EQUAL(memcmp(&power, &expected_power, sizeof(power)), 0);
+		}
+	}
+	return true;
+}
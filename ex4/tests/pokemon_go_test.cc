@@ -4,6 +4,7 @@
 #include <sstream>
 #include <string>
 #include <vector>
+#include <unistd.h>
 
 #include "test_utils.h"
 #include "../trainer.h"
@@ -130,6 +131,56 @@ bool testTrainersIn() {
 	return true;
 }
 
+bool testTryFunctions() {
+	World* world = new World();
+	SetUpWorld(world);
+	PokemonGo pokemon_go(world);
+	string trainer_location;
+	const vector<Trainer*>* trainers = NULL;
+
+	world->Connect("tel_aviv", "haifa", NORTH, SOUTH);
+	world->Connect("eilat", SOUTH);
+
+	// add
+	ASSERT_EQUAL(pokemon_go.TryAddTrainer("", YELLOW, "eilat"),
+				 POKEMONGO_INVALID_ARGS);
+	ASSERT_EQUAL(pokemon_go.TryAddTrainer("ash", YELLOW, "aroma"),
+				 POKEMONGO_LOCATION_NOT_FOUND);
+	ASSERT_EQUAL(pokemon_go.TryAddTrainer("ash", YELLOW, "tel_aviv"),
+				 POKEMONGO_SUCCESS);
+	ASSERT_EQUAL(pokemon_go.TryAddTrainer("ash", RED, "eilat"),
+				 POKEMONGO_TRAINER_NAME_ALREADY_USED);
+
+	// move
+	ASSERT_EQUAL(pokemon_go.TryMoveTrainer("gary", NORTH),
+				 POKEMONGO_TRAINER_NOT_FOUND);
+	ASSERT_EQUAL(pokemon_go.TryMoveTrainer("ash", WEST),
+				 POKEMONGO_REACHED_DEAD_END);
+	ASSERT_EQUAL(pokemon_go.TryMoveTrainer("ash", 7),
+				 POKEMONGO_INVALID_DIRECTION);
+	ASSERT_THROW(mtm::KGraphEdgeOutOfRange, pokemon_go.MoveTrainer("ash", 7));
+	ASSERT_EQUAL(pokemon_go.TryMoveTrainer("ash", NORTH), POKEMONGO_SUCCESS);
+
+	// where is
+	ASSERT_EQUAL(pokemon_go.TryWhereIs("gary", &trainer_location),
+				 POKEMONGO_TRAINER_NOT_FOUND);
+	ASSERT_EQUAL(pokemon_go.TryWhereIs("ash", &trainer_location),
+				 POKEMONGO_SUCCESS);
+	ASSERT_EQUAL(trainer_location, "haifa");
+
+	// trainers in
+	ASSERT_EQUAL(pokemon_go.TryGetTrainersIn("aroma", &trainers),
+				 POKEMONGO_LOCATION_NOT_FOUND);
+	ASSERT_TRUE(trainers == NULL);
+	ASSERT_EQUAL(pokemon_go.TryGetTrainersIn("haifa", &trainers),
+				 POKEMONGO_SUCCESS);
+	ASSERT_EQUAL(trainers->size(), 1);
+	ASSERT_TRUE(pokemon_go.TryGetTrainersIn("tel_aviv", &trainers) ==
+				POKEMONGO_SUCCESS && trainers->empty());
+
+	return true;
+}
+
 bool testGetScore() {
 	World* world = new World();
 	SetUpWorld(world);
@@ -169,3 +220,64 @@ bool testGetScore() {
 
 	return true;
 }
+
+bool testDumpAll() {
+	World* world = new World();
+	SetUpWorld(world);
+	PokemonGo pokemon_go(world);
+	pokemon_go.AddTrainer("ash", YELLOW, "haifa");
+	pokemon_go.AddTrainer("misty", BLUE, "eilat");
+	pokemon_go.AddTrainer("brock", RED, "haifa");
+	int fds[2];
+	ASSERT_EQUAL(pipe(fds), 0);
+	pokemon_go.DumpAll(fds[1]);
+	close(fds[1]);
+	string dumped;
+	char chunk[4096];
+	ssize_t length;
+	while ((length = read(fds[0], chunk, sizeof(chunk))) > 0) {
+		dumped.append(chunk, (size_t)length);
+	}
+	close(fds[0]);
+
+	// locations by name, trainers by arrival
+	ostringstream expected;
+	expected << "ashdod: 0\nashkelon: 0\neilat: 1\n"
+			 << *pokemon_go.GetTrainersIn("eilat")[0] << "haifa: 2\n"
+			 << *pokemon_go.GetTrainersIn("haifa")[0]
+			 << *pokemon_go.GetTrainersIn("haifa")[1]
+			 << "kfar_saba: 0\ntel_aviv: 0\n";
+	ASSERT_EQUAL(dumped, expected.str());
+	return true;
+}
+
+bool testTrainersInByTeam() {
+	World* world = new World();
+	SetUpWorld(world);
+	world->Connect("haifa", "ashdod", NORTH, SOUTH);
+	PokemonGo pokemon_go(world);
+	pokemon_go.AddTrainer("ash", YELLOW, "haifa");
+	pokemon_go.AddTrainer("misty", RED, "haifa");
+	pokemon_go.AddTrainer("gary", YELLOW, "ashdod");
+	pokemon_go.AddTrainer("brock", YELLOW, "haifa");
+	ASSERT_EQUAL(pokemon_go.CountIn("haifa", YELLOW), (size_t)2);
+	ASSERT_EQUAL(pokemon_go.CountIn("haifa", RED), (size_t)1);
+	ASSERT_EQUAL(pokemon_go.CountIn("haifa", BLUE), (size_t)0);
+	ASSERT_THROW(PokemonGoLocationNotFoundException,
+		pokemon_go.CountIn("aroma", RED));
+
+	// views are by arrival, and follow the trainers as they move
+	const vector<Trainer*>& yellow = pokemon_go.GetTrainersIn("haifa", YELLOW);
+	ASSERT_EQUAL(yellow.size(), (size_t)2);
+	ASSERT_EQUAL(yellow[0], pokemon_go.GetTrainersIn("haifa")[0]);
+	ASSERT_EQUAL(yellow[1], pokemon_go.GetTrainersIn("haifa")[2]);
+	pokemon_go.MoveTrainer("gary", SOUTH);
+	pokemon_go.MoveTrainer("ash", NORTH);
+	ASSERT_EQUAL(yellow.size(), (size_t)2);
+	ASSERT_EQUAL(yellow[0], pokemon_go.GetTrainersIn("haifa")[1]);
+	ASSERT_EQUAL(pokemon_go.CountIn("ashdod", YELLOW), (size_t)1);
+	ASSERT_EQUAL(pokemon_go.GetTrainersIn("ashdod", RED).size(), (size_t)0);
+	ASSERT_THROW(PokemonGoLocationNotFoundException,
+		pokemon_go.GetTrainersIn("aroma", RED));
+	return true;
+}
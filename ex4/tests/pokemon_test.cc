@@ -1,6 +1,7 @@
 #include "test_utils.h"
 #include "../pokemon.h"
 #include "../exceptions.h"
+#include <sstream>
 #include <string>
 #include <set>
 
@@ -109,3 +110,30 @@ bool testTrain() {
 
 	return true;
 }
+
+bool testCompactPokemon() {
+	std::set<PokemonType> types;
+	types.insert(PSYCHIC);
+	types.insert(NORMAL);
+	types.insert(FIRE);
+	Pokemon pikachu("pikachu", types, 5.5, 3);
+
+	// types are printed by their numerical value
+	std::ostringstream output;
+	output << pikachu;
+	ASSERT_EQUAL(output.str(), "pikachu(3/5.5/100) NORMAL FIRE PSYCHIC\n");
+	ASSERT_TRUE(sizeof(Pokemon) <= 40);
+
+	// an unknown type is rejected
+	types.insert((PokemonType)(PSYCHIC + 1));
+	ASSERT_THROW(PokemonInvalidArgsException,
+				 Pokemon("pikachu", types, 5, 5));
+
+	// training updates the hit power used in comparisons
+	Pokemon mew("mew", 10, 1);
+	Pokemon weak("mew", 5, 1);
+	ASSERT_TRUE(mew > weak);
+	weak.Train(4);
+	ASSERT_TRUE(weak > mew);
+	return true;
+}
@@ -0,0 +1,80 @@
+#include "../report_writer.h"
+
+#include <random>
+#include <set>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+
+#include "../exceptions.h"
+#include "test_utils.h"
+
+using namespace mtm::pokemongo;
+
+// Reads what's waiting in a pipe
+static std::string ReadPipe(int fd) {
+	std::string read_text;
+	char chunk[4096];
+	ssize_t length;
+	while ((length = read(fd, chunk, sizeof(chunk))) > 0) {
+		read_text.append(chunk, (size_t)length);
+	}
+	return read_text;
+}
+
+bool testReportMatchesOperators() {
+	std::mt19937 random(42);
+	const double cps[] = {1, 5.5, 1.0 / 3, 999999, 1000000, 1234567.25,
+						  0.0001, 1e-5, 123.456789};
+	std::ostringstream expected;
+	ReportWriter writer(-1);
+	for (int i = 0; i < 200; i++) {
+		const Team teams[] = {BLUE, YELLOW, RED};
+		Trainer trainer("trainer" + std::to_string(i), teams[i % 3]);
+		for (int j = random() % 4; j > 0; j--) {
+			std::set<PokemonType> types;
+			for (int type = random() % 4; type > 0; type--) {
+				types.insert((PokemonType)(random() % (PSYCHIC + 1)));
+			}
+			Pokemon pokemon("pikachu", types, cps[random() % 9], 1);
+			if (random() % 2) pokemon.Train(1.01 + random() % 100 / 7.0);
+			Pokemon hitter("raichu", types, cps[random() % 9], 1);
+			for (int hits = random() % 3; hits > 0; hits--) {
+				hitter.Hit(pokemon);
+			}
+			expected << pokemon;
+			writer.Add(pokemon);
+			trainer.TryToCatch(std::move(pokemon));
+		}
+		expected << trainer;
+		writer.Add(trainer);
+	}
+	ASSERT_EQUAL(writer.Text(), expected.str());
+	return true;
+}
+
+bool testReportFlush() {
+	int fds[2];
+	ASSERT_EQUAL(pipe(fds), 0);
+	Trainer ash("ash", YELLOW);
+	ash.TryToCatch(Pokemon("pikachu", 5.5, 1));
+	Trainer gary("gary", RED);
+	std::vector<Trainer*> trainers = {&ash, &gary};
+	ReportWriter writer(fds[1]);
+	writer.AddLocation("haifa", trainers);
+	std::ostringstream expected;
+	expected << "haifa: 2\n" << ash << gary;
+	ASSERT_EQUAL(writer.Pending(), expected.str().size());
+	writer.Flush();
+	ASSERT_EQUAL(writer.Pending(), (size_t)0);
+	close(fds[1]);
+	ASSERT_EQUAL(ReadPipe(fds[0]), expected.str());
+	close(fds[0]);
+
+	// a failed write empties the buffer anyway
+	ReportWriter broken(-1);
+	broken.Add(ash);
+	ASSERT_THROW(ReportWriteFailedException, broken.Flush());
+	ASSERT_EQUAL(broken.Pending(), (size_t)0);
+	return true;
+}
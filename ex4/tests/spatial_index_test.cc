@@ -0,0 +1,105 @@
+#include "../spatial_index.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <map>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "test_utils.h"
+
+using namespace mtm::pokemongo;
+
+bool testSpatialIndexBasics() {
+	SpatialIndex index;
+	std::string nearest;
+	GridPoint origin = {0, 0};
+	ASSERT_FALSE(index.Nearest(LOCATION_GYM, origin, &nearest));
+	GridPoint taub = {3, 4}, ulman = {-3, -4}, amado = {100, -100};
+	index.Insert("taub", LOCATION_GYM, taub);
+	index.Insert("ulman", LOCATION_GYM, ulman);
+	index.Insert("amado", LOCATION_POKESTOP, amado);
+	ASSERT_EQUAL(index.Size(), (size_t)3);
+
+	// equal distances are ordered by name
+	ASSERT_TRUE(index.Nearest(LOCATION_GYM, origin, &nearest));
+	ASSERT_EQUAL(nearest, "taub");
+	ASSERT_TRUE(index.Nearest(LOCATION_POKESTOP, origin, &nearest));
+	ASSERT_EQUAL(nearest, "amado");
+	ASSERT_FALSE(index.Nearest(LOCATION_STARBUCKS, origin, &nearest));
+
+	// moving a location
+	GridPoint moved = {-1, 0};
+	index.Insert("ulman", LOCATION_GYM, moved);
+	ASSERT_EQUAL(index.Size(), (size_t)3);
+	ASSERT_TRUE(index.Nearest(LOCATION_GYM, origin, &nearest));
+	ASSERT_EQUAL(nearest, "ulman");
+	std::vector<std::string> found = index.Within(LOCATION_GYM, origin, 7);
+	ASSERT_EQUAL(found.size(), (size_t)2);
+	ASSERT_EQUAL(found[0], "ulman");
+	ASSERT_EQUAL(found[1], "taub");
+	ASSERT_EQUAL(index.Within(LOCATION_GYM, origin, 6).size(), (size_t)1);
+
+	ASSERT_TRUE(index.Remove("ulman"));
+	ASSERT_FALSE(index.Remove("ulman"));
+	ASSERT_FALSE(index.Find("ulman", &moved));
+	ASSERT_TRUE(index.Find("taub", &moved));
+	ASSERT_EQUAL(moved.x, 3);
+	ASSERT_TRUE(index.Nearest(LOCATION_GYM, origin, &nearest));
+	ASSERT_EQUAL(nearest, "taub");
+	return true;
+}
+
+bool testSpatialIndexMatchesScan() {
+	std::mt19937 random(45);
+	SpatialIndex index;
+	std::map<std::string, std::pair<LocationType, GridPoint> > expected;
+	const LocationType types[] = {LOCATION_GYM, LOCATION_POKESTOP,
+								  LOCATION_STARBUCKS};
+	for (int i = 0; i < 3000; i++) {
+		std::string name = "location" + std::to_string(random() % 400);
+		if (random() % 4 == 0) {
+			ASSERT_EQUAL(index.Remove(name), expected.erase(name) == 1);
+		} else {
+			LocationType type = types[random() % 3];
+			GridPoint point = {(int)(random() % 201) - 100,
+							   (int)(random() % 201) - 100};
+			index.Insert(name, type, point);
+			expected[name] = std::make_pair(type, point);
+		}
+		ASSERT_EQUAL(index.Size(), expected.size());
+
+		// compare with measuring every location
+		LocationType type = types[random() % 3];
+		GridPoint point = {(int)(random() % 241) - 120,
+						   (int)(random() % 241) - 120};
+		int radius = random() % 30;
+		std::vector<std::pair<int, std::string> > by_distance;
+		for (const auto& location : expected) {
+			if (location.second.first != type) continue;
+			const GridPoint& other = location.second.second;
+			int distance = std::abs(other.x - point.x) +
+				std::abs(other.y - point.y);
+			by_distance.push_back(std::make_pair(distance, location.first));
+		}
+		std::sort(by_distance.begin(), by_distance.end());
+		std::string nearest;
+		ASSERT_EQUAL(index.Nearest(type, point, &nearest),
+					 !by_distance.empty());
+		if (!by_distance.empty()) {
+			ASSERT_EQUAL(nearest, by_distance[0].second);
+		}
+		std::vector<std::string> found = index.Within(type, point, radius);
+		size_t count = 0;
+		while (count < by_distance.size() &&
+			   by_distance[count].first <= radius) {
+			ASSERT_TRUE(count < found.size());
+			ASSERT_EQUAL(found[count], by_distance[count].second);
+			count++;
+		}
+		ASSERT_EQUAL(found.size(), count);
+	}
+	return true;
+}
@@ -0,0 +1,97 @@
+#include "../species.h"
+
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "test_utils.h"
+#include "../pokemon.h"
+
+using namespace mtm::pokemongo;
+
+bool testSpeciesIntern() {
+	SpeciesRegistry::SpeciesId pikachu = SpeciesRegistry::Intern("pikachu");
+	SpeciesRegistry::SpeciesId mew = SpeciesRegistry::Intern("mew");
+	ASSERT_TRUE(pikachu != mew);
+	ASSERT_EQUAL(SpeciesRegistry::Intern(std::string("pika") + "chu"),
+				 pikachu);
+	ASSERT_EQUAL(SpeciesRegistry::Name(pikachu), "pikachu");
+	ASSERT_EQUAL(SpeciesRegistry::Name(mew), "mew");
+	return true;
+}
+
+bool testSpeciesConcurrentIntern() {
+	size_t before = SpeciesRegistry::Size();
+	std::vector<std::thread> threads;
+	std::vector<std::vector<SpeciesRegistry::SpeciesId> > ids(4);
+	for (int i = 0; i < 4; i++) {
+		threads.push_back(std::thread([&ids, i] {
+			for (int j = 0; j < 100; j++) {
+				ids[i].push_back(SpeciesRegistry::Intern(
+					"species_" + std::to_string(j)));
+			}
+		}));
+	}
+	for (std::thread& current : threads) {
+		current.join();
+	}
+	// Every thread got the same id for the same name
+	ASSERT_EQUAL(SpeciesRegistry::Size(), before + 100);
+	for (int i = 1; i < 4; i++) {
+		ASSERT_TRUE(ids[i] == ids[0]);
+	}
+	ASSERT_EQUAL(SpeciesRegistry::Name(ids[0][42]), "species_42");
+	return true;
+}
+
+bool testSpeciesNameWhileInterning() {
+	SpeciesRegistry::SpeciesId first = SpeciesRegistry::Intern("reader_0");
+	// Names are read while new species fill several more blocks
+	bool names_match = true;
+	std::thread reader([&names_match, first] {
+		for (int i = 0; i < 100000; i++) {
+			if (SpeciesRegistry::Name(first) != "reader_0") {
+				names_match = false;
+			}
+		}
+	});
+	std::vector<SpeciesRegistry::SpeciesId> ids;
+	for (int i = 1; i < 1000; i++) {
+		ids.push_back(SpeciesRegistry::Intern(
+			"reader_" + std::to_string(i)));
+	}
+	reader.join();
+	ASSERT_TRUE(names_match);
+	for (int i = 1; i < 1000; i++) {
+		ASSERT_EQUAL(SpeciesRegistry::Name(ids[i - 1]),
+					 "reader_" + std::to_string(i));
+	}
+	return true;
+}
+
+bool testSpeciesDefaultTypes() {
+	const char* species_names[] = { "pikachu", "charmander", "no_such" };
+	for (const char* name : species_names) {
+		std::set<PokemonType> types = Pokemon::GetDefaultTypes(name);
+		const SpeciesRegistry::Types& cached =
+			SpeciesRegistry::DefaultTypes(SpeciesRegistry::Intern(name));
+		unsigned int mask = 0, sum = 0;
+		for (PokemonType type : types) {
+			mask |= 1 << type;
+			sum += type;
+		}
+		ASSERT_EQUAL(cached.mask, mask);
+		ASSERT_EQUAL(cached.sum, sum);
+		// The same entry is handed out every time
+		ASSERT_EQUAL(&SpeciesRegistry::DefaultTypes(
+						 SpeciesRegistry::Intern(name)), &cached);
+
+		std::ostringstream with_defaults, with_types;
+		with_defaults << Pokemon(name, 2.5, 3);
+		with_types << Pokemon(name, types, 2.5, 3);
+		ASSERT_EQUAL(with_defaults.str(), with_types.str());
+	}
+	return true;
+}
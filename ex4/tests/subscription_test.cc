@@ -0,0 +1,168 @@
+#include "../subscription.h"
+
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../pokemon_go.h"
+#include "../tick_executor.h"
+#include "test_utils.h"
+
+using namespace mtm::pokemongo;
+
+bool testSpscRing() {
+	SpscRing<int> ring(5);
+	ASSERT_EQUAL(ring.Capacity(), (size_t)8);
+	int value = 0;
+	ASSERT_FALSE(ring.TryPop(&value));
+	for (int i = 0; i < 8; i++) {
+		int pushed = i;
+		ASSERT_TRUE(ring.TryPush(std::move(pushed)));
+	}
+	int extra = 8;
+	ASSERT_FALSE(ring.TryPush(std::move(extra)));
+	ASSERT_TRUE(ring.TryPop(&value));
+	ASSERT_EQUAL(value, 0);
+
+	// a consumer thread sees every value in order
+	const int VALUES_NUM = 100000;
+	bool in_order = true;
+	std::thread consumer([&]() {
+		int expected = 1;
+		while (expected < VALUES_NUM) {
+			int popped = 0;
+			if (!ring.TryPop(&popped)) continue;
+			if (popped != expected) in_order = false;
+			expected++;
+		}
+	});
+	for (int i = 8; i < VALUES_NUM; i++) {
+		int pushed = i;
+		while (!ring.TryPush(std::move(pushed))) {}
+	}
+	consumer.join();
+	ASSERT_TRUE(in_order);
+	ASSERT_FALSE(ring.TryPop(&value));
+	return true;
+}
+
+static bool EventIs(const GameEvent& event, GameEventType type,
+					const std::string& location, const std::string& trainer) {
+	return event.type == type && event.location == location &&
+		event.trainer == trainer;
+}
+
+bool testSubscriptionEvents() {
+	PokemonGo game(CreateSmallWorld());
+	Subscription all(EVENT_ALL, std::vector<std::string>(), 4);
+	Subscription leader_of_b(EVENT_LEADER_CHANGE,
+							 std::vector<std::string>(1, "b"), 1);
+	Subscription arrivals_in_c(EVENT_ARRIVAL,
+							   std::vector<std::string>(1, "c"), 4);
+	game.Subscribe(&all);
+	game.Subscribe(&leader_of_b);
+	game.Subscribe(&arrivals_in_c);
+	EventBatch batch;
+
+	game.AddTrainer("ash", YELLOW, "a");
+	game.AddTrainer("gary", RED, "b");
+	game.PublishEvents();
+	ASSERT_TRUE(all.TryPoll(&batch));
+	ASSERT_EQUAL(batch.tick, 0UL);
+	ASSERT_EQUAL(batch.events.size(), (size_t)4);
+	ASSERT_TRUE(EventIs(batch.events[0], EVENT_ARRIVAL, "a", "ash"));
+	ASSERT_TRUE(EventIs(batch.events[1], EVENT_ARRIVAL, "b", "gary"));
+	ASSERT_TRUE(EventIs(batch.events[2], EVENT_LEADER_CHANGE, "a", "ash"));
+	ASSERT_TRUE(EventIs(batch.events[3], EVENT_LEADER_CHANGE, "b", "gary"));
+	ASSERT_FALSE(all.TryPoll(&batch));
+	ASSERT_FALSE(arrivals_in_c.TryPoll(&batch));
+
+	// going and coming back in the same tick is not reported
+	game.MoveTrainer("ash", EAST);
+	game.MoveTrainer("ash", WEST);
+	game.PublishEvents();
+	ASSERT_FALSE(all.TryPoll(&batch));
+
+	game.MoveTrainer("gary", NORTH);
+	game.PublishEvents();
+	ASSERT_TRUE(all.TryPoll(&batch));
+	ASSERT_EQUAL(batch.tick, 2UL);
+	ASSERT_EQUAL(batch.events.size(), (size_t)3);
+	ASSERT_TRUE(EventIs(batch.events[0], EVENT_DEPARTURE, "b", "gary"));
+	ASSERT_TRUE(EventIs(batch.events[1], EVENT_ARRIVAL, "c", "gary"));
+	ASSERT_TRUE(EventIs(batch.events[2], EVENT_LEADER_CHANGE, "b", ""));
+	ASSERT_TRUE(arrivals_in_c.TryPoll(&batch));
+	ASSERT_EQUAL(batch.events.size(), (size_t)1);
+	ASSERT_TRUE(EventIs(batch.events[0], EVENT_ARRIVAL, "c", "gary"));
+
+	// a full subscription drops new batches
+	ASSERT_EQUAL(leader_of_b.Dropped(), 1UL);
+	ASSERT_TRUE(leader_of_b.TryPoll(&batch));
+	ASSERT_EQUAL(batch.tick, 0UL);
+	ASSERT_EQUAL(batch.events.size(), (size_t)1);
+	ASSERT_TRUE(EventIs(batch.events[0], EVENT_LEADER_CHANGE, "b", "gary"));
+	ASSERT_FALSE(leader_of_b.TryPoll(&batch));
+
+	game.Unsubscribe(&all);
+	game.MoveTrainer("gary", SOUTH);
+	game.PublishEvents();
+	ASSERT_FALSE(all.TryPoll(&batch));
+	ASSERT_TRUE(leader_of_b.TryPoll(&batch));
+	game.Unsubscribe(&leader_of_b);
+	game.Unsubscribe(&arrivals_in_c);
+	return true;
+}
+
+static bool SameBatch(const EventBatch& lhs, const EventBatch& rhs) {
+	if (lhs.tick != rhs.tick || lhs.events.size() != rhs.events.size()) {
+		return false;
+	}
+	for (size_t i = 0; i < lhs.events.size(); i++) {
+		const GameEvent& event = rhs.events[i];
+		if (!EventIs(lhs.events[i], event.type, event.location,
+					 event.trainer)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool testSubscriptionTicks() {
+	PokemonGo ticked_game(CreateSmallWorld());
+	PokemonGo direct_game(CreateSmallWorld());
+	TickExecutor executor(ticked_game, 4);
+	Subscription ticked(EVENT_ALL, std::vector<std::string>(), 64);
+	Subscription direct(EVENT_ALL, std::vector<std::string>(), 64);
+	ticked_game.Subscribe(&ticked);
+	direct_game.Subscribe(&direct);
+
+	// the executor reports the same events as applying commands one by one
+	std::mt19937 random(46);
+	const Team teams[] = {BLUE, YELLOW, RED};
+	const char* locations[] = {"a", "b", "c"};
+	int batches = 0;
+	for (int tick = 0; tick < 40; tick++) {
+		for (int i = 0; i < 10; i++) {
+			std::string name = "trainer" + std::to_string(random() % 12);
+			GameCommand command = random() % 4 == 0 ?
+				GameCommand::AddTrainer(name, teams[random() % 3],
+										locations[random() % 3]) :
+				GameCommand::MoveTrainer(name, random() % 4);
+			executor.Submit(command);
+			direct_game.TryApply(command);
+		}
+		executor.RunTick();
+		direct_game.PublishEvents();
+		EventBatch ticked_batch, direct_batch;
+		bool has_batch = direct.TryPoll(&direct_batch);
+		ASSERT_EQUAL(ticked.TryPoll(&ticked_batch), has_batch);
+		if (!has_batch) continue;
+		ASSERT_TRUE(SameBatch(ticked_batch, direct_batch));
+		batches++;
+	}
+	ASSERT_TRUE(batches > 20);
+	ticked_game.Unsubscribe(&ticked);
+	direct_game.Unsubscribe(&direct);
+	return true;
+}
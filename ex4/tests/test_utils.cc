@@ -1,4 +1,44 @@
 #include "test_utils.h"
 #include <string>
 
-std::string location;
\ No newline at end of file
+#include "../pokemon_go.h"
+
+using namespace mtm::pokemongo;
+
+std::string location;
+
+World* CreateWorld(const std::vector<std::string>& lines) {
+	World* world = new World();
+	for (const std::string& line : lines) {
+		std::istringstream line_stream(line);
+		line_stream >> *world;
+	}
+	return world;
+}
+
+World* CreateSmallWorld() {
+	World* world = CreateWorld({"GYM a", "GYM b", "POKESTOP c CANDY 1"});
+	world->Connect("a", "b", EAST, WEST);
+	world->Connect("b", "c", NORTH, SOUTH);
+	return world;
+}
+
+std::string DumpGame(PokemonGo& game,
+					 const std::vector<std::string>& locations) {
+	std::ostringstream output;
+	for (const std::string& name : locations) {
+		output << name << ":" << std::endl;
+		for (Trainer* trainer : game.GetTrainersIn(name)) {
+			output << *trainer << "score " << trainer->TotalScore()
+				   << std::endl;
+		}
+		output << game.CountIn(name, BLUE) << " " << game.CountIn(name, YELLOW)
+			   << " " << game.CountIn(name, RED) << std::endl;
+	}
+	output << game.GetScore(BLUE) << " " << game.GetScore(YELLOW) << " "
+		   << game.GetScore(RED) << std::endl;
+	for (const LeaderboardEntry& entry : game.GetTopTrainers(10)) {
+		output << entry.name << " " << entry.score << std::endl;
+	}
+	return output.str();
+}
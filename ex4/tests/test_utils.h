@@ -5,6 +5,14 @@
 #include <iostream>
 #include <sstream>
 #include <string>
+#include <vector>
+
+namespace mtm {
+namespace pokemongo {
+class PokemonGo;
+class World;
+}  // namespace pokemongo
+}  // namespace mtm
 
 extern std::string location; // Used for finding the origin of an exception
 
@@ -86,4 +94,15 @@ catch (...) { \
 	} \
 } while (0)
 
+// Builds a world of the locations in lines, as read by operator>>
+mtm::pokemongo::World* CreateWorld(const std::vector<std::string>& lines);
+
+// Builds a world of two gyms, a and b, next to each other, and a pokestop c
+// north of b
+mtm::pokemongo::World* CreateSmallWorld();
+
+// Prints everything observable about a game, looking at the given locations
+std::string DumpGame(mtm::pokemongo::PokemonGo& game,
+					 const std::vector<std::string>& locations);
+
 #endif  //TEST_UTILS_H_
@@ -0,0 +1,191 @@
+#include "../tick_executor.h"
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "test_utils.h"
+#include "../pokemon_go.h"
+#include "../command.h"
+
+using namespace mtm::pokemongo;
+using namespace std;
+
+static const int GRID_SIZE = 4;
+static const int TRAINERS_NUM = 30;
+static const int COMMANDS_NUM = 600;
+static const int TICK_SIZE = 40;
+
+static string LocationName(int row, int column) {
+	ostringstream name;
+	name << "loc_" << row << "_" << column;
+	return name.str();
+}
+
+// Builds a grid of gyms, pokestops and starbucks, with no edges on the
+// world's border.
+static World* CreateGridWorld() {
+	vector<string> lines;
+	for (int row = 0; row < GRID_SIZE; row++) {
+		for (int column = 0; column < GRID_SIZE; column++) {
+			switch ((row * GRID_SIZE + column) % 3) {
+			case 0:
+				lines.push_back("GYM " + LocationName(row, column));
+				break;
+			case 1:
+				lines.push_back("POKESTOP " + LocationName(row, column) +
+								" CANDY 1 POTION 2 CANDY 3 CANDY 1 POTION 1");
+				break;
+			default:
+				lines.push_back("STARBUCKS " + LocationName(row, column) +
+								" pikachu 2.5 1 squirtle 4 2 charmander 3.5 1"
+								" bulbasaur 10 1 mew 6 3");
+			}
+		}
+	}
+	World* world = CreateWorld(lines);
+	for (int row = 0; row < GRID_SIZE; row++) {
+		for (int column = 0; column < GRID_SIZE; column++) {
+			if (column + 1 < GRID_SIZE) {
+				world->Connect(LocationName(row, column),
+							   LocationName(row, column + 1), EAST, WEST);
+			}
+			if (row + 1 < GRID_SIZE) {
+				world->Connect(LocationName(row, column),
+							   LocationName(row + 1, column), SOUTH, NORTH);
+			}
+		}
+	}
+	return world;
+}
+
+static string TrainerName(int index) {
+	ostringstream name;
+	name << "trainer_" << index;
+	return name.str();
+}
+
+// A deterministic stream of commands, including failing ones
+static vector<GameCommand> CreateCommands() {
+	vector<GameCommand> commands;
+	unsigned int seed = 12345;
+	for (int i = 0; i < COMMANDS_NUM; i++) {
+		seed = seed * 1103515245 + 12345;
+		unsigned int random = seed >> 8;
+		int trainer = random % (TRAINERS_NUM + 2);
+		if (i < TRAINERS_NUM || random % 17 == 0) {
+			// Adding a trainer, sometimes one which already exists
+			commands.push_back(GameCommand::AddTrainer(
+				TrainerName(i < TRAINERS_NUM ? i : trainer), (Team)(random % 3),
+				LocationName((random / 3) % GRID_SIZE,
+							 (random / 7) % GRID_SIZE)));
+		} else if (random % 31 == 0) {
+			commands.push_back(GameCommand::AddTrainer("", RED, "loc_0_0"));
+		} else if (random % 29 == 0) {
+			commands.push_back(GameCommand::AddTrainer("late", RED, "nowhere"));
+		} else {
+			commands.push_back(GameCommand::MoveTrainer(TrainerName(trainer),
+				(random / 5) % (random % 23 == 0 ? 5 : 4)));
+		}
+	}
+	return commands;
+}
+
+// Applies a command through the regular, serial, game interface
+static PokemonGoStatus ApplySerially(PokemonGo& game,
+								   const GameCommand& command) {
+	try {
+		if (command.type == ADD_TRAINER) {
+			game.AddTrainer(command.trainer_name, command.team,
+							command.location);
+		} else {
+			game.MoveTrainer(command.trainer_name, command.direction);
+		}
+	}
+	catch (PokemonGoInvalidArgsException&) {
+		return POKEMONGO_INVALID_ARGS;
+	}
+	catch (PokemonGoTrainerNameAlreadyUsedExcpetion&) {
+		return POKEMONGO_TRAINER_NAME_ALREADY_USED;
+	}
+	catch (PokemonGoLocationNotFoundException&) {
+		return POKEMONGO_LOCATION_NOT_FOUND;
+	}
+	catch (PokemonGoTrainerNotFoundExcpetion&) {
+		return POKEMONGO_TRAINER_NOT_FOUND;
+	}
+	catch (PokemonGoReachedDeadEndException&) {
+		return POKEMONGO_REACHED_DEAD_END;
+	}
+	catch (mtm::KGraphEdgeOutOfRange&) {
+		return POKEMONGO_INVALID_DIRECTION;
+	}
+	return POKEMONGO_SUCCESS;
+}
+
+static string DumpGridGame(PokemonGo& game) {
+	vector<string> locations;
+	for (int row = 0; row < GRID_SIZE; row++) {
+		for (int column = 0; column < GRID_SIZE; column++) {
+			locations.push_back(LocationName(row, column));
+		}
+	}
+	return DumpGame(game, locations);
+}
+
+bool testTickExecutorReplayMatchesSerial() {
+	vector<GameCommand> commands = CreateCommands();
+
+	PokemonGo serial_game(CreateGridWorld());
+	vector<PokemonGoStatus> serial_results;
+	for (const GameCommand& command : commands) {
+		serial_results.push_back(ApplySerially(serial_game, command));
+	}
+
+	PokemonGo parallel_game(CreateGridWorld());
+	TickExecutor executor(parallel_game, 4);
+	vector<PokemonGoStatus> parallel_results;
+	for (size_t i = 0; i < commands.size(); i++) {
+		ASSERT_EQUAL(executor.Submit(commands[i]), i);
+		if ((i + 1) % TICK_SIZE == 0 || i + 1 == commands.size()) {
+			const vector<PokemonGoStatus>& tick_results = executor.RunTick();
+			parallel_results.insert(parallel_results.end(),
+									tick_results.begin(), tick_results.end());
+		}
+	}
+
+	ASSERT_TRUE(serial_results == parallel_results);
+	ASSERT_EQUAL(DumpGridGame(serial_game), DumpGridGame(parallel_game));
+	return true;
+}
+
+bool testTickExecutorConflicts() {
+	PokemonGo game(CreateGridWorld());
+	TickExecutor executor(game, 2);
+
+	// Same trainer moving twice and another trainer arriving at the same
+	// location must run one after the other
+	executor.Submit(GameCommand::AddTrainer("ash", RED, "loc_0_0"));
+	executor.Submit(GameCommand::MoveTrainer("ash", EAST));
+	executor.Submit(GameCommand::MoveTrainer("ash", EAST));
+	executor.Submit(GameCommand::AddTrainer("gary", BLUE, "loc_0_2"));
+	executor.Submit(GameCommand::MoveTrainer("ash", NORTH));
+	executor.Submit(GameCommand::MoveTrainer("misty", NORTH));
+	const vector<PokemonGoStatus>& results = executor.RunTick();
+
+	ASSERT_EQUAL(results.size(), 6);
+	ASSERT_EQUAL(results[0], POKEMONGO_SUCCESS);
+	ASSERT_EQUAL(results[2], POKEMONGO_SUCCESS);
+	ASSERT_EQUAL(results[4], POKEMONGO_REACHED_DEAD_END);
+	ASSERT_EQUAL(results[5], POKEMONGO_TRAINER_NOT_FOUND);
+	ASSERT_EQUAL(executor.LastTickWaves(), 4);
+	ASSERT_EQUAL(game.WhereIs("ash"), "loc_0_2");
+	ASSERT_EQUAL(game.GetTrainersIn("loc_0_2").size(), 2);
+	ostringstream first_arrival;
+	first_arrival << *game.GetTrainersIn("loc_0_2")[0];
+	ASSERT_EQUAL(first_arrival.str().substr(0, 4), "ash ");
+
+	// An empty tick does nothing
+	ASSERT_TRUE(executor.RunTick().empty());
+	return true;
+}
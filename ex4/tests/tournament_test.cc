@@ -0,0 +1,127 @@
+#include "../tournament.h"
+
+#include <random>
+#include <set>
+#include <vector>
+
+#include "test_utils.h"
+
+using namespace mtm::pokemongo;
+
+// Makes a trainer with a single pokemon of the given CP, or none for 0
+static Trainer MakeTrainer(const std::string& name, Team team, double cp) {
+	std::set<PokemonType> types;
+	types.insert(NORMAL);
+	Trainer trainer(name, team);
+	if (cp > 0) trainer.TryToCatch(Pokemon("pikachu", types, cp, 1));
+	return trainer;
+}
+
+bool testRoundRobin() {
+	Trainer ash = MakeTrainer("ash", RED, 10);
+	Trainer gary = MakeTrainer("gary", BLUE, 20);
+	Trainer misty = MakeTrainer("misty", RED, 0);
+	Trainer brock = MakeTrainer("brock", RED, 0);
+	std::vector<const Trainer*> entrants = {&ash, &gary, &misty, &brock};
+	unsigned long long version = ash.Version();
+	ThreadPool pool(4);
+	TournamentResults results =
+		RunTournament(entrants, TOURNAMENT_ROUND_ROBIN, pool);
+
+	// the trainers themselves didn't battle
+	ASSERT_EQUAL(ash.Version(), version);
+	ASSERT_EQUAL(ash.Level(), 1);
+
+	ASSERT_EQUAL(results.matches.size(), (size_t)6);
+	ASSERT_EQUAL(results.matches[0].trainer_1, (size_t)0);
+	ASSERT_EQUAL(results.matches[0].trainer_2, (size_t)1);
+	ASSERT_EQUAL(results.matches[0].winner, 1);
+	ASSERT_EQUAL(results.matches[1].winner, 0);
+	// two trainers of the same team without pokemons can't be decided
+	ASSERT_EQUAL(results.matches[5].winner, MatchResult::NO_WINNER);
+
+	ASSERT_EQUAL(results.standings.size(), (size_t)4);
+	ASSERT_EQUAL(results.standings[0].trainer, (size_t)1);
+	ASSERT_EQUAL(results.standings[0].wins, 3u);
+	ASSERT_EQUAL(results.standings[0].points, 6u);
+	ASSERT_EQUAL(results.standings[1].trainer, (size_t)0);
+	ASSERT_EQUAL(results.standings[2].trainer, (size_t)2);
+	ASSERT_EQUAL(results.standings[2].draws, 1u);
+	ASSERT_EQUAL(results.standings[2].losses, 2u);
+	ASSERT_EQUAL(results.standings[3].trainer, (size_t)3);
+	ASSERT_EQUAL(results.entrants[1], &gary);
+	return true;
+}
+
+bool testSingleElimination() {
+	Trainer ash = MakeTrainer("ash", RED, 10);
+	Trainer gary = MakeTrainer("gary", BLUE, 20);
+	Trainer misty = MakeTrainer("misty", YELLOW, 15);
+	Trainer brock = MakeTrainer("brock", RED, 5);
+	Trainer dawn = MakeTrainer("dawn", BLUE, 30);
+	std::vector<const Trainer*> entrants =
+		{&ash, &gary, &misty, &brock, &dawn};
+	ThreadPool pool(3);
+	TournamentResults results =
+		RunTournament(entrants, TOURNAMENT_SINGLE_ELIMINATION, pool);
+
+	// round 0: ash-gary, misty-brock and dawn has a bye
+	// round 1: gary-misty and dawn has a bye
+	// round 2: gary-dawn
+	ASSERT_EQUAL(results.matches.size(), (size_t)4);
+	ASSERT_EQUAL(results.matches[0].winner, 1);
+	ASSERT_EQUAL(results.matches[1].winner, 2);
+	ASSERT_EQUAL(results.matches[2].round, (size_t)1);
+	ASSERT_EQUAL(results.matches[2].trainer_1, (size_t)1);
+	ASSERT_EQUAL(results.matches[2].trainer_2, (size_t)2);
+	ASSERT_EQUAL(results.matches[2].winner, 1);
+	ASSERT_EQUAL(results.matches[3].round, (size_t)2);
+	ASSERT_EQUAL(results.matches[3].trainer_1, (size_t)1);
+	ASSERT_EQUAL(results.matches[3].trainer_2, (size_t)4);
+	ASSERT_EQUAL(results.matches[3].winner, 4);
+
+	ASSERT_EQUAL(results.standings[0].trainer, (size_t)4);
+	ASSERT_EQUAL(results.standings[0].points, 3u);
+	ASSERT_EQUAL(results.standings[0].wins, 1u);
+	ASSERT_EQUAL(results.standings[1].trainer, (size_t)1);
+	ASSERT_EQUAL(results.standings[1].points, 2u);
+	ASSERT_EQUAL(results.standings[2].trainer, (size_t)2);
+	ASSERT_EQUAL(results.standings[3].trainer, (size_t)0);
+	ASSERT_EQUAL(results.standings[4].trainer, (size_t)3);
+	ASSERT_EQUAL(results.standings[4].losses, 1u);
+	return true;
+}
+
+bool testTournamentDeterministic() {
+	std::mt19937 random(40);
+	const Team teams[] = {BLUE, YELLOW, RED};
+	std::vector<Trainer> trainers;
+	for (int i = 0; i < 40; i++) {
+		trainers.push_back(MakeTrainer("trainer", teams[random() % 3],
+									   random() % 4 * 10));
+	}
+	std::vector<const Trainer*> entrants;
+	for (const Trainer& trainer : trainers) {
+		entrants.push_back(&trainer);
+	}
+	ThreadPool single(1);
+	ThreadPool many(8);
+	const TournamentFormat formats[] =
+		{TOURNAMENT_ROUND_ROBIN, TOURNAMENT_SINGLE_ELIMINATION};
+	for (TournamentFormat format : formats) {
+		TournamentResults expected = RunTournament(entrants, format, single);
+		TournamentResults results = RunTournament(entrants, format, many);
+		ASSERT_EQUAL(results.matches.size(), expected.matches.size());
+		for (size_t i = 0; i < results.matches.size(); i++) {
+			ASSERT_EQUAL(results.matches[i].trainer_1,
+						 expected.matches[i].trainer_1);
+			ASSERT_EQUAL(results.matches[i].winner,
+						 expected.matches[i].winner);
+		}
+		for (size_t i = 0; i < results.standings.size(); i++) {
+			ASSERT_EQUAL(results.standings[i].trainer,
+						 expected.standings[i].trainer);
+		}
+	}
+	return true;
+}
@@ -1,6 +1,8 @@
 #include "test_utils.h"
 #include "../trainer.h"
 #include "../exceptions.h"
+#include <random>
+#include <sstream>
 #include <string>
 #include <set>
 
@@ -21,16 +23,6 @@ bool testTrainerCtors() {
 }
 
 
-bool testAssignment() {
-
-	// test assignment operator
-	Trainer trainer = Trainer("Ash", BLUE);
-	Trainer trainer_2 = Trainer("Gary", BLUE);
-	ASSERT_NO_THROW(trainer_2 = trainer);
-
-	return true;
-}
-
 bool testGetStrongestPokemon() {
 	Trainer ash = Trainer("ash", RED);
 	Pokemon pikachu = Pokemon("pikachu", 10, 1);
@@ -200,3 +192,215 @@ bool testTrainerBattle() {
 
 	return true;
 }
+
+// Prints a pokemon, to tell apart pokemons of equal strength
+static std::string Print(const Pokemon& pokemon) {
+	std::ostringstream output;
+	output << pokemon;
+	return output.str();
+}
+
+bool testStrongestPokemonIndex() {
+	std::set<PokemonType> types;
+	types.insert(NORMAL);
+	Trainer ash = Trainer("ash", RED);
+	Pokemon pikachu = Pokemon("pikachu", types, 10, 1);
+	Pokemon raichu = Pokemon("raichu", types, 10, 1);
+	Pokemon mew = Pokemon("mew", types, 5, 1);
+
+	// ties go to the earliest caught
+	ash.TryToCatch(mew);
+	ash.TryToCatch(pikachu);
+	ash.TryToCatch(raichu);
+	ASSERT_EQUAL(Print(ash.GetStrongestPokemon()), Print(pikachu));
+
+	// a copy has its own pokemons
+	Trainer copy = Trainer(ash);
+	copy.KillStrongestPokemon();
+	ASSERT_EQUAL(Print(copy.GetStrongestPokemon()), Print(raichu));
+	ASSERT_EQUAL(Print(ash.GetStrongestPokemon()), Print(pikachu));
+	Trainer second_copy = Trainer(ash);
+	ash.KillStrongestPokemon();
+	ASSERT_EQUAL(Print(second_copy.GetStrongestPokemon()), Print(pikachu));
+
+	// a boosted pokemon is reordered
+	ASSERT_TRUE(ash.AddItem(new Candy(1)));
+	Trainer gary = Trainer("gary", BLUE);
+	Pokemon weak = Pokemon("magikarp", types, 0.5, 1);
+	gary.TryToCatch(weak);
+	ASSERT_EQUAL(&ash, TrainersBattle(ash, gary));
+	ASSERT_TRUE(ash.GetStrongestPokemon() > raichu);
+	ash.KillStrongestPokemon();
+	ASSERT_EQUAL(Print(ash.GetStrongestPokemon()), Print(mew));
+
+	// both pokemons hit before the dead ones are removed
+	Pokemon strong = Pokemon("mewtwo", types, 200, 1);
+	Pokemon strong_too = Pokemon("lugia", types, 150, 1);
+	Trainer red = Trainer("red", RED);
+	Trainer blue = Trainer("blue", BLUE);
+	red.TryToCatch(strong);
+	blue.TryToCatch(strong_too);
+	blue.TryToCatch(mew);
+	ASSERT_EQUAL(&red, TrainersBattle(red, blue));
+	ASSERT_THROW(TrainerNoPokemonsFoundException, red.GetStrongestPokemon());
+	ASSERT_EQUAL(Print(blue.GetStrongestPokemon()), Print(mew));
+
+	// killed pokemons are dropped without changing the catch order
+	Trainer misty = Trainer("misty", BLUE);
+	const double cps[] = {3, 6, 1, 5, 2, 4};
+	std::ostringstream expected;
+	expected << "misty (1) BLUE" << std::endl;
+	for (double cp : cps) {
+		Pokemon caught = Pokemon("psyduck", types, cp, 1);
+		misty.TryToCatch(caught);
+		if (cp <= 2) expected << caught;
+	}
+	for (double cp = 6; cp > 2; cp--) {
+		ASSERT_TRUE(misty.GetStrongestPokemon() ==
+					Pokemon("psyduck", types, cp, 1));
+		misty.KillStrongestPokemon();
+	}
+	std::ostringstream printed;
+	printed << misty;
+	ASSERT_EQUAL(printed.str(), expected.str());
+	Pokemon late = Pokemon("psyduck", types, 1.5, 1);
+	misty.TryToCatch(late);
+	misty.KillStrongestPokemon();
+	ASSERT_TRUE(misty.GetStrongestPokemon() == late);
+
+	return true;
+}
+
+bool testTrainerOwnership() {
+	std::set<PokemonType> types;
+	types.insert(NORMAL);
+	Trainer ash = Trainer("ash", RED);
+	Pokemon pikachu = Pokemon("pikachu", types, 10, 1);
+	ash.TryToCatch(pikachu);
+	ASSERT_TRUE(ash.AddItem(new Candy(1)));
+	ASSERT_TRUE(ash.AddItem(new Potion(1)));
+
+	// copies own their items, so both trainers can use them
+	Trainer copy = ash;
+	Trainer gary = Trainer("gary", BLUE);
+	gary.TryToCatch(pikachu);
+	ASSERT_EQUAL(&copy, TrainersBattle(copy, gary));
+	ASSERT_EQUAL(&ash, TrainersBattle(ash, gary));
+
+	// a moved trainer keeps the pokemons of the original
+	Trainer moved = std::move(ash);
+	ASSERT_TRUE(moved.GetStrongestPokemon() > pikachu);
+	ASSERT_THROW(TrainerNoPokemonsFoundException, ash.GetStrongestPokemon());
+	moved.KillStrongestPokemon();
+	ASSERT_THROW(TrainerNoPokemonsFoundException,
+				 moved.GetStrongestPokemon());
+
+	// a caught rvalue is moved as is, with its HP
+	Pokemon hurt = Pokemon("pikachu", types, 10, 1);
+	Pokemon(pikachu).Hit(hurt);
+	Trainer misty = Trainer("misty", BLUE);
+	ASSERT_TRUE(misty.TryToCatch(std::move(hurt)));
+	ASSERT_EQUAL(Print(misty.GetStrongestPokemon()),
+				 "pikachu(1/10/90) NORMAL\n");
+	return true;
+}
+
+// Counts the pokemons of a trainer by the lines it prints
+static int CountPokemons(const Trainer& trainer) {
+	std::ostringstream output;
+	output << trainer;
+	std::string printed = output.str();
+	int lines = 0;
+	for (char c : printed) {
+		if (c == '\n') lines++;
+	}
+	return lines - 1;
+}
+
+bool testPredictBattle() {
+	std::set<PokemonType> types;
+	types.insert(NORMAL);
+	Trainer ash = Trainer("ash", RED);
+	Trainer gary = Trainer("gary", YELLOW);
+
+	// no pokemons, the team decides and no level is gained
+	BattlePrediction prediction = PredictBattle(ash, gary);
+	ASSERT_TRUE(prediction.first_wins);
+	ASSERT_TRUE(prediction.decided_by_team);
+	ASSERT_EQUAL(prediction.level_gain[0], 0);
+	ASSERT_EQUAL(prediction.score_change[0], 2);
+	ASSERT_EQUAL(prediction.score_change[1], -1);
+	ASSERT_THROW(TrainerInvalidArgsException,
+				 PredictBattle(ash, Trainer("brock", RED)));
+
+	// predicting doesn't change the trainers
+	ash.TryToCatch(Pokemon("pikachu", types, 10, 1));
+	gary.TryToCatch(Pokemon("pikachu", types, 3, 1));
+	ASSERT_TRUE(gary.AddItem(new Candy(1)));
+	unsigned long long version = gary.Version();
+	prediction = PredictBattle(gary, ash);
+	ASSERT_EQUAL(gary.Version(), version);
+	ASSERT_EQUAL(Print(gary.GetStrongestPokemon()),
+				 "pikachu(1/3/100) NORMAL\n");
+	ASSERT_FALSE(prediction.first_wins);
+	ASSERT_FALSE(prediction.decided_by_team);
+	ASSERT_TRUE(prediction.uses_item[0]);
+	ASSERT_FALSE(prediction.uses_item[1]);
+	ASSERT_EQUAL(prediction.level_gain[1], 1);
+	ASSERT_FALSE(prediction.loses_pokemon[0]);
+	ASSERT_FALSE(prediction.loses_pokemon[1]);
+
+	// battles change the version
+	TrainersBattle(gary, ash);
+	ASSERT_TRUE(gary.Version() != version);
+	ASSERT_TRUE(Trainer(ash).Id() != ash.Id());
+
+	// random battles turn out as predicted
+	std::mt19937 random(39);
+	const Team teams[] = {BLUE, YELLOW, RED};
+	for (int round = 0; round < 500; round++) {
+		Trainer trainers[] = {Trainer("red", teams[random() % 3]),
+							  Trainer("blue", teams[random() % 3])};
+		for (Trainer& trainer : trainers) {
+			for (int i = random() % 3; i > 0; i--) {
+				Pokemon pokemon("pikachu", types, random() % 20 + 1, 1);
+				// hurts the pokemon so that potions matter
+				for (int hits = random() % 4; hits > 0; hits--) {
+					Pokemon("pikachu", types, 20, 1).Hit(pokemon);
+				}
+				trainer.TryToCatch(std::move(pokemon));
+			}
+			for (int i = random() % 3; i > 0; i--) {
+				if (random() % 2) {
+					trainer.AddItem(new Candy(1));
+				} else {
+					trainer.AddItem(new Potion(1));
+				}
+			}
+		}
+		int levels[] = {trainers[0].Level(), trainers[1].Level()};
+		int scores[] = {trainers[0].TotalScore(), trainers[1].TotalScore()};
+		int counts[] = {CountPokemons(trainers[0]),
+						CountPokemons(trainers[1])};
+		bool same_team = trainers[0].GetTeam() == trainers[1].GetTeam();
+		try {
+			prediction = PredictBattle(trainers[0], trainers[1]);
+		} catch (const TrainerInvalidArgsException&) {
+			ASSERT_TRUE(same_team);
+			ASSERT_THROW(TrainerInvalidArgsException,
+						 TrainersBattle(trainers[0], trainers[1]));
+			continue;
+		}
+		Trainer* winner = TrainersBattle(trainers[0], trainers[1]);
+		ASSERT_EQUAL(winner == &trainers[0], prediction.first_wins);
+		for (int i = 0; i < 2; i++) {
+			ASSERT_EQUAL(trainers[i].Level() - levels[i],
+						 prediction.level_gain[i]);
+			ASSERT_EQUAL(trainers[i].TotalScore() - scores[i],
+						 prediction.score_change[i] + prediction.level_gain[i]);
+			ASSERT_EQUAL(counts[i] - CountPokemons(trainers[i]),
+						 prediction.loses_pokemon[i] ? 1 : 0);
+		}
+	}
+	return true;
+}
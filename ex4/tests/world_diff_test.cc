@@ -0,0 +1,250 @@
+#include "../world_diff.h"
+
+#include <cstdio>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../exceptions.h"
+#include "../journal.h"
+#include "../pokemon_go.h"
+#include "test_utils.h"
+
+using namespace mtm::pokemongo;
+
+static const char* JOURNAL_PATH = "world_diff_test.journal";
+
+// Builds the small world, recording its locations and edges in journal
+static World* CreateSmallWorld(Journal& journal) {
+	journal.RecordLocation("GYM a");
+	journal.RecordLocation("GYM b");
+	journal.RecordLocation("POKESTOP c CANDY 1");
+	journal.RecordConnect("a", "b", EAST, WEST);
+	journal.RecordConnect("b", "c", NORTH, SOUTH);
+	return CreateSmallWorld();
+}
+
+bool testWorldDiffRead() {
+	const char* lines[] = {
+		"ADD POKESTOP mikhlol POTION 10",
+		"REMOVE taub meyer",
+		"CONNECT taub EAST meyer WEST",
+		"DISCONNECT taub meyer",
+	};
+	// empty lines are skipped
+	std::string text = "\n";
+	for (const char* line : lines) {
+		text += std::string(line) + "\n\n";
+	}
+	std::istringstream input(text);
+	std::vector<WorldChange> diff = ReadWorldDiff(input);
+	ASSERT_EQUAL(diff.size(), (size_t)4);
+	ASSERT_EQUAL(diff[0].type, ADD_LOCATION);
+	ASSERT_EQUAL(diff[0].line, std::string("POKESTOP mikhlol POTION 10"));
+	ASSERT_EQUAL(diff[1].type, REMOVE_LOCATION);
+	ASSERT_EQUAL(diff[1].location, std::string("taub"));
+	ASSERT_EQUAL(diff[1].other, std::string("meyer"));
+	ASSERT_EQUAL(diff[2].type, CONNECT_LOCATIONS);
+	ASSERT_EQUAL(diff[2].direction, EAST);
+	ASSERT_EQUAL(diff[2].other_direction, WEST);
+	ASSERT_EQUAL(diff[3].type, DISCONNECT_LOCATIONS);
+	for (size_t i = 0; i < diff.size(); i++) {
+		std::ostringstream output;
+		output << diff[i];
+		ASSERT_EQUAL(output.str(), std::string(lines[i]));
+	}
+
+	const char* invalid_lines[] = {
+		"ADD",
+		"REMOVE taub",
+		"CONNECT taub UP meyer WEST",
+		"DISCONNECT taub meyer dorms",
+		"RENAME taub meyer",
+	};
+	for (const char* line : invalid_lines) {
+		std::istringstream line_stream(line);
+		WorldChange change;
+		ASSERT_THROW(WorldInvalidInputLineException, line_stream >> change);
+	}
+	return true;
+}
+
+bool testApplyWorldDiff() {
+	World* world = CreateSmallWorld();
+	PokemonGo game(world);
+	game.RecordMovements();
+	Subscription all(EVENT_ALL, std::vector<std::string>(), 4);
+	game.Subscribe(&all);
+	game.AddTrainer("ash", YELLOW, "a");
+	game.AddTrainer("gary", RED, "b");
+	game.AddTrainer("brock", YELLOW, "c");
+	game.PublishEvents();
+	EventBatch batch;
+	ASSERT_TRUE(all.TryPoll(&batch));
+
+	std::istringstream input("ADD GYM d\n"
+							 "CONNECT c EAST d WEST\n"
+							 "DISCONNECT a b\n"
+							 "REMOVE b c\n"
+							 "CONNECT d NORTH d NORTH\n");
+	size_t applied = 0;
+	ASSERT_EQUAL(game.TryApplyWorldDiff(ReadWorldDiff(input), &applied),
+				 WORLD_CHANGE_SUCCESS);
+	ASSERT_EQUAL(applied, (size_t)5);
+
+	// the game placed its world, and the added location next to c
+	GridPoint point;
+	ASSERT_EQUAL(world->TryGetCoordinates("c", &point), WORLD_SUCCESS);
+	ASSERT_EQUAL(point.x, 1);
+	ASSERT_EQUAL(point.y, 1);
+	ASSERT_EQUAL(world->TryGetCoordinates("d", &point), WORLD_SUCCESS);
+	ASSERT_EQUAL(point.x, 2);
+	ASSERT_EQUAL(point.y, 1);
+
+	// the trainers of b were moved to c, and b's edges went with it
+	const std::vector<Trainer*>* trainers = NULL;
+	ASSERT_EQUAL(game.TryGetTrainersIn("b", &trainers),
+				 POKEMONGO_LOCATION_NOT_FOUND);
+	ASSERT_EQUAL(game.WhereIs("gary"), std::string("c"));
+	ASSERT_EQUAL(game.GetTrainersIn("c").size(), (size_t)2);
+	ASSERT_EQUAL(game.GetTrainersIn("c")[1]->GetName(), std::string("gary"));
+	ASSERT_EQUAL(game.TryMoveTrainer("ash", EAST),
+				 POKEMONGO_REACHED_DEAD_END);
+	ASSERT_EQUAL(game.TryMoveTrainer("brock", SOUTH),
+				 POKEMONGO_REACHED_DEAD_END);
+	game.PublishEvents();
+	ASSERT_TRUE(all.TryPoll(&batch));
+	ASSERT_EQUAL(batch.events.size(), (size_t)2);
+	ASSERT_EQUAL(batch.events[0].type, EVENT_DEPARTURE);
+	ASSERT_EQUAL(batch.events[0].location, std::string("b"));
+	ASSERT_EQUAL(batch.events[1].type, EVENT_ARRIVAL);
+	ASSERT_EQUAL(batch.events[1].location, std::string("c"));
+
+	// the new location and edges are walked like the old ones
+	game.MoveTrainer("gary", EAST);
+	game.MoveTrainer("gary", NORTH);
+	ASSERT_EQUAL(game.WhereIs("gary"), std::string("d"));
+	const MovementHistory* history = NULL;
+	ASSERT_EQUAL(game.TryGetMovementHistory("gary", &history),
+				 POKEMONGO_SUCCESS);
+	// and the path before the removal is kept, jumping to the fallback
+	ASSERT_EQUAL(history->Start(), std::string("b"));
+	ASSERT_EQUAL(history->Size(), (size_t)3);
+	ASSERT_TRUE(history->IsJump(0));
+	ASSERT_FALSE(history->IsJump(1));
+	std::vector<std::string> path;
+	ASSERT_EQUAL(history->TryDecodePath(*world, &path),
+				 WORLD_SUCCESS);
+	const char* expected[] = {"b", "c", "d", "d"};
+	ASSERT_TRUE(path == std::vector<std::string>(expected, expected + 4));
+
+	ASSERT_EQUAL(game.TryApplyWorldChange(
+					 WorldChange::RemoveLocation("a", "a")),
+				 WORLD_CHANGE_INVALID_FALLBACK);
+	ASSERT_EQUAL(game.TryApplyWorldChange(
+					 WorldChange::RemoveLocation("b", "a")),
+				 WORLD_CHANGE_LOCATION_NOT_FOUND);
+	ASSERT_EQUAL(game.TryApplyWorldChange(WorldChange::AddLocation("GYM d")),
+				 WORLD_CHANGE_LOCATION_NAME_ALREADY_USED);
+	ASSERT_EQUAL(game.TryApplyWorldChange(WorldChange::AddLocation("CAFE e")),
+				 WORLD_CHANGE_INVALID_LINE);
+	ASSERT_EQUAL(game.TryApplyWorldChange(
+					 WorldChange::Connect("a", "d", EAST, WEST)),
+				 WORLD_CHANGE_EDGE_ALREADY_IN_USE);
+	ASSERT_EQUAL(game.TryApplyWorldChange(
+					 WorldChange::Connect("c", "d", NORTH, SOUTH)),
+				 WORLD_CHANGE_ALREADY_CONNECTED);
+	ASSERT_EQUAL(game.TryApplyWorldChange(
+					 WorldChange::Connect("a", "c", 4, NORTH)),
+				 WORLD_CHANGE_INVALID_DIRECTION);
+	ASSERT_EQUAL(game.TryApplyWorldChange(WorldChange::Disconnect("a", "c")),
+				 WORLD_CHANGE_NOT_CONNECTED);
+
+	// a diff stops at its first failed change, and keeps the ones before
+	std::istringstream failing("ADD GYM e\n"
+							   "CONNECT e EAST a WEST\n"
+							   "REMOVE x a\n"
+							   "ADD GYM f\n");
+	ASSERT_THROW(PokemonGoLocationNotFoundException,
+				 game.ApplyWorldDiff(failing));
+	game.MoveTrainer("ash", WEST);
+	ASSERT_EQUAL(game.WhereIs("ash"), std::string("e"));
+	ASSERT_THROW(PokemonGoLocationNotFoundException, game.GetTrainersIn("f"));
+
+	// nothing is applied from a diff which can't be read
+	std::istringstream unreadable("ADD GYM g\nJUMP g\n");
+	ASSERT_THROW(WorldInvalidInputLineException,
+				 game.ApplyWorldDiff(unreadable));
+	ASSERT_THROW(PokemonGoLocationNotFoundException, game.GetTrainersIn("g"));
+	game.Unsubscribe(&all);
+	return true;
+}
+
+bool testWorldDiffKeepsPaths() {
+	World* world = CreateSmallWorld();
+	PokemonGo game(world);
+	game.RecordMovements();
+	game.AddTrainer("ash", YELLOW, "a");
+	game.MoveTrainer("ash", EAST);
+	game.MoveTrainer("ash", NORTH);
+
+	// the edges ash walked are removed, and one leads elsewhere
+	std::istringstream input("DISCONNECT a b\n"
+							 "ADD GYM d\n"
+							 "CONNECT a EAST d WEST\n"
+							 "REMOVE b a\n"
+							 "CONNECT c SOUTH a NORTH\n");
+	game.ApplyWorldDiff(input);
+	const MovementHistory* history = NULL;
+	ASSERT_EQUAL(game.TryGetMovementHistory("ash", &history),
+				 POKEMONGO_SUCCESS);
+	ASSERT_TRUE(history->IsJump(0));
+	ASSERT_TRUE(history->IsJump(1));
+	std::vector<std::string> path;
+	ASSERT_EQUAL(history->TryDecodePath(*world, &path), WORLD_SUCCESS);
+	const char* expected[] = {"a", "b", "c"};
+	ASSERT_TRUE(path == std::vector<std::string>(expected, expected + 3));
+
+	// moves after the changes walk the changed world
+	game.MoveTrainer("ash", SOUTH);
+	ASSERT_EQUAL(game.WhereIs("ash"), std::string("a"));
+	game.MoveTrainer("ash", EAST);
+	ASSERT_EQUAL(history->TryDecodePath(*world, &path), WORLD_SUCCESS);
+	const char* walked[] = {"a", "b", "c", "a", "d"};
+	ASSERT_TRUE(path == std::vector<std::string>(walked, walked + 5));
+	ASSERT_FALSE(history->IsJump(4));
+	return true;
+}
+
+bool testWorldDiffJournal() {
+	std::string gary_location, brock_location;
+	JournalReplayStats stats;
+	{
+		Journal journal(JOURNAL_PATH);
+		PokemonGo game(CreateSmallWorld(journal));
+		game.AttachJournal(&journal);
+		game.AddTrainer("gary", RED, "b");
+		game.AddTrainer("brock", YELLOW, "c");
+		game.TryApplyWorldChange(WorldChange::AddLocation("GYM d"));
+		game.TryApplyWorldChange(WorldChange::Connect("c", "d", EAST, WEST));
+		game.TryApplyWorldChange(WorldChange::RemoveLocation("b", "a"));
+		game.TryApplyWorldChange(WorldChange::Disconnect("a", "d"));
+		game.TryMoveTrainer("brock", EAST);
+		game.TryMoveTrainer("gary", EAST);
+		gary_location = game.WhereIs("gary");
+		brock_location = game.WhereIs("brock");
+		game.AttachJournal(NULL);
+	}
+	JournalReader reader(JOURNAL_PATH);
+	PokemonGo* replayed = ReplayJournal(reader, &stats);
+	ASSERT_EQUAL(stats.commands, 8ULL);
+	ASSERT_EQUAL(stats.mismatches, 0ULL);
+	ASSERT_EQUAL(replayed->WhereIs("gary"), gary_location);
+	ASSERT_EQUAL(replayed->WhereIs("brock"), brock_location);
+	ASSERT_EQUAL(replayed->WhereIs("brock"), std::string("d"));
+	ASSERT_THROW(PokemonGoLocationNotFoundException,
+				 replayed->GetTrainersIn("b"));
+	delete replayed;
+	std::remove(JOURNAL_PATH);
+	return true;
+}
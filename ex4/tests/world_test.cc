@@ -61,6 +61,35 @@ bool WorldInput() {
     return true;
 }
 
+bool WorldTryNeighbor() {
+	World world;
+	std::string neighbor;
+	Location* found = NULL;
+	std::istringstream input_1("GYM taub");
+	input_1 >> world;
+	std::istringstream input_2("GYM ulman");
+	input_2 >> world;
+	world.Connect("taub", "ulman", EAST, WEST);
+
+	ASSERT_TRUE(world.Contains("taub"));
+	ASSERT_FALSE(world.Contains("amado"));
+	ASSERT_EQUAL(world.TryGetLocation("amado", &found),
+				 WORLD_LOCATION_NOT_FOUND);
+	ASSERT_EQUAL(world.TryGetLocation("taub", &found), WORLD_SUCCESS);
+	ASSERT_TRUE(found == world["taub"]);
+
+	ASSERT_EQUAL(world.TryNeighbor("amado", EAST, &neighbor),
+				 WORLD_LOCATION_NOT_FOUND);
+	ASSERT_EQUAL(world.TryNeighbor("taub", -1, &neighbor),
+				 WORLD_INVALID_DIRECTION);
+	ASSERT_EQUAL(world.TryNeighbor("taub", NORTH, &neighbor),
+				 WORLD_REACHED_DEAD_END);
+	ASSERT_EQUAL(world.TryNeighbor("taub", EAST, &neighbor), WORLD_SUCCESS);
+	ASSERT_EQUAL(neighbor, "ulman");
+
+	return true;
+}
+
 bool WorldRemove() {
 	World world;
     // Remove location
@@ -70,3 +99,81 @@ bool WorldRemove() {
 
 	return true;
 }
+
+bool WorldCoordinates() {
+	World world;
+	const char* lines[] = {"GYM taub", "POKESTOP ulman CANDY 1",
+						   "GYM amado", "GYM segoe", "STARBUCKS meyer"};
+	for (const char* line : lines) {
+		std::istringstream line_stream(line);
+		line_stream >> world;
+	}
+	world.Connect("ulman", "taub", EAST, WEST);
+	world.Connect("taub", "amado", NORTH, SOUTH);
+	std::string nearest;
+	GridPoint point;
+	ASSERT_EQUAL(world.TryFindNearest("taub", LOCATION_GYM, &nearest),
+				 WORLD_NO_COORDINATES);
+	ASSERT_EQUAL(world.TryGetCoordinates("nowhere", &point),
+				 WORLD_LOCATION_NOT_FOUND);
+	GridPoint start = {10, 10};
+	ASSERT_EQUAL(world.SetCoordinates("ulman", start), WORLD_SUCCESS);
+	world.DeriveCoordinates();
+
+	// directions become steps from the placed location
+	ASSERT_EQUAL(world.TryGetCoordinates("taub", &point), WORLD_SUCCESS);
+	ASSERT_EQUAL(point.x, 11);
+	ASSERT_EQUAL(point.y, 10);
+	ASSERT_EQUAL(world.TryGetCoordinates("amado", &point), WORLD_SUCCESS);
+	ASSERT_EQUAL(point.x, 11);
+	ASSERT_EQUAL(point.y, 11);
+	// unconnected locations go to the east
+	ASSERT_EQUAL(world.TryGetCoordinates("meyer", &point), WORLD_SUCCESS);
+	ASSERT_EQUAL(point.x, 13);
+	ASSERT_EQUAL(world.TryGetCoordinates("segoe", &point), WORLD_SUCCESS);
+	ASSERT_EQUAL(point.x, 15);
+
+	ASSERT_EQUAL(world.TryFindNearest("ulman", LOCATION_GYM, &nearest),
+				 WORLD_SUCCESS);
+	ASSERT_EQUAL(nearest, "taub");
+	ASSERT_EQUAL(world.TryFindNearest("meyer", LOCATION_GYM, &nearest),
+				 WORLD_SUCCESS);
+	ASSERT_EQUAL(nearest, "segoe");
+	std::vector<std::string> found;
+	ASSERT_EQUAL(world.TryFindWithin("taub", LOCATION_GYM, 14, &found),
+				 WORLD_SUCCESS);
+	ASSERT_EQUAL(found.size(), (size_t)3);
+	ASSERT_EQUAL(found[0], "taub");
+	ASSERT_EQUAL(found[1], "amado");
+	ASSERT_EQUAL(found[2], "segoe");
+
+	// removed locations are no longer found
+	world.Remove("segoe");
+	ASSERT_EQUAL(world.TryFindNearest("meyer", LOCATION_GYM, &nearest),
+				 WORLD_SUCCESS);
+	ASSERT_EQUAL(nearest, "taub");
+	world.Remove("meyer");
+	ASSERT_EQUAL(world.TryFindNearest("ulman", LOCATION_STARBUCKS, &nearest),
+				 WORLD_NO_MATCHING_LOCATION);
+
+	// locations connected to a placed one are placed, with the unplaced
+	// locations connected to them
+	std::istringstream bloomfield("GYM bloomfield");
+	bloomfield >> world;
+	std::istringstream cooper("GYM cooper");
+	cooper >> world;
+	ASSERT_EQUAL(world.TryConnect("bloomfield", "cooper", NORTH, SOUTH),
+				 mtm::KGRAPH_SUCCESS);
+	ASSERT_EQUAL(world.TryGetCoordinates("cooper", &point),
+				 WORLD_NO_COORDINATES);
+	ASSERT_EQUAL(world.TryConnect("amado", "bloomfield", EAST, WEST),
+				 mtm::KGRAPH_SUCCESS);
+	ASSERT_EQUAL(world.TryGetCoordinates("bloomfield", &point),
+				 WORLD_SUCCESS);
+	ASSERT_EQUAL(point.x, 12);
+	ASSERT_EQUAL(point.y, 11);
+	ASSERT_EQUAL(world.TryGetCoordinates("cooper", &point), WORLD_SUCCESS);
+	ASSERT_EQUAL(point.x, 12);
+	ASSERT_EQUAL(point.y, 12);
+	return true;
+}
@@ -0,0 +1,96 @@
+#include "thread_pool.h"
+
+using namespace mtm::pokemongo;
+
+ThreadPool::ThreadPool(int threads_num)
+	: task(NULL), count(0), generation(0), busy_workers(0), stopping(false),
+	  error(), next_index(0) {
+	for (int i = 1; i < threads_num; i++) {
+		workers.push_back(std::thread(&ThreadPool::WorkerLoop, this));
+	}
+}
+
+ThreadPool::~ThreadPool() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	work_ready.notify_all();
+	for (std::thread& worker : workers) {
+		worker.join();
+	}
+}
+
+int ThreadPool::Size() const {
+	return (int)workers.size() + 1;
+}
+
+void ThreadPool::RunTasks(const std::function<void(size_t)>* current_task,
+						  size_t current_count) {
+	while (true) {
+		size_t index = next_index++;
+		if (index >= current_count) return;
+		try {
+			(*current_task)(index);
+		}
+		catch (...) {
+			std::lock_guard<std::mutex> lock(mutex);
+			if (!error) error = std::current_exception();
+		}
+	}
+}
+
+void ThreadPool::WorkerLoop() {
+	unsigned long seen_generation = 0;
+	std::unique_lock<std::mutex> lock(mutex);
+	while (true) {
+		work_ready.wait(lock, [&] {
+			return stopping || generation != seen_generation;
+		});
+		if (stopping) return;
+		// Take the job's details while holding the lock, so a late wake up
+		// never touches a job which already finished
+		seen_generation = generation;
+		const std::function<void(size_t)>* current_task = task;
+		size_t current_count = count;
+		busy_workers++;
+		lock.unlock();
+		RunTasks(current_task, current_count);
+		lock.lock();
+		if (--busy_workers == 0) work_done.notify_all();
+	}
+}
+
+void ThreadPool::ParallelFor(size_t count,
+							 const std::function<void(size_t)>& task) {
+	if (count == 0) return;
+	if (workers.empty() || count == 1) {
+		// Nothing to share, don't pay for waking the workers
+		for (size_t i = 0; i < count; i++) {
+			task(i);
+		}
+		return;
+	}
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		// A worker which woke up late for the previous job may still be
+		// looking at next_index
+		work_done.wait(lock, [&] { return busy_workers == 0; });
+		this->task = &task;
+		this->count = count;
+		next_index = 0;
+		error = std::exception_ptr();
+		generation++;
+	}
+	work_ready.notify_all();
+	RunTasks(&task, count);
+
+	std::exception_ptr task_error;
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		work_done.wait(lock, [&] { return busy_workers == 0; });
+		this->task = NULL;
+		task_error = error;
+	}
+	if (task_error) std::rethrow_exception(task_error);
+}
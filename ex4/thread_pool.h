@@ -0,0 +1,71 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace mtm {
+namespace pokemongo {
+
+// A fixed size pool of worker threads. Used for running independent pieces
+// of game work (shards of a tick, tournament matches...) in parallel.
+class ThreadPool {
+public:
+	// Constructs a new pool.
+	//
+	// @param threads_num number of threads running tasks, including the
+	//		  thread calling ParallelFor. 1 or less means no worker threads.
+	explicit ThreadPool(int threads_num);
+
+	// Stops and joins all worker threads.
+	~ThreadPool();
+
+	// Disable copy and assignment.
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	// Runs task(0) ... task(count - 1), spread over the pool threads and the
+	// calling thread. Returns only after all of them finished.
+	//
+	// @param count number of tasks to run.
+	// @param task the function to run for each task index.
+	// @throw the first exception thrown by one of the tasks, if any.
+	void ParallelFor(size_t count, const std::function<void(size_t)>& task);
+
+	// Returns the number of threads running tasks, including the caller.
+	int Size() const;
+
+private:
+	// Main loop of a worker thread: waits for work and runs it
+	void WorkerLoop();
+
+	// Claims and runs task indices until none are left
+	void RunTasks(const std::function<void(size_t)>* current_task,
+				  size_t current_count);
+
+	std::vector<std::thread> workers;
+	std::mutex mutex;
+	std::condition_variable work_ready;
+	std::condition_variable work_done;
+
+	// Current job, guarded by mutex
+	const std::function<void(size_t)>* task;
+	size_t count;
+	unsigned long generation;
+	int busy_workers;
+	bool stopping;
+	std::exception_ptr error;
+
+	std::atomic<size_t> next_index;
+};
+
+}  // namespace pokemongo
+}  // namespace mtm
+
+#endif  // THREAD_POOL_H
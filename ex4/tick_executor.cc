@@ -0,0 +1,199 @@
+#include "tick_executor.h"
+
+#include <algorithm>
+#include <functional>
+#include <tuple>
+#include <utility>
+
+#include "journal.h"
+
+using namespace mtm::pokemongo;
+
+// Number of shards a wave is split into, for each thread running the tick
+#define SHARDS_PER_THREAD	4
+
+TickExecutor::TickExecutor(PokemonGo & game, int threads_num)
+	: game(game), pool(threads_num), next_sequence_number(0), waves_num(0) {}
+
+unsigned long TickExecutor::Submit(const GameCommand & command) {
+	queued.push_back(command);
+	return next_sequence_number++;
+}
+
+int TickExecutor::LastTickWaves() const {
+	return waves_num;
+}
+
+PokemonGoStatus TickExecutor::PlanAdd(PlannedCommand & planned) {
+	const GameCommand& command = *planned.command;
+	// Same checks, in the same order, as PokemonGo::AddTrainer
+	if (command.trainer_name.empty()) return POKEMONGO_INVALID_ARGS;
+	if (game.trainers.find(command.trainer_name) != game.trainers.end()) {
+		return POKEMONGO_TRAINER_NAME_ALREADY_USED;
+	}
+	if (game.world->TryGetLocation(command.location,
+								   &planned.destination_location) !=
+		WORLD_SUCCESS) {
+		return POKEMONGO_LOCATION_NOT_FOUND;
+	}
+	planned.trainer = &game.trainers.emplace(std::piecewise_construct,
+		std::forward_as_tuple(command.trainer_name),
+		std::forward_as_tuple(command.trainer_name, command.team)).
+		first->second;
+	game.leaderboard.Add(command.trainer_name, *planned.trainer);
+	if (game.record_movements) {
+		game.StartMovementHistory(command.trainer_name, *planned.trainer,
+								  command.location);
+	}
+	game.events.RecordArrival(command.location, planned.destination_location,
+							  command.trainer_name);
+	planned.destination = command.location;
+	predicted_locations[command.trainer_name] = command.location;
+
+	planned.wave = 0;
+	std::unordered_map<const Location*, int>::iterator location_wave =
+		location_waves.find(planned.destination_location);
+	if (location_wave != location_waves.end()) {
+		planned.wave = location_wave->second + 1;
+	}
+	return POKEMONGO_SUCCESS;
+}
+
+PokemonGoStatus TickExecutor::PlanMove(PlannedCommand & planned) {
+	const GameCommand& command = *planned.command;
+	std::unordered_map<std::string, Trainer>::iterator found =
+		game.trainers.find(command.trainer_name);
+	if (found == game.trainers.end()) return POKEMONGO_TRAINER_NOT_FOUND;
+	planned.trainer = &found->second;
+
+	std::unordered_map<std::string, std::string>::iterator predicted =
+		predicted_locations.find(command.trainer_name);
+	const std::string& source = predicted != predicted_locations.end() ?
+		predicted->second : planned.trainer->current_location_name;
+	switch (game.world->TryNeighbor(source, command.direction,
+									&planned.destination)) {
+	case WORLD_INVALID_DIRECTION:
+		return POKEMONGO_INVALID_DIRECTION;
+	case WORLD_REACHED_DEAD_END:
+		METRICS_COUNT(METRIC_DEAD_ENDS);
+		return POKEMONGO_REACHED_DEAD_END;
+	default:
+		break;
+	}
+	game.world->TryGetLocation(planned.destination,
+							   &planned.destination_location);
+	Location* source_location = NULL;
+	game.world->TryGetLocation(source, &source_location);
+
+	planned.wave = 0;
+	std::unordered_map<const Trainer*, int>::iterator trainer_wave =
+		trainer_waves.find(planned.trainer);
+	if (trainer_wave != trainer_waves.end()) {
+		planned.wave = trainer_wave->second + 1;
+	}
+	const Location* touched[] = { source_location,
+								  planned.destination_location };
+	for (const Location* location : touched) {
+		std::unordered_map<const Location*, int>::iterator location_wave =
+			location_waves.find(location);
+		if (location_wave != location_waves.end()) {
+			planned.wave = std::max(planned.wave, location_wave->second + 1);
+		}
+	}
+	location_waves[source_location] = planned.wave;
+	// Events are recorded in submission order, before the waves run
+	game.events.RecordDeparture(source, source_location, command.trainer_name);
+	game.events.RecordArrival(planned.destination,
+							  planned.destination_location,
+							  command.trainer_name);
+	if (planned.trainer->movement_history != NULL) {
+		planned.trainer->movement_history->Append(command.direction,
+												  planned.destination);
+	}
+	// Store the prediction last, source may refer to the old one
+	predicted_locations[command.trainer_name] = planned.destination;
+	return POKEMONGO_SUCCESS;
+}
+
+void TickExecutor::Plan() {
+	planned.assign(queued.size(), PlannedCommand());
+	results.assign(queued.size(), POKEMONGO_SUCCESS);
+	waves_num = 0;
+	for (size_t i = 0; i < queued.size(); i++) {
+		PlannedCommand& current = planned[i];
+		current.command = &queued[i];
+		current.trainer = NULL;
+		current.destination_location = NULL;
+		current.wave = -1;
+		if (queued[i].type == ADD_TRAINER) {
+			results[i] = PlanAdd(current);
+		} else {
+			results[i] = PlanMove(current);
+		}
+		if (results[i] != POKEMONGO_SUCCESS) {
+			current.wave = -1;
+			continue;
+		}
+		trainer_waves[current.trainer] = current.wave;
+		location_waves[current.destination_location] = current.wave;
+		waves_num = std::max(waves_num, current.wave + 1);
+	}
+}
+
+void TickExecutor::RunWave(const std::vector<PlannedCommand*>& wave) {
+	size_t shards_num = std::min(wave.size(),
+								 (size_t)pool.Size() * SHARDS_PER_THREAD);
+	std::vector<std::vector<PlannedCommand*> > shards(shards_num);
+	std::hash<const Location*> location_hash;
+	for (PlannedCommand* current : wave) {
+		shards[location_hash(current->destination_location) % shards_num].
+			push_back(current);
+	}
+	pool.ParallelFor(shards_num, [&](size_t shard) {
+		for (PlannedCommand* current : shards[shard]) {
+			if (current->command->type == ADD_TRAINER) {
+				game.PlaceTrainer(*current->trainer, current->destination);
+			} else {
+				game.RelocateTrainer(*current->trainer, current->destination);
+			}
+		}
+	});
+}
+
+void TickExecutor::EndTick() {
+	queued.clear();
+	predicted_locations.clear();
+	trainer_waves.clear();
+	location_waves.clear();
+}
+
+const std::vector<PokemonGoStatus>& TickExecutor::RunTick() {
+	try {
+		Plan();
+		std::vector<std::vector<PlannedCommand*> > waves(waves_num);
+		for (PlannedCommand& current : planned) {
+			if (current.wave >= 0) waves[current.wave].push_back(&current);
+		}
+		for (const std::vector<PlannedCommand*>& wave : waves) {
+			RunWave(wave);
+		}
+		if (game.journal != NULL) {
+			for (size_t i = 0; i < queued.size(); i++) {
+				game.journal->RecordCommand(queued[i], results[i]);
+			}
+		}
+
+		game.PublishEvents();
+	}
+	catch (...) {
+		// The commands of a failed tick aren't run again by the next one
+		EndTick();
+		throw;
+	}
+	EndTick();
+	return results;
+}
+
+size_t TickExecutor::Queued() const {
+	return queued.size();
+}
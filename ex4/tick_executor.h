@@ -0,0 +1,110 @@
+#ifndef TICK_EXECUTOR_H
+#define TICK_EXECUTOR_H
+
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "command.h"
+#include "pokemon_go.h"
+#include "status.h"
+#include "thread_pool.h"
+
+namespace mtm {
+namespace pokemongo {
+
+// Applies game commands in ticks, running independent commands of a tick in
+// parallel.
+//
+// Commands are numbered by submission order. Two commands conflict if they
+// touch the same trainer or the same location (the one a trainer leaves or
+// the one they arrive at, where gym battles and item/Pokemon hand outs
+// happen). A tick is split into waves: a command is put in the first wave
+// after every earlier command it conflicts with, so conflicting commands
+// always run in submission order. Commands of a wave are sharded by
+// destination location and the shards run in parallel. The resulting game
+// state and command results are identical to calling the PokemonGo functions
+// one by one in submission order.
+class TickExecutor {
+public:
+	// Constructs a new executor applying commands on the given game.
+	//
+	// @param game the game to change. Must outlive the executor, and must not
+	//		  be changed in any other way while a tick runs.
+	// @param threads_num number of threads running a tick.
+	TickExecutor(PokemonGo& game, int threads_num);
+
+	// Disable copy and assignment.
+	TickExecutor(const TickExecutor&) = delete;
+	TickExecutor& operator=(const TickExecutor&) = delete;
+
+	// Queues a command for the next tick.
+	//
+	// @param command the command to queue.
+	// @return the sequence number of the command.
+	unsigned long Submit(const GameCommand& command);
+
+	// Applies all commands queued since the last tick. If the game has a
+	// journal, the commands are recorded in it by submission order. The
+	// events of the tick are then published to the game's subscriptions.
+	// If applying throws, the commands are dropped from the queue, and the
+	// exception is passed on.
+	//
+	// @return the result of every command of the tick, by submission order.
+	const std::vector<PokemonGoStatus>& RunTick();
+
+	// Returns the number of commands queued for the next tick.
+	size_t Queued() const;
+
+	// Returns the number of waves the last tick was split into.
+	int LastTickWaves() const;
+
+private:
+	// A command of the current tick after planning
+	struct PlannedCommand {
+		const GameCommand* command;
+		Trainer* trainer;
+		std::string destination;
+		Location* destination_location;
+		int wave;
+	};
+
+	// Computes the result of every command against the state the game will
+	// have when the command runs, and places the command in a wave.
+	// New trainers are inserted to the game here, so the trainers map is
+	// never changed while the waves run.
+	void Plan();
+
+	// Checks the command against the predicted game state.
+	//
+	// @return POKEMONGO_SUCCESS if the command should be applied.
+	PokemonGoStatus PlanAdd(PlannedCommand& planned);
+	PokemonGoStatus PlanMove(PlannedCommand& planned);
+
+	// Runs the successful commands of a single wave
+	void RunWave(const std::vector<PlannedCommand*>& wave);
+
+	// Clears the commands and predictions of the tick
+	void EndTick();
+
+	PokemonGo& game;
+	ThreadPool pool;
+
+	unsigned long next_sequence_number;
+	std::vector<GameCommand> queued;
+	std::vector<PlannedCommand> planned;
+	std::vector<PokemonGoStatus> results;
+	int waves_num;
+
+	// Predicted location of every trainer touched by the current tick
+	std::unordered_map<std::string, std::string> predicted_locations;
+	// Last wave which touched each trainer and location
+	std::unordered_map<const Trainer*, int> trainer_waves;
+	std::unordered_map<const Location*, int> location_waves;
+};
+
+}  // namespace pokemongo
+}  // namespace mtm
+
+#endif  // TICK_EXECUTOR_H
@@ -0,0 +1,133 @@
+#include "tournament.h"
+
+#include <algorithm>
+
+#include "exceptions.h"
+
+#define WIN_POINTS	2
+#define DRAW_POINTS	1
+
+using namespace mtm::pokemongo;
+
+const long MatchResult::NO_WINNER;
+
+namespace {
+
+// Battles the copies of two entrants
+//
+// @return the index of the winner, or NO_WINNER
+long Battle(Trainer& trainer_1, Trainer& trainer_2, size_t index_1,
+			size_t index_2) {
+	try {
+		return (long)(TrainersBattle(trainer_1, trainer_2) == &trainer_1 ?
+			index_1 : index_2);
+	} catch (const TrainerInvalidArgsException&) {
+		return MatchResult::NO_WINNER;
+	}
+}
+
+// Counts a match in the standings of both of its entrants
+void CountMatch(const MatchResult& match, std::vector<Standing>& standings) {
+	Standing& standing_1 = standings[match.trainer_1];
+	Standing& standing_2 = standings[match.trainer_2];
+	if (match.winner == MatchResult::NO_WINNER) {
+		standing_1.draws++;
+		standing_2.draws++;
+	} else if (match.winner == (long)match.trainer_1) {
+		standing_1.wins++;
+		standing_2.losses++;
+	} else {
+		standing_2.wins++;
+		standing_1.losses++;
+	}
+}
+
+void RunRoundRobin(const std::vector<const Trainer*>& entrants,
+				   ThreadPool& pool, TournamentResults& results) {
+	for (size_t i = 0; i < entrants.size(); i++) {
+		for (size_t j = i + 1; j < entrants.size(); j++) {
+			MatchResult match = {0, i, j, MatchResult::NO_WINNER};
+			results.matches.push_back(match);
+		}
+	}
+	// Every match writes only its own result, so they can run in any order
+	pool.ParallelFor(results.matches.size(), [&](size_t i) {
+		MatchResult& match = results.matches[i];
+		Trainer trainer_1(*entrants[match.trainer_1]);
+		Trainer trainer_2(*entrants[match.trainer_2]);
+		match.winner = Battle(trainer_1, trainer_2, match.trainer_1,
+							  match.trainer_2);
+	});
+	for (const MatchResult& match : results.matches) {
+		CountMatch(match, results.standings);
+	}
+	for (Standing& standing : results.standings) {
+		standing.points = standing.wins * WIN_POINTS +
+			standing.draws * DRAW_POINTS;
+	}
+}
+
+void RunSingleElimination(const std::vector<const Trainer*>& entrants,
+						  ThreadPool& pool, TournamentResults& results) {
+	// Reserved, so the copies never move while matches run
+	std::vector<Trainer> copies;
+	copies.reserve(entrants.size());
+	for (const Trainer* entrant : entrants) {
+		copies.emplace_back(*entrant);
+	}
+	std::vector<size_t> alive;
+	for (size_t i = 0; i < entrants.size(); i++) {
+		alive.push_back(i);
+	}
+	for (size_t round = 0; alive.size() > 1; round++) {
+		size_t first = results.matches.size();
+		for (size_t i = 0; i + 1 < alive.size(); i += 2) {
+			MatchResult match = {round, alive[i], alive[i + 1],
+								 MatchResult::NO_WINNER};
+			results.matches.push_back(match);
+		}
+		// Every entrant is in one match of the round at most
+		pool.ParallelFor(results.matches.size() - first, [&](size_t i) {
+			MatchResult& match = results.matches[first + i];
+			match.winner = Battle(copies[match.trainer_1],
+								  copies[match.trainer_2], match.trainer_1,
+								  match.trainer_2);
+		});
+		std::vector<size_t> next;
+		for (size_t i = first; i < results.matches.size(); i++) {
+			const MatchResult& match = results.matches[i];
+			CountMatch(match, results.standings);
+			next.push_back(match.winner == MatchResult::NO_WINNER ?
+				match.trainer_1 : (size_t)match.winner);
+		}
+		if (alive.size() % 2 == 1) next.push_back(alive.back());
+		for (size_t trainer : next) {
+			results.standings[trainer].points++;
+		}
+		alive.swap(next);
+	}
+}
+
+}  // namespace
+
+TournamentResults mtm::pokemongo::RunTournament(
+	const std::vector<const Trainer*>& entrants, TournamentFormat format,
+	ThreadPool& pool) {
+	TournamentResults results;
+	results.entrants = entrants;
+	for (size_t i = 0; i < entrants.size(); i++) {
+		Standing standing = {i, 0, 0, 0, 0};
+		results.standings.push_back(standing);
+	}
+	if (format == TOURNAMENT_ROUND_ROBIN) {
+		RunRoundRobin(entrants, pool, results);
+	} else {
+		RunSingleElimination(entrants, pool, results);
+	}
+	// Stable, so entrants with equal points stay ordered by index
+	std::stable_sort(results.standings.begin(), results.standings.end(),
+					 [](const Standing& lhs, const Standing& rhs) {
+		return lhs.points > rhs.points;
+	});
+	return results;
+}
@@ -0,0 +1,83 @@
+#ifndef TOURNAMENT_H
+#define TOURNAMENT_H
+
+#include <cstddef>
+#include <vector>
+
+#include "thread_pool.h"
+#include "trainer.h"
+
+namespace mtm {
+namespace pokemongo {
+
+typedef enum {
+	// Every entrant battles every other entrant once
+	TOURNAMENT_ROUND_ROBIN,
+	// Entrants are paired in every round, and only the winners go on
+	TOURNAMENT_SINGLE_ELIMINATION,
+} TournamentFormat;
+
+// The result of one battle in a tournament. Entrants are referred to by
+// their index in the entrants of the tournament.
+struct MatchResult {
+	// Returned as the winner of a match which had none
+	static const long NO_WINNER = -1;
+
+	// The round of the match, from 0. Every match of a round robin is in
+	// round 0.
+	size_t round;
+
+	size_t trainer_1;
+	size_t trainer_2;
+
+	// Index of the winner, or NO_WINNER if the battle couldn't be decided,
+	// which happens when two trainers of the same team tie
+	long winner;
+};
+
+// The standing of one entrant at the end of a tournament.
+struct Standing {
+	size_t trainer;
+	unsigned int wins;
+	unsigned int losses;
+	unsigned int draws;
+
+	// Round robin: 2 per win and 1 per draw.
+	// Single elimination: the number of rounds the entrant went on from,
+	// including byes, and one more for the champion.
+	unsigned int points;
+};
+
+struct TournamentResults {
+	// The trainers, by entrant index
+	std::vector<const Trainer*> entrants;
+
+	// The matches, by round and then by the entrants' order
+	std::vector<MatchResult> matches;
+
+	// All entrants, by descending points. Entrants with equal points are
+	// ordered by their index.
+	std::vector<Standing> standings;
+};
+
+// Runs a tournament on copies of the given trainers, so the trainers
+// themselves don't change. Independent matches run in parallel on a pool,
+// and the results don't depend on the number of threads.
+//
+// In a round robin every match battles fresh copies of both trainers. In a
+// single elimination every entrant gets a single copy, which carries the
+// results of its battles on to the next round. Entrants are paired by index
+// in every round, and the last one of an odd round gets a bye. A match with
+// no winner is won by the entrant with the lower index.
+//
+// @param entrants the trainers in the tournament.
+// @param format the format of the tournament.
+// @param pool the threads to run the matches on.
+// @return the results of the tournament.
+TournamentResults RunTournament(const std::vector<const Trainer*>& entrants,
+								TournamentFormat format, ThreadPool& pool);
+
+}  // namespace pokemongo
+}  // namespace mtm
+
+#endif  // TOURNAMENT_H
@@ -1,29 +1,95 @@
-#include <algorithm>
+#include <atomic>
+#include <utility>
 
 #include "trainer.h"
 #include "exceptions.h"
+#include "metrics.h"
 
 #define LOSER_TRAINER_LEVEL_FACTOR	2
 #define TRAINER_WIN_POINTS			2
 #define TRAINER_LOSE_POINTS			-1
 #define GYM_LEADER_POINTS			10
-#define STRING_TEAM					{"BLUE", "YELLOW", "RED"}
 
 using namespace mtm::pokemongo;
 
+const char* const mtm::pokemongo::TEAM_NAMES[] = {"BLUE", "YELLOW", "RED"};
+
+namespace {
+
+// Returns a trainer id which was never returned before
+unsigned long long NewTrainerId() {
+	static std::atomic<unsigned long long> next_id(0);
+	return next_id++;
+}
+
+}  // namespace
+
 Trainer::Trainer(const std::string & name, const Team & team)
-	: is_leader(false), name(name), team(team), level(1), pokemons(),
-	  battle_score_history(0) {
+	: is_leader(false), movement_history(NULL), name(name), team(team),
+	  level(1), pokemons(), killed(),
+	  pokemons_by_strength(StrongerFirst(pokemons)), battle_score_history(0),
+	  id(NewTrainerId()), version(0), observer(NULL),
+	  strength_observer(NULL) {
 	if (name.size() == 0) throw TrainerInvalidArgsException();
 }
 
-Trainer::~Trainer() {
-	std::vector<Item*>::iterator current_item;
-	// Delete all items
-	for (current_item = items.begin(); current_item != items.end();
-		 current_item++) {
-		delete *current_item;
+Trainer::Trainer(const Trainer & trainer)
+	: InstanceAccounted(trainer), is_leader(trainer.is_leader),
+	  current_location_name(trainer.current_location_name),
+	  movement_history(NULL), name(trainer.name), team(trainer.team),
+	  level(trainer.level), pokemons(trainer.pokemons),
+	  killed(trainer.killed), pokemons_by_strength(StrongerFirst(pokemons)),
+	  battle_score_history(trainer.battle_score_history),
+	  items(trainer.items), id(NewTrainerId()), version(0),
+	  observer(NULL), strength_observer(NULL) {
+	// The positions are the same, but they must be compared by the copied
+	// pokemons. They're already sorted, so this takes linear time.
+	pokemons_by_strength.insert(trainer.pokemons_by_strength.begin(),
+								trainer.pokemons_by_strength.end());
+}
+
+Trainer::Trainer(Trainer && trainer)
+	: is_leader(trainer.is_leader),
+	  current_location_name(std::move(trainer.current_location_name)),
+	  movement_history(NULL), name(std::move(trainer.name)),
+	  team(trainer.team), level(trainer.level),
+	  pokemons(std::move(trainer.pokemons)),
+	  killed(std::move(trainer.killed)),
+	  pokemons_by_strength(StrongerFirst(pokemons)),
+	  battle_score_history(trainer.battle_score_history),
+	  items(std::move(trainer.items)), id(NewTrainerId()), version(0),
+	  observer(NULL), strength_observer(NULL) {
+	pokemons_by_strength.insert(trainer.pokemons_by_strength.begin(),
+								trainer.pokemons_by_strength.end());
+	trainer.pokemons.clear();
+	trainer.killed.clear();
+	trainer.pokemons_by_strength.clear();
+	trainer.StrengthChanged();
+}
+
+bool Trainer::HasPokemons() const {
+	return !pokemons_by_strength.empty();
+}
+
+void Trainer::CompactPokemons() {
+	std::vector<size_t> new_positions(pokemons.size());
+	size_t kept = 0;
+	for (size_t i = 0; i < pokemons.size(); i++) {
+		if (killed[i]) continue;
+		if (kept != i) pokemons[kept] = std::move(pokemons[i]);
+		new_positions[i] = kept++;
+	}
+	pokemons.erase(pokemons.begin() + kept, pokemons.end());
+	killed.assign(kept, false);
+	// The pokemons keep their order, so the index keeps its order too, and
+	// is refilled in linear time
+	std::vector<size_t> by_strength;
+	by_strength.reserve(kept);
+	for (size_t position : pokemons_by_strength) {
+		by_strength.push_back(new_positions[position]);
 	}
+	pokemons_by_strength.clear();
+	pokemons_by_strength.insert(by_strength.begin(), by_strength.end());
 }
 
 Pokemon& Trainer::GetStrongestPokemon() {
@@ -32,26 +98,40 @@ Pokemon& Trainer::GetStrongestPokemon() {
 }
 
 const Pokemon & Trainer::GetStrongestPokemon() const {
-	if (pokemons.empty()) throw TrainerNoPokemonsFoundException();
-	const Pokemon *strongestPokemon = &pokemons[0];
-	for (const Pokemon& pokemon : pokemons) {
-		if (pokemon > *strongestPokemon) {
-			strongestPokemon = &pokemon;
-		}
-	}
-	return *strongestPokemon;
+	if (!HasPokemons()) throw TrainerNoPokemonsFoundException();
+	return pokemons[*pokemons_by_strength.begin()];
 }
 
 void Trainer::KillStrongestPokemon() {
-	if (pokemons.empty()) throw TrainerNoPokemonsFoundException();
-	pokemons.erase(std::find(pokemons.begin(), pokemons.end(),
-							 GetStrongestPokemon()));
+	if (!HasPokemons()) throw TrainerNoPokemonsFoundException();
+	killed[*pokemons_by_strength.begin()] = true;
+	pokemons_by_strength.erase(pokemons_by_strength.begin());
+	// Dropping the killed pokemons once they're half of them takes constant
+	// time per kill
+	if (pokemons_by_strength.size() < pokemons.size() / 2) CompactPokemons();
+	StrengthChanged();
+}
+
+Trainer::StrongerFirst::StrongerFirst(const PokemonsByCatch& pokemons)
+	: pokemons(&pokemons) {}
+
+bool Trainer::StrongerFirst::operator()(size_t lhs, size_t rhs) const {
+	if ((*pokemons)[lhs] > (*pokemons)[rhs]) return true;
+	if ((*pokemons)[lhs] < (*pokemons)[rhs]) return false;
+	return lhs < rhs;
+}
+
+void Trainer::AddPokemon(Pokemon && pokemon) {
+	pokemons.push_back(std::move(pokemon));
+	killed.push_back(false);
+	pokemons_by_strength.insert(pokemons.size() - 1);
+	StrengthChanged();
 }
 
 int Trainer::compareTrainer(const Trainer & rhs) const {
-	if (pokemons.empty() && rhs.pokemons.empty()) return 0;
-	if (pokemons.empty()) return -1;
-	if (rhs.pokemons.empty()) return 1;
+	if (!HasPokemons() && !rhs.HasPokemons()) return 0;
+	if (!HasPokemons()) return -1;
+	if (!rhs.HasPokemons()) return 1;
 	if (GetStrongestPokemon() > rhs.GetStrongestPokemon()) return 1;
 	if (GetStrongestPokemon() < rhs.GetStrongestPokemon()) return -1;
 	return 0;
@@ -83,13 +163,65 @@ Team Trainer::GetTeam() const {
 	return team;
 }
 
+const std::string & Trainer::GetName() const {
+	return name;
+}
+
+int Trainer::Level() const {
+	return level;
+}
+
+unsigned long long Trainer::Id() const {
+	return id;
+}
+
+unsigned long long Trainer::Version() const {
+	return version;
+}
+
+void Trainer::Changed() {
+	version++;
+}
+
+void Trainer::StrengthChanged() {
+	Changed();
+	if (strength_observer != NULL) strength_observer->StrengthChanged(*this);
+}
+
+void Trainer::SetLeader(bool leader) {
+	if (is_leader == leader) return;
+	int old_score = TotalScore();
+	is_leader = leader;
+	ScoreChanged(old_score);
+}
+
+void Trainer::SetObserver(TrainerObserver * observer) {
+	this->observer = observer;
+}
+
+void Trainer::SetStrengthObserver(TrainerStrengthObserver * observer) {
+	strength_observer = observer;
+}
+
+void Trainer::ScoreChanged(int old_score) {
+	if (observer != NULL && TotalScore() != old_score) {
+		observer->ScoreChanged(*this, old_score);
+	}
+}
+
 bool Trainer::TryToCatch(Pokemon & pokemon) {
 	if (pokemon.Level() > level) return false;
-	pokemons.push_back(pokemon);
+	AddPokemon(Pokemon(pokemon));
 	return true;
 }
 
-int Trainer::TotalScore() {
+bool Trainer::TryToCatch(Pokemon && pokemon) {
+	if (pokemon.Level() > level) return false;
+	AddPokemon(std::move(pokemon));
+	return true;
+}
+
+int Trainer::TotalScore() const {
 	return level + battle_score_history +
 		(is_leader ? GYM_LEADER_POINTS : 0);
 }
@@ -97,41 +229,80 @@ int Trainer::TotalScore() {
 bool Trainer::AddItem(Item* item) {
 	if (NULL == item) throw TrainerInvalidArgsException();
 
-	if (item->level > level) return false;
-	items.push_back(item);
+	if (!AddItem(item->Value())) return false;
+	delete item;
+	return true;
+}
+
+bool Trainer::AddItem(const ItemValue & item) {
+	if (item.Level() > level) return false;
+	items.PushBack(item);
+	Changed();
 	return true;
 }
 
-void Trainer::BoostPokemon(Pokemon& pokemon) {
-	if (items.empty()) return;
-	std::vector<Item*>::iterator first_item = items.begin();
-	(*first_item)->Use(pokemon);
-	delete *first_item;
-	items.erase(first_item);
+void Trainer::BoostStrongestPokemon() {
+	if (items.Empty() || !HasPokemons()) return;
+	// The item may change the pokemon's strength, so it's reindexed
+	size_t strongest = *pokemons_by_strength.begin();
+	pokemons_by_strength.erase(pokemons_by_strength.begin());
+	items.Front().Use(pokemons[strongest]);
+	items.PopFront();
+	pokemons_by_strength.insert(strongest);
+	StrengthChanged();
 }
 
 std::ostream & mtm::pokemongo::operator<<(std::ostream & output,
 	const Trainer & trainer) {
-	std::string teams_strings[] = STRING_TEAM;
 	output << trainer.name << " (" << trainer.level << ") "
-		<< teams_strings[trainer.team] << std::endl;
-	for (const Pokemon& pokemon : trainer.pokemons) {
-		output << pokemon;
+		<< TEAM_NAMES[trainer.team] << std::endl;
+	for (size_t i = 0; i < trainer.pokemons.size(); i++) {
+		if (!trainer.killed[i]) output << trainer.pokemons[i];
 	}
 	return output;
 }
 
 void Trainer::RaiseLevel(Trainer& loser) {
-	level += loser.level / LOSER_TRAINER_LEVEL_FACTOR + 
-		(loser.level % LOSER_TRAINER_LEVEL_FACTOR ? 1 : 0);
+	int old_score = TotalScore();
+	level += LevelGain(loser.level);
+	Changed();
+	ScoreChanged(old_score);
+}
+
+int Trainer::LevelGain(int loser_level) {
+	return loser_level / LOSER_TRAINER_LEVEL_FACTOR +
+		(loser_level % LOSER_TRAINER_LEVEL_FACTOR ? 1 : 0);
 }
 
 void Trainer::UpdateBattleScoreHistory(Trainer & winner) {
+	int old_score = TotalScore();
 	if (this == &winner) {
 		battle_score_history += TRAINER_WIN_POINTS;
 	} else {
 		battle_score_history += TRAINER_LOSE_POINTS;
 	}
+	ScoreChanged(old_score);
+}
+
+// See whether the first team beats the second one
+//
+// @throws TrainerInvalidArgsException if both teams are the same
+
+// @param team_1 team of the first trainer in battle
+// @param team_2 team of the second trainer in battle
+// @return true if the first team wins
+static bool FirstTeamPrefered(Team team_1, Team team_2) {
+	if (team_1 == team_2) {
+		throw TrainerInvalidArgsException();
+	}
+	if (team_1 == BLUE) {
+		return team_2 != YELLOW;
+	}
+	if (team_1 == RED) {
+		return team_2 == YELLOW;
+	} else { // team_1 is yellow
+		return team_2 == BLUE;
+	}
 }
 
 // See which trainer is better according to his team
@@ -142,48 +313,34 @@ void Trainer::UpdateBattleScoreHistory(Trainer & winner) {
 // @param trainer_2 second trainer in battle
 // @return pointer to the winning trainer!
 Trainer* PreferedTrainerByTeam(Trainer& trainer_1,Trainer& trainer_2) {
-	
-	if (trainer_1.GetTeam() == trainer_2.GetTeam()) {
-		throw TrainerInvalidArgsException();
-	}
-	if (trainer_1.GetTeam() == BLUE) {
-		if (trainer_2.GetTeam() == YELLOW) {
-			return &trainer_2;
-		} else {
-			return &trainer_1;
-		}
-	}
-	if (trainer_1.GetTeam() == RED) {
-		if (trainer_2.GetTeam() == YELLOW) {
-			return &trainer_1;
-		} else {
-			return &trainer_2;
-		}
-	} else { // trainer_1 team is yellow
-		if (trainer_2.GetTeam() == BLUE) {
-			return &trainer_1;
-		} else {
-			return &trainer_2;
-		}
-	}
+	return FirstTeamPrefered(trainer_1.GetTeam(), trainer_2.GetTeam()) ?
+		&trainer_1 : &trainer_2;
 }
 
 Trainer* mtm::pokemongo::TrainersBattleWithPokemons(Trainer& trainer_1,
 	Trainer& trainer_2)  {
 	Trainer* winner = NULL;
+	trainer_1.BoostStrongestPokemon();
+	trainer_2.BoostStrongestPokemon();
+	// Boosting only makes a pokemon stronger, so these are the boosted ones
 	Pokemon *pokemon_1 = &trainer_1.GetStrongestPokemon();
 	Pokemon *pokemon_2 = &trainer_2.GetStrongestPokemon();
-	trainer_1.BoostPokemon(*pokemon_1);
-	trainer_2.BoostPokemon(*pokemon_2);
 	if (*pokemon_1 > *pokemon_2) {
 		winner = &trainer_1;
 	} else if (*pokemon_2 > *pokemon_1) {
 		winner = &trainer_2;
 	}
-	if ((*pokemon_1).Hit(*pokemon_2)) {
+	// Both pokemons hit before any of them is removed, so a dead pokemon
+	// still hits back
+	bool pokemon_2_died = pokemon_1->Hit(*pokemon_2);
+	bool pokemon_1_died = pokemon_2->Hit(*pokemon_1);
+	// The hits decide the next battles even if both pokemons survive
+	trainer_1.Changed();
+	trainer_2.Changed();
+	if (pokemon_2_died) {
 		trainer_2.KillStrongestPokemon();
 	}
-	if ((*pokemon_2).Hit(*pokemon_1)) {
+	if (pokemon_1_died) {
 		trainer_1.KillStrongestPokemon();
 	}
 	return winner;
@@ -192,12 +349,13 @@ Trainer* mtm::pokemongo::TrainersBattleWithPokemons(Trainer& trainer_1,
 
 Trainer* mtm::pokemongo::TrainersBattle(Trainer& trainer_1,
 										Trainer& trainer_2) {
+	METRICS_COUNT(METRIC_BATTLES);
 	Trainer *winner = NULL;
-	if (!trainer_1.pokemons.empty() && !trainer_2.pokemons.empty()) {
+	if (trainer_1.HasPokemons() && trainer_2.HasPokemons()) {
 		winner = TrainersBattleWithPokemons(trainer_1, trainer_2);
-	} else if (trainer_1.pokemons.empty() && !trainer_2.pokemons.empty()) {
+	} else if (!trainer_1.HasPokemons() && trainer_2.HasPokemons()) {
 		winner = &trainer_2;
-	} else if (!trainer_1.pokemons.empty() && trainer_2.pokemons.empty()) {
+	} else if (trainer_1.HasPokemons() && !trainer_2.HasPokemons()) {
 		winner = &trainer_1;
 	}
 	// Update the winner's level, if there's a winner already.
@@ -213,3 +371,46 @@ Trainer* mtm::pokemongo::TrainersBattle(Trainer& trainer_1,
 	trainer_2.UpdateBattleScoreHistory(*winner);
 	return winner;
 }
+
+BattlePrediction mtm::pokemongo::PredictBattle(const Trainer& trainer_1,
+											   const Trainer& trainer_2) {
+	BattlePrediction prediction = {};
+	const Trainer* trainers[] = {&trainer_1, &trainer_2};
+	// Index of the winner, or -1 while there's none
+	int winner = -1;
+	if (trainer_1.HasPokemons() && trainer_2.HasPokemons()) {
+		// The battle is played on copies of the strongest pokemons. Copying
+		// resets the HP, but assigning keeps it, so the copies are assigned.
+		Pokemon pokemons[] = {trainer_1.GetStrongestPokemon(),
+							  trainer_2.GetStrongestPokemon()};
+		for (int i = 0; i < 2; i++) {
+			pokemons[i] = trainers[i]->GetStrongestPokemon();
+			if (!trainers[i]->items.Empty()) {
+				trainers[i]->items.Front().Use(pokemons[i]);
+				prediction.uses_item[i] = true;
+			}
+		}
+		if (pokemons[0] > pokemons[1]) {
+			winner = 0;
+		} else if (pokemons[1] > pokemons[0]) {
+			winner = 1;
+		}
+		prediction.loses_pokemon[1] = pokemons[0].Hit(pokemons[1]);
+		prediction.loses_pokemon[0] = pokemons[1].Hit(pokemons[0]);
+	} else if (trainer_2.HasPokemons()) {
+		winner = 1;
+	} else if (trainer_1.HasPokemons()) {
+		winner = 0;
+	}
+	if (winner != -1) {
+		prediction.level_gain[winner] =
+			Trainer::LevelGain(trainers[1 - winner]->level);
+	} else {
+		prediction.decided_by_team = true;
+		winner = FirstTeamPrefered(trainer_1.team, trainer_2.team) ? 0 : 1;
+	}
+	prediction.first_wins = winner == 0;
+	prediction.score_change[winner] = TRAINER_WIN_POINTS;
+	prediction.score_change[1 - winner] = TRAINER_LOSE_POINTS;
+	return prediction;
+}
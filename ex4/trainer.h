@@ -2,15 +2,23 @@
 #define TRAINER_H
 
 #include <iostream>
+#include <set>
 #include <string>
 #include <vector>
 
 #include "pokemon.h"
 #include "item.h"
+#include "memory_accounting.h"
+#include "ring_queue.h"
 
 namespace mtm {
 namespace pokemongo {
 
+class Checkpoint;
+class MovementHistory;
+class ReportWriter;
+class Trainer;
+
 // Teams in game.
 typedef enum {
 	BLUE,
@@ -18,7 +26,58 @@ typedef enum {
 	RED,
 } Team;
 
-class Trainer {
+// Names of the teams, as trainers are printed, indexed by Team
+extern const char* const TEAM_NAMES[];
+
+// The outcome of a battle between two trainers, as TrainersBattle would
+// produce it. Index 0 describes the first trainer and index 1 the second.
+struct BattlePrediction {
+	// True if the first trainer wins, false if the second one does
+	bool first_wins;
+
+	// True if neither trainer had a stronger Pokemon, so the teams decided
+	// the winner and no level was gained
+	bool decided_by_team;
+
+	// Levels gained by each trainer
+	int level_gain[2];
+
+	// Change of each trainer's battle score
+	int score_change[2];
+
+	// Whether each trainer uses its oldest item on its strongest Pokemon
+	bool uses_item[2];
+
+	// Whether each trainer's strongest Pokemon dies
+	bool loses_pokemon[2];
+};
+
+// Notified whenever the total score of a trainer it observes changes.
+class TrainerObserver {
+public:
+	virtual ~TrainerObserver() {}
+
+	// Called after the score of a trainer changed.
+	//
+	// @param trainer the trainer, with its new score.
+	// @param old_score the score of the trainer before the change.
+	virtual void ScoreChanged(const Trainer& trainer, int old_score) = 0;
+};
+
+// Notified whenever the strength of a trainer it observes, that is its
+// strongest Pokemon, changes.
+class TrainerStrengthObserver {
+public:
+	virtual ~TrainerStrengthObserver() {}
+
+	// Called after the strength of a trainer changed. Anything ordered by
+	// the old strength must be reordered without comparing the trainer.
+	//
+	// @param trainer the trainer, with its new strength.
+	virtual void StrengthChanged(const Trainer& trainer) = 0;
+};
+
+class Trainer : private InstanceAccounted<Trainer, MEMORY_TRAINERS> {
 public:
 	// Constructs a new trainer with the given name and team.
 	//
@@ -27,14 +86,33 @@ public:
 	// @throw TrainerInvalidArgsException if name is an empty string.
 	Trainer(const std::string& name, const Team& team);
 
-	// Destroys a trainer
+	// Copy constructor.
 	//
-	// Destroys all of the trainer's items
-	~Trainer();
+	// @param trainer the trainer to copy.
+	Trainer(const Trainer& trainer);
+
+	// Move constructor. Takes the trainer's Pokemons and items, leaving it
+	// with none.
+	//
+	// @param trainer the trainer to move.
+	Trainer(Trainer&& trainer);
+
+	// Trainers aren't assignable. The game, its locations and observers know
+	// a trainer by its name, team and id, which must not change.
+	Trainer& operator=(const Trainer& trainer) = delete;
+	Trainer& operator=(Trainer&& trainer) = delete;
+
+	// Destroys a trainer
+	~Trainer() {}
 	// Returns a reference to the strongest Pokemon the trainer owns. Strongest 
 	// Pokemon is determined using the comparison operators provided by the
 	// class Pokemon. If two Pokemons are of equal strength, the function
-	// returns the one that was caught earlier by the trainer.
+	// returns the one that was caught earlier by the trainer. Takes constant
+	// time.
+	//
+	// The trainer keeps its Pokemons ordered by strength, so the returned
+	// Pokemon must not be trained through the reference. The reference is
+	// valid until the trainer catches or loses a Pokemon.
 	//
 	// @return the strongest pokemon.
 	// @throw TrainerNoPokemonsException if trainer has no Pokemons.
@@ -43,7 +121,7 @@ public:
 
 	// Kills the strongest Pokemon. Removes the Pokemon that is returned from
 	// GetStrongestPokemon() from the collection of Pokemons owned by the
-	// trainer.
+	// trainer. Takes amortized logarithmic time.
 	//
 	// @throw TrainerNoPokemonsException if trainer has no Pokemons.
 	void KillStrongestPokemon();
@@ -71,11 +149,37 @@ public:
 	// @return the team to which the trainer belongs.
 	Team GetTeam() const;
 
+	// Returns the name of the trainer.
+	//
+	// @return the name of the trainer.
+	const std::string& GetName() const;
+
+	// Returns the level of the trainer.
+	//
+	// @return the level of the trainer.
+	int Level() const;
+
+	// Returns a number which identifies the trainer. Copied and moved
+	// trainers get new ids, and ids are never reused.
+	//
+	// @return the id of the trainer.
+	unsigned long long Id() const;
+
+	// Returns the version of the trainer's state. The version changes
+	// whenever anything that affects the trainer's battles changes, so a
+	// trainer's id and version together identify its battle state.
+	//
+	// @return the version of the trainer.
+	unsigned long long Version() const;
+
 	// Tries to catch a Pokemon.
 	//
-	// @param pokemon the Pokemon the trainer wishes to catch.
+	// @param pokemon the Pokemon the trainer wishes to catch. Moved into
+	//		  the trainer's collection if the attempt succeeded, and left
+	//		  untouched otherwise.
 	// @return true if the attempt succeeded.
 	bool TryToCatch(Pokemon& pokemon);
+	bool TryToCatch(Pokemon&& pokemon);
 
 	// Prints the data of the trainer in the following format:
 	//
@@ -120,20 +224,51 @@ public:
 	friend Trainer* TrainersBattleWithPokemons(Trainer & trainer_1,
 											   Trainer & trainer_2);
 
+	// Predicts the outcome of a battle between 2 trainers, without changing
+	// either of them. Takes constant time.
+	//
+	// @param trainer_1 first trainer in battle
+	// @param trainer_2 second trainer in battle
+	// @return the outcome TrainersBattle(trainer_1, trainer_2) would have.
+	// @throw TrainerInvalidArgsException if the battle would be decided by
+	//		  team and both trainers are in the same team.
+	friend BattlePrediction PredictBattle(const Trainer& trainer_1,
+										  const Trainer& trainer_2);
+
 
 	// Trainer's score for the team!
 	//
 	// @return total score the trainer is worth, taking into account
 	//		   it's level, if he's gym leader and battle score history.
-	int TotalScore();
+	int TotalScore() const;
+
+	// Makes the trainer a gym leader or takes it out of leadership. Must be
+	// used instead of setting is_leader, so that the observer is notified.
+	//
+	// @param leader whether the trainer leads a gym.
+	void SetLeader(bool leader);
+
+	// Sets the observer notified of changes to the trainer's score. Copied
+	// and moved trainers start with no observer.
+	//
+	// @param observer the observer, or NULL for none.
+	void SetObserver(TrainerObserver* observer);
+
+	// Sets the observer notified of changes to the trainer's strength.
+	// Copied and moved trainers start with no strength observer.
+	//
+	// @param observer the observer, or NULL for none.
+	void SetStrengthObserver(TrainerStrengthObserver* observer);
 
 
-	// Adds item to trainer's Inventory!
+	// Adds item to trainer's Inventory! If it was added, the trainer keeps
+	// its value and destroys the item object.
 	//
 	// @param the item to add
 	// @return false if trainer cannot recieve the item due to it's level
 	//		   true if item was added successfully
 	bool AddItem(Item* item);
+	bool AddItem(const ItemValue& item);
 
 
 	/*				Part C Members					*/
@@ -144,6 +279,10 @@ public:
 	// Trainer's current location name
 	std::string current_location_name;
 
+	// Where the game records the trainer's moves, or NULL. Copied and moved
+	// trainers start with none.
+	MovementHistory* movement_history;
+
 private:
 
 	// Compare between 2 trainers, according to sheet instructions
@@ -157,17 +296,32 @@ private:
 
 	/*				Part C functions				*/
 
-	// Boost pokemon with oldest item
-	// Doesn't do anything if trainer has no items
-	//
-	// @param Pokemon to boost
-	void BoostPokemon(Pokemon& pokemon);
+	// Boost the strongest pokemon with oldest item
+	// Doesn't do anything if trainer has no items or no pokemons
+	void BoostStrongestPokemon();
 
 	// Raising Trainer's level after winning battle!
 	//
 	// @param The other loser trainer
 	void RaiseLevel(Trainer& loser);
 
+	// Returns the levels a trainer gains by beating a loser
+	//
+	// @param loser_level the level of the loser
+	static int LevelGain(int loser_level);
+
+	// Marks a change in the trainer's battle state
+	void Changed();
+
+	// Marks a change in the trainer's battle state which may change its
+	// strongest Pokemon, and notifies the strength observer, if there's one
+	void StrengthChanged();
+
+	// Notifies the observer, if there's one, of a change in the score
+	//
+	// @param old_score the score before the change
+	void ScoreChanged(int old_score);
+
 	// Updating Trainer's Battle Score Log
 	//
 	// @param The winner of the battle, 
@@ -175,6 +329,18 @@ private:
 	//		  else score will be reduced
 	void UpdateBattleScoreHistory(Trainer& winner);
 
+	// Adds a pokemon as the most recently caught one
+	//
+	// @param pokemon the pokemon to add
+	void AddPokemon(Pokemon&& pokemon);
+
+	// Returns whether the trainer has any living pokemon
+	bool HasPokemons() const;
+
+	// Drops the killed pokemons from pokemons, keeping the catch order and
+	// the index by strength. Takes linear time.
+	void CompactPokemons();
+
 	/*				Part A Members					*/
 
 	// Trainer's name
@@ -186,21 +352,57 @@ private:
 	// Trainer's level
 	int level;
 
-	// Trainer's list of pokemons
-	std::vector<Pokemon> pokemons;
+	// Trainer's pokemons, by the order in which they were caught. A killed
+	// pokemon stays in place until most pokemons are killed ones, and then
+	// they are all dropped at once.
+	typedef std::vector<Pokemon, CountingAllocator<Pokemon, MEMORY_POKEMONS> >
+		PokemonsByCatch;
+	PokemonsByCatch pokemons;
+
+	// Whether each pokemon in pokemons was killed
+	std::vector<bool, CountingAllocator<bool, MEMORY_POKEMONS> > killed;
+
+	// Orders positions in pokemons from the strongest pokemon to the
+	// weakest. Pokemons of equal strength are ordered by catch order.
+	struct StrongerFirst {
+		explicit StrongerFirst(const PokemonsByCatch& pokemons);
+		bool operator()(size_t lhs, size_t rhs) const;
+
+		const PokemonsByCatch* pokemons;
+	};
+
+	// Positions of the trainer's living pokemons, strongest first
+	std::set<size_t, StrongerFirst, CountingAllocator<size_t, MEMORY_POKEMONS> >
+		pokemons_by_strength;
 
 	/*				Part C Members					*/
 	
 	// Trainer's battle history score log
 	int battle_score_history;
 
-	// Trainer's Inventory
-	std::vector<Item*> items;
+	// Trainer's Inventory, oldest item first
+	RingQueue<ItemValue, CountingAllocator<ItemValue, MEMORY_ITEMS> > items;
+
+	unsigned long long id;
+	unsigned long long version;
+
+	// Notified of changes to the score, or NULL
+	TrainerObserver* observer;
+
+	// Notified of changes to the strength, or NULL
+	TrainerStrengthObserver* strength_observer;
+
+	// Saves and restores the complete state of trainers
+	friend class Checkpoint;
+	// Formats trainers in bulk
+	friend class ReportWriter;
 };
 
 Trainer* TrainersBattle(Trainer& trainer_1, Trainer& trainer_2);
 	// TODO: This is ugly being here, but gcc complains otherwise
 Trainer* TrainersBattleWithPokemons(Trainer& trainer_1, Trainer& trainer_2);
+BattlePrediction PredictBattle(const Trainer& trainer_1,
+							   const Trainer& trainer_2);
 std::ostream& operator<<(std::ostream& output, const Trainer& trainer);
 
 }  // namespace mtm
@@ -3,18 +3,34 @@
 #include "gym.h"
 #include "pokestop.h"
 #include "starbucks.h"
+#include <algorithm>
+#include <deque>
 #include <vector>
 #include <sstream>
+#include <utility>
 
 using namespace mtm::pokemongo;
 
+// Grid offsets of a step in each direction, by direction
+static const int STEP_X[] = {0, 0, 1, -1};
+static const int STEP_Y[] = {1, -1, 0, 0};
+
+// The graph library allocates its nodes itself, so they're accounted by an
+// estimate of their size: the map entry of the key, and the k edges
+static size_t GraphNodeBytes(const std::string & name) {
+	return sizeof(std::pair<const std::string, void*>) + name.size() +
+		4 * sizeof(void*);
+}
+
 World::World()
-	: KGraph(NULL) {}
+	: KGraph(NULL), spatial_index() {}
 
 World::~World() {
 	std::map<std::string, Node*>::iterator it;
 	for (it = KGraph::nodes_.begin(); it != KGraph::nodes_.end(); it++) {
 		delete (*this)[(*it).first];
+		MemoryAccounting::Freed(MEMORY_GRAPH_NODES,
+								GraphNodeBytes((*it).first), 1);
 	}
 }
 
@@ -38,8 +54,194 @@ std::istream & mtm::pokemongo::operator >> (std::istream & input,
 }
 
 void World::Remove(std::string const& key) {
+	// The graph doesn't clear the edges of its neighbors by itself
+	for (Direction dir = NORTH; dir <= WEST; dir++) {
+		std::string neighbor;
+		if (TryNeighbor(key, dir, &neighbor) == WORLD_SUCCESS) {
+			KGraph::Disconnect(key, neighbor);
+		}
+	}
 	delete (*this)[key];
 	KGraph::Remove(key);
+	MemoryAccounting::Freed(MEMORY_GRAPH_NODES, GraphNodeBytes(key), 1);
+	spatial_index.Remove(key);
+}
+
+bool World::Contains(std::string const & key) const {
+	return KGraph::nodes_.find(key) != KGraph::nodes_.end();
+}
+
+std::vector<std::string> World::LocationNames() const {
+	std::vector<std::string> names;
+	names.reserve(KGraph::nodes_.size());
+	std::map<std::string, Node*>::const_iterator it;
+	for (it = KGraph::nodes_.begin(); it != KGraph::nodes_.end(); it++) {
+		names.push_back(it->first);
+	}
+	return names;
+}
+
+WorldStatus World::TryGetLocation(std::string const & name,
+								  Location ** location) const {
+	if (!Contains(name)) return WORLD_LOCATION_NOT_FOUND;
+	*location = (*this)[name];
+	return WORLD_SUCCESS;
+}
+
+WorldStatus World::TryNeighbor(std::string const & name, const Direction & dir,
+							   std::string * neighbor) const {
+	if (!Contains(name)) return WORLD_LOCATION_NOT_FOUND;
+	if (dir < NORTH || dir > WEST) return WORLD_INVALID_DIRECTION;
+	// Neither of these throws once the location and direction are valid
+	const_iterator it = BeginAt(name);
+	it.Move(dir);
+	if (it == End()) return WORLD_REACHED_DEAD_END;
+	*neighbor = *it;
+	return WORLD_SUCCESS;
+}
+
+// Returns the direction at which from has an edge to to, or -1
+static Direction EdgeTo(const World & world, std::string const & from,
+						std::string const & to) {
+	for (Direction dir = NORTH; dir <= WEST; dir++) {
+		std::string neighbor;
+		if (world.TryNeighbor(from, dir, &neighbor) == WORLD_SUCCESS &&
+			neighbor == to) {
+			return dir;
+		}
+	}
+	return -1;
+}
+
+mtm::KGraphStatus World::TryConnect(std::string const & from,
+									std::string const & to,
+									const Direction & from_dir,
+									const Direction & to_dir) {
+	bool self_loop = from == to;
+	if (!Contains(from) || !Contains(to)) return mtm::KGRAPH_KEY_NOT_FOUND;
+	if (from_dir < NORTH || from_dir > WEST ||
+		(!self_loop && (to_dir < NORTH || to_dir > WEST))) {
+		return mtm::KGRAPH_EDGE_OUT_OF_RANGE;
+	}
+	if (EdgeTo(*this, from, to) != -1) {
+		return mtm::KGRAPH_NODES_ALREADY_CONNECTED;
+	}
+	std::string neighbor;
+	if (TryNeighbor(from, from_dir, &neighbor) == WORLD_SUCCESS ||
+		(!self_loop &&
+		 TryNeighbor(to, to_dir, &neighbor) == WORLD_SUCCESS)) {
+		return mtm::KGRAPH_EDGE_ALREADY_IN_USE;
+	}
+	if (self_loop) {
+		KGraph::Connect(from, from_dir);
+		return mtm::KGRAPH_SUCCESS;
+	}
+	KGraph::Connect(from, to, from_dir, to_dir);
+	// An unplaced location connected to a placed one is placed next to it,
+	// with the unplaced locations it was connected to before
+	GridPoint point;
+	bool from_placed = spatial_index.Find(from, &point);
+	if (from_placed != spatial_index.Find(to, &point)) {
+		std::deque<std::string> queue(1, from_placed ? from : to);
+		int max_x = point.x;
+		PlaceFrom(queue, &max_x);
+	}
+	return mtm::KGRAPH_SUCCESS;
+}
+
+mtm::KGraphStatus World::TryDisconnect(std::string const & from,
+									   std::string const & to) {
+	if (!Contains(from) || !Contains(to)) return mtm::KGRAPH_KEY_NOT_FOUND;
+	if (EdgeTo(*this, from, to) == -1) {
+		return mtm::KGRAPH_NODES_ARE_NOT_CONNECTED;
+	}
+	KGraph::Disconnect(from, to);
+	return mtm::KGRAPH_SUCCESS;
+}
+
+WorldStatus World::SetCoordinates(std::string const & name,
+								  const GridPoint & point) {
+	if (!Contains(name)) return WORLD_LOCATION_NOT_FOUND;
+	spatial_index.Insert(name, (*this)[name]->Type(), point);
+	return WORLD_SUCCESS;
+}
+
+void World::PlaceFrom(std::deque<std::string>& queue, int* max_x) {
+	while (!queue.empty()) {
+		std::string name = queue.front();
+		queue.pop_front();
+		GridPoint point;
+		spatial_index.Find(name, &point);
+		for (Direction dir = NORTH; dir <= WEST; dir++) {
+			std::string neighbor;
+			GridPoint neighbor_point = {point.x + STEP_X[dir],
+										point.y + STEP_Y[dir]};
+			if (TryNeighbor(name, dir, &neighbor) != WORLD_SUCCESS ||
+				spatial_index.Find(neighbor, &neighbor_point)) {
+				continue;
+			}
+			SetCoordinates(neighbor, neighbor_point);
+			*max_x = std::max(*max_x, neighbor_point.x);
+			queue.push_back(neighbor);
+		}
+	}
+}
+
+void World::DeriveCoordinates() {
+	std::vector<std::string> names = LocationNames();
+	// Start from every placed location, so their groups grow around them
+	std::deque<std::string> queue;
+	int max_x = 0;
+	bool placed_any = false;
+	for (const std::string& name : names) {
+		GridPoint point;
+		if (!spatial_index.Find(name, &point)) continue;
+		queue.push_back(name);
+		max_x = placed_any ? std::max(max_x, point.x) : point.x;
+		placed_any = true;
+	}
+	for (size_t next = 0; ; next++) {
+		PlaceFrom(queue, &max_x);
+		// Put the next group which is still unplaced to the east
+		GridPoint point;
+		while (next < names.size() && spatial_index.Find(names[next], &point)) {
+			next++;
+		}
+		if (next == names.size()) break;
+		GridPoint start = {placed_any ? max_x + 2 : 0, 0};
+		SetCoordinates(names[next], start);
+		max_x = start.x;
+		placed_any = true;
+		queue.push_back(names[next]);
+	}
+}
+
+WorldStatus World::TryGetCoordinates(std::string const & name,
+									 GridPoint * point) const {
+	if (!Contains(name)) return WORLD_LOCATION_NOT_FOUND;
+	if (!spatial_index.Find(name, point)) return WORLD_NO_COORDINATES;
+	return WORLD_SUCCESS;
+}
+
+WorldStatus World::TryFindNearest(std::string const & from, LocationType type,
+								  std::string * nearest) const {
+	GridPoint point;
+	WorldStatus status = TryGetCoordinates(from, &point);
+	if (status != WORLD_SUCCESS) return status;
+	if (!spatial_index.Nearest(type, point, nearest)) {
+		return WORLD_NO_MATCHING_LOCATION;
+	}
+	return WORLD_SUCCESS;
+}
+
+WorldStatus World::TryFindWithin(std::string const & from, LocationType type,
+								 int radius,
+								 std::vector<std::string>* found) const {
+	GridPoint point;
+	WorldStatus status = TryGetCoordinates(from, &point);
+	if (status != WORLD_SUCCESS) return status;
+	*found = spatial_index.Within(type, point, radius);
+	return WORLD_SUCCESS;
 }
 
 void World::AddGym(std::istringstream & iss, std::string name) {
@@ -51,6 +253,7 @@ void World::AddGym(std::istringstream & iss, std::string name) {
 		delete gym;
 		throw WorldLocationNameAlreadyUsed();
 	}
+	MemoryAccounting::Allocated(MEMORY_GRAPH_NODES, GraphNodeBytes(name), 1);
 }
 
 void World::AddPokestop(std::istringstream & iss, std::string name) {
@@ -61,9 +264,9 @@ void World::AddPokestop(std::istringstream & iss, std::string name) {
 		iss >> item_type >> item_level;
 		try {
 			if (item_type == "POTION") {
-				pokestop->AddItem(new Potion(item_level));
+				pokestop->AddItem(ItemValue(ITEM_POTION, item_level));
 			} else if (item_type == "CANDY") {
-				pokestop->AddItem(new Candy(item_level));
+				pokestop->AddItem(ItemValue(ITEM_CANDY, item_level));
 			} else {
 				throw ItemInvalidArgException();
 			}
@@ -79,6 +282,7 @@ void World::AddPokestop(std::istringstream & iss, std::string name) {
 		delete pokestop;
 		throw WorldLocationNameAlreadyUsed();
 	}
+	MemoryAccounting::Allocated(MEMORY_GRAPH_NODES, GraphNodeBytes(name), 1);
 }
 
 void World::AddStarbucks(std::istringstream & iss, std::string name) {
@@ -89,17 +293,18 @@ void World::AddStarbucks(std::istringstream & iss, std::string name) {
 		int level = -1;
 		iss >> species >> cp >> level;
 		try {
-			pokemons.push_back(Pokemon(species, cp, level));
+			pokemons.emplace_back(species, cp, level);
 		}
 		catch (PokemonInvalidArgsException) {
 			throw WorldInvalidInputLineException();
 		}
 	}
-    Starbucks* starbucks = new Starbucks(pokemons);
+    Starbucks* starbucks = new Starbucks(std::move(pokemons));
 	try {
 		KGraph::Insert(name, starbucks);
 	} catch (KGraphKeyAlreadyExistsExpection) {
 		delete starbucks;
 		throw WorldLocationNameAlreadyUsed();
 	}
+	MemoryAccounting::Allocated(MEMORY_GRAPH_NODES, GraphNodeBytes(name), 1);
 }
@@ -1,13 +1,17 @@
 #ifndef WORLD_H
 #define WORLD_H
 
+#include <deque>
 #include <iostream>
 #include <string>
 #include <stdexcept>
+#include <vector>
 #include "k_graph.h"
 #include "location.h"
 #include "item.h"
 #include "pokemon.h"
+#include "spatial_index.h"
+#include "status.h"
 
 
 namespace mtm {
@@ -64,8 +68,112 @@ class World : public KGraph<std::string, Location*, 4> {
   // Disable assignment operator.
   void operator=(const World& world) = delete;
 
+  // Removes a location, disconnecting it from its neighbors first so none
+  // of them is left with an edge to it.
+  //
+  // @param key name of the location.
+  // @throw KGraphKeyNotFoundException if there's no such location.
   void Remove(std::string const& key);
 
+  // Checks whether the world has a location with the given name. Unlike the
+  // KGraph version, never throws internally.
+  //
+  // @param key name of the location.
+  // @return true iff the world contains the location.
+  bool Contains(std::string const& key) const;
+
+  // Returns the names of all locations in the world, sorted.
+  std::vector<std::string> LocationNames() const;
+
+  // Finds a location by name.
+  //
+  // @param name name of the location.
+  // @param location set to the location, on success.
+  // @return WORLD_LOCATION_NOT_FOUND if there's no such location,
+  //         WORLD_SUCCESS otherwise.
+  WorldStatus TryGetLocation(std::string const& name,
+                             Location** location) const;
+
+  // Finds the location connected to a location in the given direction.
+  //
+  // @param name name of the location to start from.
+  // @param dir the direction to go.
+  // @param neighbor set to the name of the connected location, on success.
+  // @return WORLD_LOCATION_NOT_FOUND if there's no such location,
+  //         WORLD_INVALID_DIRECTION if dir is not one of the four directions,
+  //         WORLD_REACHED_DEAD_END if nothing is connected in dir,
+  //         WORLD_SUCCESS otherwise.
+  WorldStatus TryNeighbor(std::string const& name, const Direction& dir,
+                          std::string* neighbor) const;
+
+  // Non-throwing versions of KGraph's Connect and Disconnect. Connecting a
+  // location to itself makes a self loop, at from_dir only. Connecting a
+  // location with no coordinates to one with coordinates places it, and
+  // the unplaced locations connected to it, by the directions (see
+  // DeriveCoordinates).
+  //
+  // @return the status matching the exception KGraph would throw, or
+  //         KGRAPH_SUCCESS.
+  KGraphStatus TryConnect(std::string const& from, std::string const& to,
+                          const Direction& from_dir, const Direction& to_dir);
+  KGraphStatus TryDisconnect(std::string const& from, std::string const& to);
+
+  // Places a location on the grid, or moves it, for the spatial queries
+  // below. Locations have no coordinates until they're placed.
+  //
+  // @param name name of the location.
+  // @param point the position of the location.
+  // @return WORLD_LOCATION_NOT_FOUND if there's no such location,
+  //         WORLD_SUCCESS otherwise.
+  WorldStatus SetCoordinates(std::string const& name, const GridPoint& point);
+
+  // Places every location which has no coordinates yet, by the directions
+  // between locations: going NORTH adds 1 to y, EAST adds 1 to x, and SOUTH
+  // and WEST subtract 1. Each group of connected locations is walked from
+  // its placed locations, or from its first location by name, and groups
+  // with no placed locations are put side by side to the east of all
+  // others. Where the directions contradict each other, the first position
+  // reached wins.
+  void DeriveCoordinates();
+
+  // Finds the position of a location.
+  //
+  // @param name name of the location.
+  // @param point set to the position of the location, on success.
+  // @return WORLD_LOCATION_NOT_FOUND if there's no such location,
+  //         WORLD_NO_COORDINATES if the location has no coordinates,
+  //         WORLD_SUCCESS otherwise.
+  WorldStatus TryGetCoordinates(std::string const& name,
+                                GridPoint* point) const;
+
+  // Finds the closest location of a given type to a location, in grid
+  // steps, ordering locations at equal distance by name. The location
+  // itself is included. Only locations with coordinates are considered.
+  //
+  // @param from name of the location to measure from.
+  // @param type the kind of location to find.
+  // @param nearest set to the name of the closest location, on success.
+  // @return WORLD_LOCATION_NOT_FOUND if there's no location named from,
+  //         WORLD_NO_COORDINATES if it has no coordinates,
+  //         WORLD_NO_MATCHING_LOCATION if no location of the type has
+  //         coordinates, WORLD_SUCCESS otherwise.
+  WorldStatus TryFindNearest(std::string const& from, LocationType type,
+                             std::string* nearest) const;
+
+  // Finds the locations of a given type within a number of grid steps of a
+  // location, closest first and then by name. The location itself is
+  // included. Only locations with coordinates are considered.
+  //
+  // @param from name of the location to measure from.
+  // @param type the kind of locations to find.
+  // @param radius the largest number of steps to include.
+  // @param found set to the names of the locations, on success.
+  // @return WORLD_LOCATION_NOT_FOUND if there's no location named from,
+  //         WORLD_NO_COORDINATES if it has no coordinates,
+  //         WORLD_SUCCESS otherwise.
+  WorldStatus TryFindWithin(std::string const& from, LocationType type,
+                            int radius, std::vector<std::string>* found) const;
+
 protected:
 
 	// Add new Gym to world
@@ -82,6 +190,16 @@ protected:
 	// @param iss Stream containing all Starbucks items
 	// @throw WorldInvalidInputLineException if starbucks args are invalid
 	void AddStarbucks(std::istringstream& iss, std::string name);
+
+	// Places the unplaced locations reachable from the queued locations,
+	// which must be placed, walking through unplaced locations only.
+	//
+	// @param queue the locations to walk from. Emptied.
+	// @param max_x raised to the largest x of the locations placed.
+	void PlaceFrom(std::deque<std::string>& queue, int* max_x);
+
+	// Positions of the locations which have coordinates
+	SpatialIndex spatial_index;
 };
 
 std::istream& operator>>(std::istream& input, World& world);
@@ -0,0 +1,102 @@
+#include "world_diff.h"
+
+#include <sstream>
+
+#include "exceptions.h"
+
+using namespace mtm::pokemongo;
+
+// Names of the directions in diff lines, by direction
+static const char* DIRECTION_NAMES[] = {"NORTH", "SOUTH", "EAST", "WEST"};
+
+// Reads a direction name
+//
+// @throw WorldInvalidInputLineException if it's not one of DIRECTION_NAMES
+static Direction ReadDirection(std::istringstream & iss) {
+	std::string name;
+	iss >> name;
+	for (Direction dir = NORTH; dir <= WEST; dir++) {
+		if (name == DIRECTION_NAMES[dir]) return dir;
+	}
+	throw WorldInvalidInputLineException();
+}
+
+// Writes a direction name, or the number of an invalid direction
+static std::ostream & WriteDirection(std::ostream & output,
+									 const Direction & dir) {
+	if (dir < NORTH || dir > WEST) return output << dir;
+	return output << DIRECTION_NAMES[dir];
+}
+
+// Reads a location name, which can't be empty
+static std::string ReadName(std::istringstream & iss) {
+	std::string name;
+	iss >> name;
+	if (name.empty()) throw WorldInvalidInputLineException();
+	return name;
+}
+
+std::istream & mtm::pokemongo::operator >> (std::istream & input,
+											WorldChange & change) {
+	std::string line, change_type;
+	std::getline(input, line);
+	std::istringstream iss(line);
+	iss >> change_type;
+	if (change_type == "ADD") {
+		std::string location_line;
+		std::getline(iss >> std::ws, location_line);
+		if (location_line.empty()) throw WorldInvalidInputLineException();
+		change = WorldChange::AddLocation(location_line);
+		return input;
+	}
+	if (change_type == "REMOVE") {
+		std::string location = ReadName(iss);
+		change = WorldChange::RemoveLocation(location, ReadName(iss));
+	} else if (change_type == "CONNECT") {
+		std::string from = ReadName(iss);
+		Direction from_direction = ReadDirection(iss);
+		std::string to = ReadName(iss);
+		change = WorldChange::Connect(from, to, from_direction,
+									  ReadDirection(iss));
+	} else if (change_type == "DISCONNECT") {
+		std::string from = ReadName(iss);
+		change = WorldChange::Disconnect(from, ReadName(iss));
+	} else {
+		throw WorldInvalidInputLineException();
+	}
+	std::string extra;
+	if (iss >> extra) throw WorldInvalidInputLineException();
+	return input;
+}
+
+std::ostream & mtm::pokemongo::operator << (std::ostream & output,
+											const WorldChange & change) {
+	switch (change.type) {
+	case ADD_LOCATION:
+		return output << "ADD " << change.line;
+	case REMOVE_LOCATION:
+		return output << "REMOVE " << change.location << " " << change.other;
+	case CONNECT_LOCATIONS:
+		output << "CONNECT " << change.location << " ";
+		WriteDirection(output, change.direction) << " " << change.other << " ";
+		return WriteDirection(output, change.location == change.other ?
+							  change.direction : change.other_direction);
+	default:
+		return output << "DISCONNECT " << change.location << " " <<
+			change.other;
+	}
+}
+
+std::vector<WorldChange> mtm::pokemongo::ReadWorldDiff(std::istream & input) {
+	std::vector<WorldChange> diff;
+	while (input.peek() != std::char_traits<char>::eof()) {
+		if (input.peek() == '\n') {
+			input.get();
+			continue;
+		}
+		WorldChange change;
+		input >> change;
+		diff.push_back(change);
+	}
+	return diff;
+}
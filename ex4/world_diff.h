@@ -0,0 +1,118 @@
+#ifndef WORLD_DIFF_H
+#define WORLD_DIFF_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "world.h"
+
+namespace mtm {
+namespace pokemongo {
+
+// Changes to the world of a running game.
+typedef enum {
+	ADD_LOCATION,
+	REMOVE_LOCATION,
+	CONNECT_LOCATIONS,
+	DISCONNECT_LOCATIONS,
+} WorldChangeType;
+
+// A single change to a world, kept as data so a whole diff can be read from
+// a file and applied to a game with PokemonGo::TryApplyWorldChange. The
+// result of applying a change is a WorldChangeStatus.
+struct WorldChange {
+	WorldChangeType type;
+	// Used by ADD_LOCATION only: a world input line, as read by
+	// operator>>(std::istream&, World&)
+	std::string line;
+	// The location removed, or the first of the two locations connected or
+	// disconnected
+	std::string location;
+	// The location trainers are moved to from a removed location, or the
+	// second of the two locations connected or disconnected
+	std::string other;
+	// Used by CONNECT_LOCATIONS only. A self loop has location == other,
+	// and other_direction unused.
+	Direction direction;
+	Direction other_direction;
+
+	// Creates a change adding a location, given as a world input line.
+	static WorldChange AddLocation(const std::string& line) {
+		WorldChange change = { ADD_LOCATION, line, "", "", NORTH, NORTH };
+		return change;
+	}
+
+	// Creates a change removing a location, and moving the trainers in it
+	// to fallback.
+	static WorldChange RemoveLocation(const std::string& location,
+									  const std::string& fallback) {
+		WorldChange change = { REMOVE_LOCATION, "", location, fallback,
+							   NORTH, NORTH };
+		return change;
+	}
+
+	// Creates a change connecting two locations, as World::TryConnect.
+	static WorldChange Connect(const std::string& from, const std::string& to,
+							   const Direction& from_direction,
+							   const Direction& to_direction) {
+		WorldChange change = { CONNECT_LOCATIONS, "", from, to,
+							   from_direction, to_direction };
+		return change;
+	}
+
+	// Creates a change disconnecting two connected locations.
+	static WorldChange Disconnect(const std::string& from,
+								  const std::string& to) {
+		WorldChange change = { DISCONNECT_LOCATIONS, "", from, to,
+							   NORTH, NORTH };
+		return change;
+	}
+};
+
+// Input iterator. Scans a single line of a world diff from the input
+// stream. The line can be one of the following four options:
+//
+// (1) "ADD <world input line>"
+//     e.g. "ADD POKESTOP mikhlol POTION 10"
+//     Adds a location, as operator>>(std::istream&, World&) would. The line
+//     is only checked when the change is applied.
+// (2) "REMOVE <location_name> <fallback_name>"
+//     e.g. "REMOVE taub meyer"
+//     Removes a location and its edges, moving the trainers in it to the
+//     fallback location.
+// (3) "CONNECT <location_name1> <direction1> <location_name2> <direction2>"
+//     e.g. "CONNECT taub EAST meyer WEST"
+//     Connects two locations, where direction is one of NORTH, SOUTH, EAST
+//     and WEST. If both names are the same, a self loop is made at
+//     direction1.
+// (4) "DISCONNECT <location_name1> <location_name2>"
+//     e.g. "DISCONNECT taub meyer"
+//     Disconnects two connected locations.
+//
+// @param input the input stream.
+// @param change set to the change read.
+// @return the input stream.
+// @throw WorldInvalidInputLineException if the input line is not one of the
+//        four options.
+std::istream& operator>>(std::istream& input, WorldChange& change);
+
+// Writes a change as a single world diff line, without a line break, in the
+// format read by operator>>.
+//
+// @param output the output stream.
+// @param change the change to write.
+// @return the output stream.
+std::ostream& operator<<(std::ostream& output, const WorldChange& change);
+
+// Reads a whole world diff, one change per line. Empty lines are skipped.
+//
+// @param input the input stream.
+// @return the changes, in the order of their lines.
+// @throw WorldInvalidInputLineException if a line is not a valid change.
+std::vector<WorldChange> ReadWorldDiff(std::istream& input);
+
+}  // namespace pokemongo
+}  // namespace mtm
+
+#endif  // WORLD_DIFF_H